@@ -3393,6 +3393,142 @@ static void test_delete_value(void)
     ok(res == ERROR_FILE_NOT_FOUND, "expected ERROR_FILE_NOT_FOUND, got %d\n", res);
 }
 
+static void test_value_change(void)
+{
+    HKEY hkey, hkey2;
+    DWORD type, size, dw;
+    char buffer[20];
+    LONG res;
+
+    res = RegCreateKeyA( hkey_main, "test_change", &hkey );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegOpenKeyA( hkey_main, "test_change", &hkey2 );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_FILE_NOT_FOUND, "expected ERROR_FILE_NOT_FOUND, got %d\n", res);
+
+    /* changes through another handle are seen immediately */
+    res = RegSetValueExA( hkey2, "test", 0, REG_SZ, (const BYTE *)"value", 6 );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    size = sizeof(buffer);
+    res = RegQueryValueExA( hkey, "test", NULL, &type, (BYTE *)buffer, &size );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    ok(type == REG_SZ, "got type %u\n", type);
+    ok(size == 6, "got size %u\n", size);
+    ok(!strcmp( buffer, "value" ), "got %s\n", buffer);
+
+    dw = 0x1234;
+    res = RegSetValueExA( hkey2, "test", 0, REG_DWORD, (const BYTE *)&dw, sizeof(dw) );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    size = sizeof(buffer);
+    res = RegQueryValueExA( hkey, "test", NULL, &type, (BYTE *)buffer, &size );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    ok(type == REG_DWORD, "got type %u\n", type);
+    ok(size == sizeof(dw), "got size %u\n", size);
+    ok(*(DWORD *)buffer == 0x1234, "got %#x\n", *(DWORD *)buffer);
+
+    res = RegDeleteValueA( hkey2, "test" );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_FILE_NOT_FOUND, "expected ERROR_FILE_NOT_FOUND, got %d\n", res);
+
+    res = RegSetValueExA( hkey2, "test", 0, REG_SZ, (const BYTE *)"value", 6 );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+
+    res = RegDeleteKeyA( hkey2, "" );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_KEY_DELETED, "expected ERROR_KEY_DELETED, got %d\n", res);
+
+    RegCloseKey( hkey2 );
+    RegCloseKey( hkey );
+
+    /* a handle value reused for another key doesn't return the values of the old one */
+    res = RegCreateKeyA( hkey_main, "test_change", &hkey );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegSetValueExA( hkey, "test", 0, REG_SZ, (const BYTE *)"value", 6 );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    RegCloseKey( hkey );
+    res = RegCreateKeyA( hkey_main, "test_change2", &hkey );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegQueryValueExA( hkey, "test", NULL, NULL, NULL, NULL );
+    ok(res == ERROR_FILE_NOT_FOUND, "expected ERROR_FILE_NOT_FOUND, got %d\n", res);
+    RegCloseKey( hkey );
+    RegDeleteKeyA( hkey_main, "test_change2" );
+    RegDeleteKeyA( hkey_main, "test_change" );
+}
+
+static void test_query_value_speed( const char *desc )
+{
+    LARGE_INTEGER freq, start, end;
+    DWORD i, count, size, dw = 1;
+    HKEY hkey, hkey2;
+    LONG res;
+
+    res = RegCreateKeyA( hkey_main, "test_speed", &hkey );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    res = RegSetValueExA( hkey, "test", 0, REG_DWORD, (const BYTE *)&dw, sizeof(dw) );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+
+    count = winetest_interactive ? 100000 : 1000;
+    QueryPerformanceFrequency( &freq );
+
+    QueryPerformanceCounter( &start );
+    for (i = 0; i < count; i++)
+    {
+        size = sizeof(dw);
+        if ((res = RegQueryValueExA( hkey, "test", NULL, NULL, (BYTE *)&dw, &size ))) break;
+    }
+    QueryPerformanceCounter( &end );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    trace( "%s: %u reads of the same value: %.2f us per read\n", desc, count,
+           (end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart / count );
+
+    /* the key is opened by path every time, only the value query can be cached */
+    QueryPerformanceCounter( &start );
+    for (i = 0; i < count; i++)
+    {
+        if ((res = RegOpenKeyA( hkey_main, "test_speed", &hkey2 ))) break;
+        size = sizeof(dw);
+        res = RegQueryValueExA( hkey2, "test", NULL, NULL, (BYTE *)&dw, &size );
+        RegCloseKey( hkey2 );
+        if (res) break;
+    }
+    QueryPerformanceCounter( &end );
+    ok(res == ERROR_SUCCESS, "expected ERROR_SUCCESS, got %d\n", res);
+    trace( "%s: %u opens and reads of the same value: %.2f us per read\n", desc, count,
+           (end.QuadPart - start.QuadPart) * 1000000.0 / freq.QuadPart / count );
+
+    RegCloseKey( hkey );
+    RegDeleteKeyA( hkey_main, "test_speed" );
+}
+
+static void test_value_cache(void)
+{
+    STARTUPINFOA si = { sizeof(si) };
+    PROCESS_INFORMATION pi;
+    char cmdline[MAX_PATH];
+    char **argv;
+    BOOL ret;
+
+    /* run test_value_change and test_query_value_speed again with the Wine value cache enabled */
+    winetest_get_mainargs( &argv );
+    sprintf( cmdline, "\"%s\" registry value_cache", argv[0] );
+    SetEnvironmentVariableA( "WINEREGCACHE", "1" );
+    ret = CreateProcessA( NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi );
+    SetEnvironmentVariableA( "WINEREGCACHE", NULL );
+    ok(ret, "CreateProcess failed, error %u\n", GetLastError());
+    if (!ret) return;
+    winetest_wait_child_process( pi.hProcess );
+    CloseHandle( pi.hProcess );
+    CloseHandle( pi.hThread );
+}
+
 static void test_delete_key_value(void)
 {
     HKEY subkey;
@@ -3944,9 +4080,26 @@ static void test_RegLoadMUIString(void)
 
 START_TEST(registry)
 {
+    char **argv;
+    int argc;
+
     /* Load pointers for functions that are not available in all Windows versions */
     InitFunctionPtrs();
 
+    argc = winetest_get_mainargs( &argv );
+    if (argc >= 3 && !strcmp( argv[2], "value_cache" ))
+    {
+        /* the parent owns the test key */
+        if (!RegOpenKeyA( HKEY_CURRENT_USER, "Software\\Wine\\Test", &hkey_main ))
+        {
+            test_value_change();
+            test_query_value_speed( "value cache" );
+            RegCloseKey( hkey_main );
+        }
+        else ok( 0, "test key not found\n" );
+        return;
+    }
+
     setup_main_key();
     check_user_privs();
     test_set_value();
@@ -3974,6 +4127,9 @@ START_TEST(registry)
     test_rw_order();
     test_deleted_key();
     test_delete_value();
+    test_value_change();
+    test_query_value_speed( "server" );
+    test_value_cache();
     test_delete_key_value();
     test_RegOpenCurrentUser();
     test_RegNotifyChangeKeyValue();
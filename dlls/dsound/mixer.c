@@ -296,6 +296,25 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
     return count;
 }
 
+/* Uses four independent partial sums, so the compiler can keep them in one
+ * vector register and the additions don't have to wait on each other. */
+static inline float fir_dot(const float *coeffs, const float *input, int len)
+{
+    float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+    int j;
+
+    for (j = 0; j + 4 <= len; j += 4) {
+        sum0 += coeffs[j] * input[j];
+        sum1 += coeffs[j + 1] * input[j + 1];
+        sum2 += coeffs[j + 2] * input[j + 2];
+        sum3 += coeffs[j + 3] * input[j + 3];
+    }
+    for (; j < len; j++)
+        sum0 += coeffs[j] * input[j];
+
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
 static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *freqAccNum)
 {
     UINT i, channel;
@@ -344,23 +363,19 @@ static UINT cp_fields_resample(IDirectSoundBufferImpl *dsb, UINT count, LONG64 *
         UINT ipos = int_fir_steps / dsbfirstep;
 
         UINT idx = (ipos + 1) * dsbfirstep - int_fir_steps - 1;
-        float rem = int_fir_steps + 1.0 - total_fir_steps;
+        float rem = int_fir_steps + 1.0f - total_fir_steps;
 
         int fir_used = 0;
         while (idx < fir_len - 1) {
-            fir_copy[fir_used++] = fir[idx] * (1.0 - rem) + fir[idx + 1] * rem;
-            idx += dsb->firstep;
+            fir_copy[fir_used++] = fir[idx] * (1.0f - rem) + fir[idx + 1] * rem;
+            idx += dsbfirstep;
         }
 
         assert(fir_used <= fir_cachesize);
         assert(ipos + fir_used <= required_input);
 
-        for (channel = 0; channel < dsb->mix_channels; channel++) {
-            int j;
-            float sum = 0.0;
-            float* cache = &intermediate[channel * required_input + ipos];
-            for (j = 0; j < fir_used; j++)
-                sum += fir_copy[j] * cache[j];
+        for (channel = 0; channel < channels; channel++) {
+            float sum = fir_dot(fir_copy, &intermediate[channel * required_input + ipos], fir_used);
             dsb->put(dsb, i * ostride, channel, sum * dsb->firgain);
         }
     }
@@ -452,33 +467,46 @@ static void DSOUND_MixToTemporary(IDirectSoundBufferImpl *dsb, DWORD frames)
 	}
 }
 
-static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
+/**
+ * Add the converted frames in the temporary buffer to the mix buffer,
+ * applying volume and pan on the way, so the temporary buffer is only
+ * read once.
+ */
+static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, float *mix_buffer, INT frames)
 {
 	INT	i;
 	float vols[DS_MAX_CHANNELS];
 	UINT channels = dsb->device->pwfx->nChannels, chan;
+	const float *src = dsb->device->tmp_buffer;
 
 	TRACE("(%p,%d)\n",dsb,frames);
 	TRACE("left = %x, right = %x\n", dsb->volpan.dwTotalAmpFactor[0],
 		dsb->volpan.dwTotalAmpFactor[1]);
 
-	if ((!(dsb->dsbd.dwFlags & DSBCAPS_CTRLPAN) || (dsb->volpan.lPan == 0)) &&
-	    (!(dsb->dsbd.dwFlags & DSBCAPS_CTRLVOLUME) || (dsb->volpan.lVolume == 0)) &&
-	     !(dsb->dsbd.dwFlags & DSBCAPS_CTRL3D))
-		return; /* Nothing to do */
-
-	if (channels > DS_MAX_CHANNELS)
+	if (((!(dsb->dsbd.dwFlags & DSBCAPS_CTRLPAN) || (dsb->volpan.lPan == 0)) &&
+	     (!(dsb->dsbd.dwFlags & DSBCAPS_CTRLVOLUME) || (dsb->volpan.lVolume == 0)) &&
+	      !(dsb->dsbd.dwFlags & DSBCAPS_CTRL3D)) || channels > DS_MAX_CHANNELS)
 	{
-		FIXME("There is no support for %u channels\n", channels);
+		if (channels > DS_MAX_CHANNELS)
+			FIXME("There is no support for %u channels\n", channels);
+		mixieee32(dsb->device->tmp_buffer, mix_buffer, frames * channels);
 		return;
 	}
 
 	for (i = 0; i < channels; ++i)
 		vols[i] = dsb->volpan.dwTotalAmpFactor[i] / ((float)0xFFFF);
 
-	for(i = 0; i < frames; ++i){
+	if (channels == 2) {
+		for (i = 0; i < frames; ++i, src += 2, mix_buffer += 2) {
+			mix_buffer[0] += src[0] * vols[0];
+			mix_buffer[1] += src[1] * vols[1];
+		}
+		return;
+	}
+
+	for(i = 0; i < frames; ++i, src += channels, mix_buffer += channels){
 		for(chan = 0; chan < channels; ++chan){
-			dsb->device->tmp_buffer[i * channels + chan] *= vols[chan];
+			mix_buffer[chan] += src[chan] * vols[chan];
 		}
 	}
 }
@@ -497,7 +525,6 @@ static void DSOUND_MixerVol(const IDirectSoundBufferImpl *dsb, INT frames)
  */
 static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer, DWORD frames)
 {
-	float *ibuf;
 	DWORD oldpos;
 
 	TRACE("sec_mixpos=%d/%d\n", dsb->sec_mixpos, dsb->buflen);
@@ -506,12 +533,9 @@ static DWORD DSOUND_MixInBuffer(IDirectSoundBufferImpl *dsb, float *mix_buffer,
 	/* Resample buffer to temporary buffer specifically allocated for this purpose, if needed */
 	oldpos = dsb->sec_mixpos;
 	DSOUND_MixToTemporary(dsb, frames);
-	ibuf = dsb->device->tmp_buffer;
-
-	/* Apply volume if needed */
-	DSOUND_MixerVol(dsb, frames);
 
-	mixieee32(ibuf, mix_buffer, frames * dsb->device->pwfx->nChannels);
+	/* Apply volume if needed and mix into the main buffer */
+	DSOUND_MixerVol(dsb, mix_buffer, frames);
 
 	/* check for notification positions */
 	if (dsb->dsbd.dwFlags & DSBCAPS_CTRLPOSITIONNOTIFY &&
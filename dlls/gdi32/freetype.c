@@ -403,6 +403,10 @@ struct tagGdiFont {
     struct list entry;
     struct list unused_entry;
     unsigned int refcount;
+
+    /* the following members are protected by the font critical section,
+     * the critical section of a base font also protects its child fonts */
+    CRITICAL_SECTION cs;
     GM **gm;
     DWORD gmsize;
     OUTLINETEXTMETRICW *potm;
@@ -430,6 +434,7 @@ struct tagGdiFont {
     DWORD aa_flags;
     UINT ntmCellHeight, ntmAvgWidth;
     FONTSIGNATURE fs;
+    WORD gasp_flags;
     GdiFont *base_font;
     VOID *GSUB_Table;
     const VOID *vert_feature;
@@ -587,6 +592,7 @@ static const WCHAR face_internal_leading_value[] = {'I','n','t','e','r','n','a',
 static const WCHAR face_font_sig_value[] = {'F','o','n','t',' ','S','i','g','n','a','t','u','r','e',0};
 static const WCHAR face_file_name_value[] = {'F','i','l','e',' ','N','a','m','e','\0'};
 static const WCHAR face_full_name_value[] = {'F','u','l','l',' ','N','a','m','e','\0'};
+static const WCHAR index_serial_value[] = {'I','n','d','e','x',' ','S','e','r','i','a','l',0};
 
 
 struct font_mapping
@@ -614,6 +620,11 @@ static CRITICAL_SECTION_DEBUG critsect_debug =
 };
 static CRITICAL_SECTION freetype_cs = { &critsect_debug, -1, 0, 0, 0, 0 };
 
+/* freetype_cs protects the font lists, the font cache and the creation and
+ * destruction of FreeType faces. Glyph and metrics requests only lock the
+ * selected font, which may then take freetype_cs to load a child font;
+ * the reverse order is not allowed. */
+
 static const WCHAR font_mutex_nameW[] = {'_','_','W','I','N','E','_','F','O','N','T','_','M','U','T','E','X','_','_','\0'};
 
 static const WCHAR szDefaultFallbackLink[] = {'M','i','c','r','o','s','o','f','t',' ','S','a','n','s',' ','S','e','r','i','f',0};
@@ -624,6 +635,7 @@ static BOOL get_outline_text_metrics(GdiFont *font);
 static BOOL get_bitmap_text_metrics(GdiFont *font);
 static BOOL get_text_metrics(GdiFont *font, LPTEXTMETRICW ptm);
 static void remove_face_from_cache( Face *face );
+static char *get_font_dir(void);
 
 static const WCHAR system_link[] = {'S','o','f','t','w','a','r','e','\\','M','i','c','r','o','s','o','f','t','\\',
                                     'W','i','n','d','o','w','s',' ','N','T','\\',
@@ -1488,13 +1500,24 @@ static inline BOOL faces_equal( const Face *f1, const Face *f2 )
     return !memcmp( &f1->fs, &f2->fs, sizeof(f1->fs) );
 }
 
+/* the font index stays mapped, the names of the faces loaded from it point into it */
+static const char *font_index_data;
+static SIZE_T font_index_size;
+
+static void free_font_string( WCHAR *str )
+{
+    if ((const char *)str >= font_index_data && (const char *)str < font_index_data + font_index_size)
+        return;
+    HeapFree( GetProcessHeap(), 0, str );
+}
+
 static void release_family( Family *family )
 {
     if (--family->refcount) return;
     assert( list_empty( &family->faces ));
     list_remove( &family->entry );
-    HeapFree( GetProcessHeap(), 0, family->FamilyName );
-    HeapFree( GetProcessHeap(), 0, family->EnglishName );
+    free_font_string( family->FamilyName );
+    free_font_string( family->EnglishName );
     HeapFree( GetProcessHeap(), 0, family );
 }
 
@@ -1507,9 +1530,9 @@ static void release_face( Face *face )
         list_remove( &face->entry );
         release_family( face->family );
     }
-    HeapFree( GetProcessHeap(), 0, face->file );
-    HeapFree( GetProcessHeap(), 0, face->StyleName );
-    HeapFree( GetProcessHeap(), 0, face->FullName );
+    free_font_string( face->file );
+    free_font_string( face->StyleName );
+    free_font_string( face->FullName );
     HeapFree( GetProcessHeap(), 0, face->cached_enum_data );
     HeapFree( GetProcessHeap(), 0, face );
 }
@@ -1819,6 +1842,387 @@ static LONG create_font_cache_key(HKEY *hkey, DWORD *disposition)
     return ret;
 }
 
+/* The font cache is also saved to a binary index file in the prefix, which
+ * can be mapped and loaded in one go instead of enumerating the registry
+ * keys. The registry cache stays the reference: the index records the
+ * cache serial it was built from and is rebuilt when the serial changes,
+ * i.e. when fonts have been added or removed after the initial scan. It
+ * also records the modification times of the font directories, so that a
+ * change to them triggers a new scan.
+ *
+ * The index is mapped read-only and stays mapped once loaded: the names of
+ * the families and faces point into it instead of being copied, so their
+ * pages are shared with the other processes that use the same index. */
+
+#define FONT_INDEX_MAGIC   0x58444e46  /* "FNDX" */
+#define FONT_INDEX_VERSION 1
+
+struct font_index_header
+{
+    DWORD     magic;         /* FONT_INDEX_MAGIC */
+    DWORD     version;       /* FONT_INDEX_VERSION */
+    DWORD     size;          /* total size of the file */
+    DWORD     count;         /* number of face records */
+    ULONGLONG serial;        /* cache serial the index was built from */
+    ULONGLONG dir_time[2];   /* modification times of the Windows and Wine font directories */
+};
+
+struct font_index_face
+{
+    DWORD         size;      /* total record size, 8-byte aligned */
+    DWORD         flags;
+    DWORD         ntmFlags;
+    DWORD         font_version;
+    DWORD         face_index;
+    DWORD         scalable;
+    ULONGLONG     dev;
+    ULONGLONG     ino;
+    FONTSIGNATURE fs;
+    INT           size_size;
+    INT           x_ppem;
+    INT           y_ppem;
+    SHORT         height;
+    SHORT         width;
+    SHORT         internal_leading;
+    /* string lengths including the null terminator, 0 if the string is not present */
+    WORD          family_len;
+    WORD          english_len;
+    WORD          style_len;
+    WORD          full_name_len;
+    WORD          file_len;
+    DWORD         __pad;     /* keep the same layout on 32-bit and 64-bit */
+    /* followed by the family, english, style, full and file names */
+};
+
+enum font_index_status
+{
+    FONT_INDEX_LOADED,
+    FONT_INDEX_INVALID,      /* missing, corrupt or built from an older cache */
+    FONT_INDEX_DIRS_CHANGED  /* the font directories have been modified */
+};
+
+static BOOL font_list_loaded;
+
+static char *get_font_index_path( const char *suffix )
+{
+    const char *config_dir = wine_get_config_dir();
+    char *path;
+
+    if (!config_dir) return NULL;
+    if (!(path = HeapAlloc( GetProcessHeap(), 0, strlen(config_dir) + sizeof("/fontindex") + strlen(suffix) )))
+        return NULL;
+    strcpy( path, config_dir );
+    strcat( path, "/fontindex" );
+    strcat( path, suffix );
+    return path;
+}
+
+static ULONGLONG get_dir_time( char *dir )
+{
+    struct stat st;
+    ULONGLONG ret = 0;
+
+    if (!dir) return 0;
+    if (!stat( dir, &st )) ret = st.st_mtime;
+    HeapFree( GetProcessHeap(), 0, dir );
+    return ret;
+}
+
+static void get_font_dir_times( ULONGLONG times[2] )
+{
+    WCHAR windowsdir[MAX_PATH];
+
+    GetWindowsDirectoryW( windowsdir, ARRAY_SIZE(windowsdir) );
+    strcatW( windowsdir, fontsW );
+    times[0] = get_dir_time( wine_get_unix_file_name( windowsdir ));
+    times[1] = get_dir_time( get_font_dir() );
+}
+
+static ULONGLONG get_font_cache_serial(void)
+{
+    ULONGLONG serial;
+    DWORD type, size = sizeof(serial);
+
+    if (RegQueryValueExW( hkey_font_cache, index_serial_value, NULL, &type, (BYTE *)&serial, &size ) ||
+        type != REG_QWORD || size != sizeof(serial))
+        return 0;
+    return serial;
+}
+
+/* give the cache a new serial, which invalidates the current index */
+static ULONGLONG update_font_cache_serial(void)
+{
+    FILETIME ft;
+    ULONGLONG serial;
+
+    GetSystemTimeAsFileTime( &ft );
+    serial = ((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    if (serial == get_font_cache_serial()) serial++;
+    RegSetValueExW( hkey_font_cache, index_serial_value, 0, REG_QWORD, (BYTE *)&serial, sizeof(serial) );
+    return serial;
+}
+
+static const WCHAR *get_index_string( const WCHAR **ptr, WORD len )
+{
+    const WCHAR *str = *ptr;
+
+    *ptr += len;
+    if (!len || str[len - 1]) return NULL;
+    return str;
+}
+
+static void load_index_face( const struct font_index_face *rec, Family *family )
+{
+    const WCHAR *ptr = (const WCHAR *)(rec + 1) + rec->family_len + rec->english_len;
+    const WCHAR *style, *full_name, *file;
+    Face *face;
+
+    style = get_index_string( &ptr, rec->style_len );
+    full_name = get_index_string( &ptr, rec->full_name_len );
+    file = get_index_string( &ptr, rec->file_len );
+    if (!style || !file) return;
+
+    face = HeapAlloc( GetProcessHeap(), 0, sizeof(*face) );
+    face->cached_enum_data = NULL;
+    face->family = NULL;
+    face->refcount = 1;
+    face->StyleName = (WCHAR *)style;
+    face->FullName = (WCHAR *)full_name;
+    face->file = (WCHAR *)file;
+    face->dev = rec->dev;
+    face->ino = rec->ino;
+    face->font_data_ptr = NULL;
+    face->font_data_size = 0;
+    face->face_index = rec->face_index;
+    face->fs = rec->fs;
+    face->ntmFlags = rec->ntmFlags;
+    face->font_version = rec->font_version;
+    face->scalable = rec->scalable;
+    face->flags = rec->flags;
+    memset( &face->size, 0, sizeof(face->size) );
+    if (!face->scalable)
+    {
+        face->size.height = rec->height;
+        face->size.width = rec->width;
+        face->size.size = rec->size_size;
+        face->size.x_ppem = rec->x_ppem;
+        face->size.y_ppem = rec->y_ppem;
+        face->size.internal_leading = rec->internal_leading;
+    }
+
+    if (insert_face_in_family_list( face, family ))
+        TRACE("Added font %s %s\n", debugstr_w(family->FamilyName), debugstr_w(face->StyleName));
+    release_face( face );
+}
+
+static enum font_index_status load_font_index( ULONGLONG serial, const ULONGLONG dir_times[2] )
+{
+    const struct font_index_header *header;
+    const struct font_index_face *rec;
+    const WCHAR *family_name = NULL, *english_name, *ptr;
+    enum font_index_status ret = FONT_INDEX_INVALID;
+    Family *family = NULL;
+    struct stat st;
+    char *path;
+    void *data;
+    DWORD i, pos;
+    int fd;
+
+    if (!serial || !(path = get_font_index_path( "" ))) return FONT_INDEX_INVALID;
+    fd = open( path, O_RDONLY );
+    HeapFree( GetProcessHeap(), 0, path );
+    if (fd == -1) return FONT_INDEX_INVALID;
+
+    if (fstat( fd, &st ) == -1 || st.st_size < (off_t)sizeof(*header) ||
+        (data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 )) == MAP_FAILED)
+    {
+        close( fd );
+        return FONT_INDEX_INVALID;
+    }
+    close( fd );
+
+    header = data;
+    if (header->magic != FONT_INDEX_MAGIC || header->version != FONT_INDEX_VERSION ||
+        header->size != st.st_size || header->serial != serial)
+        goto done;
+    if (header->dir_time[0] != dir_times[0] || header->dir_time[1] != dir_times[1])
+    {
+        TRACE("font directories have changed\n");
+        ret = FONT_INDEX_DIRS_CHANGED;
+        goto done;
+    }
+
+    /* check the records before creating anything */
+    for (i = 0, pos = sizeof(*header); i < header->count; i++, pos += rec->size)
+    {
+        rec = (const struct font_index_face *)((const char *)data + pos);
+        if (header->size - pos < sizeof(*rec) || rec->size < sizeof(*rec) ||
+            rec->size > header->size - pos || (rec->size & 7))
+            goto done;
+        if (sizeof(*rec) + (rec->family_len + rec->english_len + rec->style_len +
+                            rec->full_name_len + rec->file_len) * sizeof(WCHAR) > rec->size)
+            goto done;
+        ptr = (const WCHAR *)(rec + 1);
+        if (!get_index_string( &ptr, rec->family_len )) goto done;
+    }
+
+    font_index_data = data;
+    font_index_size = st.st_size;
+
+    /* records are grouped by family */
+    for (i = 0, pos = sizeof(*header); i < header->count; i++, pos += rec->size)
+    {
+        rec = (const struct font_index_face *)((const char *)data + pos);
+        ptr = (const WCHAR *)(rec + 1);
+        if (!family_name || strcmpW( family_name, ptr ))
+        {
+            if (family) release_family( family );
+            family_name = get_index_string( &ptr, rec->family_len );
+            english_name = get_index_string( &ptr, rec->english_len );
+            family = create_family( (WCHAR *)family_name, (WCHAR *)english_name );
+            if (english_name)
+            {
+                FontSubst *subst = HeapAlloc(GetProcessHeap(), 0, sizeof(*subst));
+                subst->from.name = strdupW(english_name);
+                subst->from.charset = -1;
+                subst->to.name = strdupW(family_name);
+                subst->to.charset = -1;
+                add_font_subst(&font_subst_list, subst, 0);
+            }
+        }
+        load_index_face( rec, family );
+    }
+    if (family) release_family( family );
+    reorder_vertical_fonts();
+    TRACE("loaded %u faces from the font index\n", header->count);
+    return FONT_INDEX_LOADED;
+
+done:
+    munmap( data, st.st_size );
+    return ret;
+}
+
+static int family_name_compare( const void *p1, const void *p2 )
+{
+    const Family *f1 = *(const Family * const *)p1, *f2 = *(const Family * const *)p2;
+    return strcmpiW( f1->FamilyName, f2->FamilyName );
+}
+
+static WORD put_index_string( WCHAR **ptr, const WCHAR *str )
+{
+    WORD len;
+
+    if (!str) return 0;
+    len = strlenW( str ) + 1;
+    memcpy( *ptr, str, len * sizeof(WCHAR) );
+    *ptr += len;
+    return len;
+}
+
+static void save_font_index( ULONGLONG serial, const ULONGLONG dir_times[2] )
+{
+    struct font_index_header *header;
+    struct font_index_face *rec;
+    Family *family, **families;
+    char *buffer, *new_buffer, *path = NULL, *tmp_path = NULL;
+    DWORD count = 0, nb_families = 0, size, pos, len, i;
+    Face *face;
+    WCHAR *str;
+    BOOL ok;
+    int fd;
+
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) nb_families++;
+    if (!(families = HeapAlloc( GetProcessHeap(), 0, nb_families * sizeof(*families) ))) return;
+    nb_families = 0;
+    LIST_FOR_EACH_ENTRY( family, &font_list, Family, entry ) families[nb_families++] = family;
+    /* same order as the registry keys */
+    qsort( families, nb_families, sizeof(*families), family_name_compare );
+
+    size = 0x10000;
+    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, size ))) goto done;
+    pos = sizeof(*header);
+
+    for (i = 0; i < nb_families; i++)
+    {
+        family = families[i];
+        LIST_FOR_EACH_ENTRY( face, &family->faces, Face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE)) continue;
+
+            len = strlenW( family->FamilyName ) + 1 + strlenW( face->StyleName ) + 1 + strlenW( face->file ) + 1;
+            if (family->EnglishName) len += strlenW( family->EnglishName ) + 1;
+            if (face->FullName) len += strlenW( face->FullName ) + 1;
+            len = (sizeof(*rec) + len * sizeof(WCHAR) + 7) & ~7;
+            if (len > 0xffff * sizeof(WCHAR)) continue;
+
+            if (pos + len > size)
+            {
+                size = max( size * 2, pos + len );
+                if (!(new_buffer = HeapReAlloc( GetProcessHeap(), 0, buffer, size ))) goto done;
+                buffer = new_buffer;
+            }
+
+            rec = (struct font_index_face *)(buffer + pos);
+            memset( rec, 0, len );
+            rec->size             = len;
+            rec->flags            = face->flags;
+            rec->ntmFlags         = face->ntmFlags;
+            rec->font_version     = face->font_version;
+            rec->face_index       = face->face_index;
+            rec->scalable         = face->scalable;
+            rec->dev              = face->dev;
+            rec->ino              = face->ino;
+            rec->fs               = face->fs;
+            rec->size_size        = face->size.size;
+            rec->x_ppem           = face->size.x_ppem;
+            rec->y_ppem           = face->size.y_ppem;
+            rec->height           = face->size.height;
+            rec->width            = face->size.width;
+            rec->internal_leading = face->size.internal_leading;
+
+            str = (WCHAR *)(rec + 1);
+            rec->family_len    = put_index_string( &str, family->FamilyName );
+            rec->english_len   = put_index_string( &str, family->EnglishName );
+            rec->style_len     = put_index_string( &str, face->StyleName );
+            rec->full_name_len = put_index_string( &str, face->FullName );
+            rec->file_len      = put_index_string( &str, face->file );
+            pos += rec->size;
+            count++;
+        }
+    }
+
+    header = (struct font_index_header *)buffer;
+    header->magic       = FONT_INDEX_MAGIC;
+    header->version     = FONT_INDEX_VERSION;
+    header->size        = pos;
+    header->count       = count;
+    header->serial      = serial;
+    header->dir_time[0] = dir_times[0];
+    header->dir_time[1] = dir_times[1];
+
+    /* write to a temporary file and rename it, so that other processes never see a partial index */
+    if (!(path = get_font_index_path( "" )) || !(tmp_path = get_font_index_path( ".tmp" ))) goto done;
+    if ((fd = open( tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666 )) == -1)
+    {
+        WARN( "cannot create %s\n", debugstr_a(tmp_path) );
+        goto done;
+    }
+    ok = (write( fd, buffer, pos ) == pos);
+    if (close( fd )) ok = FALSE;
+    if (!ok || rename( tmp_path, path ))
+    {
+        WARN( "cannot write %s\n", debugstr_a(path) );
+        unlink( tmp_path );
+    }
+    else TRACE( "saved %u faces to %s\n", count, debugstr_a(path) );
+
+done:
+    HeapFree( GetProcessHeap(), 0, tmp_path );
+    HeapFree( GetProcessHeap(), 0, path );
+    HeapFree( GetProcessHeap(), 0, buffer );
+    HeapFree( GetProcessHeap(), 0, families );
+}
+
 static void add_face_to_cache(Face *face)
 {
     HKEY hkey_family, hkey_face;
@@ -1867,6 +2271,7 @@ static void add_face_to_cache(Face *face)
     }
     RegCloseKey(hkey_face);
     RegCloseKey(hkey_family);
+    if (font_list_loaded) update_font_cache_serial();
 }
 
 static void remove_face_from_cache( Face *face )
@@ -1888,6 +2293,7 @@ static void remove_face_from_cache( Face *face )
         HeapFree(GetProcessHeap(), 0, face_key_name);
     }
     RegCloseKey(hkey_family);
+    if (font_list_loaded) update_font_cache_serial();
 }
 
 static WCHAR *prepend_at(WCHAR *family)
@@ -4378,6 +4784,7 @@ BOOL WineEngInit(void)
     HKEY hkey;
     DWORD disposition;
     HANDLE font_mutex;
+    ULONGLONG serial, dir_times[2];
 
     /* update locale dependent font info in registry */
     update_font_info();
@@ -4413,11 +4820,32 @@ BOOL WineEngInit(void)
     WaitForSingleObject(font_mutex, INFINITE);
 
     create_font_cache_key(&hkey_font_cache, &disposition);
+    get_font_dir_times(dir_times);
 
+    if(disposition != REG_CREATED_NEW_KEY)
+    {
+        serial = get_font_cache_serial();
+        switch (load_font_index(serial, dir_times))
+        {
+        case FONT_INDEX_LOADED:
+            break;
+        case FONT_INDEX_DIRS_CHANGED:
+            RegDeleteTreeW(hkey_font_cache, NULL);
+            disposition = REG_CREATED_NEW_KEY;
+            break;
+        case FONT_INDEX_INVALID:
+            load_font_list_from_cache(hkey_font_cache);
+            /* a cache from an older version has no serial yet */
+            if (!serial) serial = update_font_cache_serial();
+            save_font_index(serial, dir_times);
+            break;
+        }
+    }
     if(disposition == REG_CREATED_NEW_KEY)
+    {
         init_font_list();
-    else
-        load_font_list_from_cache(hkey_font_cache);
+        save_font_index(update_font_cache_serial(), dir_times);
+    }
 
     reorder_font_list();
 
@@ -4430,7 +4858,8 @@ BOOL WineEngInit(void)
         update_reg_entries();
 
     init_system_links();
-    
+    font_list_loaded = TRUE;
+
     ReleaseMutex(font_mutex);
     return TRUE;
 }
@@ -4673,6 +5102,8 @@ static GdiFont *alloc_font(void)
     ret->kern_pairs = NULL;
     ret->instance_id = alloc_font_handle(ret);
     list_init(&ret->child_fonts);
+    InitializeCriticalSection(&ret->cs);
+    ret->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": GdiFont.cs");
     return ret;
 }
 
@@ -4701,6 +5132,8 @@ static void free_font(GdiFont *font)
         HeapFree(GetProcessHeap(),0,font->gm[i]);
     HeapFree(GetProcessHeap(), 0, font->gm);
     HeapFree(GetProcessHeap(), 0, font->GSUB_Table);
+    font->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&font->cs);
     HeapFree(GetProcessHeap(), 0, font);
 }
 
@@ -5921,6 +6354,8 @@ found_face:
         }
     }
     ret->aa_flags = HIWORD( face->flags );
+    /* cached fonts may be in use by other threads, so read the table now */
+    if (!get_gasp_flags( ret, &ret->gasp_flags )) ret->gasp_flags = GASP_DOGRAY;
 
     TRACE("caching: gdiFont=%p  hfont=%p\n", ret, hfont);
 
@@ -5958,8 +6393,7 @@ done:
             case WINE_GGO_GRAY16_BITMAP:
                 if ((!antialias_fakes || (!ret->fake_bold && !ret->fake_italic)) && is_hinting_enabled())
                 {
-                    WORD gasp_flags;
-                    if (get_gasp_flags( ret, &gasp_flags ) && !(gasp_flags & GASP_DOGRAY))
+                    if (!(ret->gasp_flags & GASP_DOGRAY))
                     {
                         TRACE( "font %s %d aa disabled by GASP\n",
                                debugstr_w(lf.lfFaceName), lf.lfHeight );
@@ -6594,7 +7028,7 @@ static DWORD freetype_GetGlyphIndices( PHYSDEV dev, LPCWSTR lpstr, INT count, LP
     }
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     for(i = 0; i < count; i++)
     {
@@ -6611,7 +7045,7 @@ static DWORD freetype_GetGlyphIndices( PHYSDEV dev, LPCWSTR lpstr, INT count, LP
         else
             pgi[i] = get_GSUB_vert_glyph(physdev->font, pgi[i]);
     }
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return count;
 }
 
@@ -8237,9 +8671,9 @@ static DWORD freetype_GetGlyphOutline( PHYSDEV dev, UINT glyph, UINT format,
     }
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
     ret = get_glyph_outline( physdev->font, glyph, format, lpgm, &abc, buflen, buf, lpmat );
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return ret;
 }
 
@@ -8258,9 +8692,9 @@ static BOOL freetype_GetTextMetrics( PHYSDEV dev, TEXTMETRICW *metrics )
     }
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
     ret = get_text_metrics( physdev->font, metrics );
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return ret;
 }
 
@@ -8283,7 +8717,7 @@ static UINT freetype_GetOutlineTextMetrics( PHYSDEV dev, UINT cbSize, OUTLINETEX
     if (!FT_IS_SCALABLE( physdev->font->ft_face )) return 0;
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     if (physdev->font->potm || get_outline_text_metrics( physdev->font ))
     {
@@ -8294,7 +8728,7 @@ static UINT freetype_GetOutlineTextMetrics( PHYSDEV dev, UINT cbSize, OUTLINETEX
         }
 	ret = physdev->font->potm->otmSize;
     }
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return ret;
 }
 
@@ -8308,6 +8742,7 @@ static BOOL load_child_font(GdiFont *font, CHILD_FONT *child)
     italic = !!font->font_desc.lf.lfItalic;
     bold = font->font_desc.lf.lfWeight > FW_MEDIUM;
 
+    EnterCriticalSection( &freetype_cs );
     face_list = get_face_list_from_family( child->face->family );
     LIST_FOR_EACH_ENTRY( child_face, face_list, Face, entry )
     {
@@ -8328,8 +8763,10 @@ static BOOL load_child_font(GdiFont *font, CHILD_FONT *child)
     {
         free_font(child->font);
         child->font = NULL;
+        LeaveCriticalSection( &freetype_cs );
         return FALSE;
     }
+    LeaveCriticalSection( &freetype_cs );
 
     child->font->fake_italic = italic && !( child_face->ntmFlags & NTM_ITALIC );
     child->font->fake_bold = bold && !( child_face->ntmFlags & NTM_BOLD );
@@ -8408,12 +8845,12 @@ static BOOL freetype_GetCharWidth( PHYSDEV dev, UINT firstChar, UINT lastChar, L
     TRACE("%p, %d, %d, %p\n", physdev->font, firstChar, lastChar, buffer);
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
     for(c = firstChar; c <= lastChar; c++) {
         get_glyph_outline( physdev->font, c, GGO_METRICS, &gm, &abc, 0, NULL, &identity );
         buffer[c - firstChar] = abc.abcA + abc.abcB + abc.abcC;
     }
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return TRUE;
 }
 
@@ -8470,12 +8907,12 @@ static BOOL freetype_GetCharABCWidths( PHYSDEV dev, UINT firstChar, UINT lastCha
     TRACE("%p, %d, %d, %p\n", physdev->font, firstChar, lastChar, buffer);
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     for(c = firstChar; c <= lastChar; c++, buffer++)
         get_glyph_outline( physdev->font, c, GGO_METRICS, &gm, buffer, 0, NULL, &identity );
 
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return TRUE;
 }
 
@@ -8499,13 +8936,13 @@ static BOOL freetype_GetCharABCWidthsI( PHYSDEV dev, UINT firstChar, UINT count,
         return FALSE;
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     for(c = 0; c < count; c++, buffer++)
         get_glyph_outline( physdev->font, pgi ? pgi[c] : firstChar + c, GGO_METRICS | GGO_GLYPH_INDEX,
                            &gm, buffer, 0, NULL, &identity );
 
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return TRUE;
 }
 
@@ -8529,7 +8966,7 @@ static BOOL freetype_GetTextExtentExPoint( PHYSDEV dev, LPCWSTR wstr, INT count,
     TRACE("%p, %s, %d\n", physdev->font, debugstr_wn(wstr, count), count);
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     for (idx = pos = 0; idx < count; idx++)
     {
@@ -8538,7 +8975,7 @@ static BOOL freetype_GetTextExtentExPoint( PHYSDEV dev, LPCWSTR wstr, INT count,
         dxs[idx] = pos;
     }
 
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return TRUE;
 }
 
@@ -8562,7 +8999,7 @@ static BOOL freetype_GetTextExtentExPointI( PHYSDEV dev, const WORD *indices, IN
     TRACE("%p, %p, %d\n", physdev->font, indices, count);
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
 
     for (idx = pos = 0; idx < count; idx++)
     {
@@ -8572,7 +9009,7 @@ static BOOL freetype_GetTextExtentExPointI( PHYSDEV dev, const WORD *indices, IN
         dxs[idx] = pos;
     }
 
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return TRUE;
 }
 
@@ -8738,9 +9175,9 @@ static BOOL freetype_FontIsLinked( PHYSDEV dev )
     }
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &physdev->font->cs );
     ret = !list_empty(&physdev->font->child_fonts);
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &physdev->font->cs );
     return ret;
 }
 
@@ -8967,7 +9404,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
     }
 
     GDI_CheckNotLock();
-    EnterCriticalSection( &freetype_cs );
+    EnterCriticalSection( &font->cs );
     if (font->total_kern_pairs != (DWORD)-1)
     {
         if (cPairs && kern_pair)
@@ -8977,7 +9414,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
         }
         else cPairs = font->total_kern_pairs;
 
-        LeaveCriticalSection( &freetype_cs );
+        LeaveCriticalSection( &font->cs );
         return cPairs;
     }
 
@@ -8988,7 +9425,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
     if (length == GDI_ERROR)
     {
         TRACE("no kerning data in the font\n");
-        LeaveCriticalSection( &freetype_cs );
+        LeaveCriticalSection( &font->cs );
         return 0;
     }
 
@@ -8996,7 +9433,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
     if (!buf)
     {
         WARN("Out of memory\n");
-        LeaveCriticalSection( &freetype_cs );
+        LeaveCriticalSection( &font->cs );
         return 0;
     }
 
@@ -9008,7 +9445,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
     {
         WARN("Out of memory allocating a glyph index to char code map\n");
         HeapFree(GetProcessHeap(), 0, buf);
-        LeaveCriticalSection( &freetype_cs );
+        LeaveCriticalSection( &font->cs );
         return 0;
     }
 
@@ -9103,7 +9540,7 @@ static DWORD freetype_GetKerningPairs( PHYSDEV dev, DWORD cPairs, KERNINGPAIR *k
     }
     else cPairs = font->total_kern_pairs;
 
-    LeaveCriticalSection( &freetype_cs );
+    LeaveCriticalSection( &font->cs );
     return cPairs;
 }
 
@@ -6953,6 +6953,79 @@ static void test_GetCharWidthI(void)
     ReleaseDC(0, hdc);
 }
 
+struct text_thread_data
+{
+    HFONT hfont;
+    SIZE  size;
+    DWORD bits[64 * 32];
+};
+
+static void draw_text_bits(struct text_thread_data *data)
+{
+    static const char teststr[] = "Wine text";
+    BITMAPINFO info = {{ sizeof(info.bmiHeader), 64, -32, 1, 32, BI_RGB }};
+    HBITMAP hbm, prev_hbm;
+    HFONT prev_hfont;
+    void *bits;
+    HDC hdc;
+
+    hdc = CreateCompatibleDC(0);
+    hbm = CreateDIBSection(hdc, &info, DIB_RGB_COLORS, &bits, NULL, 0);
+    prev_hbm = SelectObject(hdc, hbm);
+    prev_hfont = SelectObject(hdc, data->hfont);
+    GetTextExtentPoint32A(hdc, teststr, strlen(teststr), &data->size);
+    TextOutA(hdc, 0, 0, teststr, strlen(teststr));
+    memcpy(data->bits, bits, sizeof(data->bits));
+    SelectObject(hdc, prev_hfont);
+    SelectObject(hdc, prev_hbm);
+    DeleteObject(hbm);
+    DeleteDC(hdc);
+}
+
+static DWORD WINAPI draw_text_thread(void *arg)
+{
+    struct text_thread_data *data = arg;
+    int i;
+
+    for (i = 0; i < 20; i++) draw_text_bits(data);
+    return 0;
+}
+
+static void test_multithreaded_text(void)
+{
+    struct text_thread_data expect, data[4];
+    HANDLE threads[4];
+    LOGFONTA lf;
+    HFONT hfont;
+    int i;
+
+    memset(&lf, 0, sizeof(lf));
+    strcpy(lf.lfFaceName, "Tahoma");
+    lf.lfHeight = -20;
+    hfont = CreateFontIndirectA(&lf);
+
+    expect.hfont = hfont;
+    draw_text_bits(&expect);
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+    {
+        data[i].hfont = hfont;
+        threads[i] = CreateThread(NULL, 0, draw_text_thread, &data[i], 0, NULL);
+        ok(threads[i] != NULL, "CreateThread failed: %u\n", GetLastError());
+    }
+    WaitForMultipleObjects(ARRAY_SIZE(threads), threads, TRUE, INFINITE);
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+    {
+        CloseHandle(threads[i]);
+        ok(data[i].size.cx == expect.size.cx && data[i].size.cy == expect.size.cy,
+           "thread %d: got size %d,%d, expected %d,%d\n", i,
+           data[i].size.cx, data[i].size.cy, expect.size.cx, expect.size.cy);
+        ok(!memcmp(data[i].bits, expect.bits, sizeof(expect.bits)), "thread %d: text bits differ\n", i);
+    }
+    DeleteObject(hfont);
+}
+
 static INT CALLBACK long_enum_proc(const LOGFONTA *lf, const TEXTMETRICA *tm, DWORD type, LPARAM lparam)
 {
     BOOL *found_font = (BOOL *)lparam;
@@ -7189,6 +7262,54 @@ static void test_GetCharWidthInfo(void)
     ReleaseDC(NULL, hdc);
 }
 
+static void draw_startup_text(void)
+{
+    HDC hdc = CreateCompatibleDC(0);
+    HFONT hfont = CreateFontA(-12, 0, 0, 0, FW_NORMAL, 0, 0, 0, DEFAULT_CHARSET, 0, 0, 0, 0, "Tahoma");
+    HFONT old_font = SelectObject(hdc, hfont);
+    SIZE size;
+
+    GetTextExtentPoint32A(hdc, "startup", 7, &size);
+    SelectObject(hdc, old_font);
+    DeleteObject(hfont);
+    DeleteDC(hdc);
+}
+
+/* every process builds its font list when gdi32 is loaded */
+static void test_startup_time(void)
+{
+    LARGE_INTEGER freq, start, end;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char path_name[MAX_PATH];
+    char **argv;
+    DWORD ret, count, i;
+
+    count = winetest_interactive ? 100 : 5;
+    winetest_get_mainargs(&argv);
+    sprintf(path_name, "%s font startup", argv[0]);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    for (i = 0; i < count; i++)
+    {
+        ret = CreateProcessA(NULL, path_name, NULL, NULL, FALSE, 0, NULL, NULL, &startup, &info);
+        ok(ret, "CreateProcess failed: %u\n", GetLastError());
+        if (!ret) break;
+        winetest_wait_child_process(info.hProcess);
+        CloseHandle(info.hProcess);
+        CloseHandle(info.hThread);
+    }
+    QueryPerformanceCounter(&end);
+    if (!i) return;
+
+    trace("%u processes drawing text in %.1f ms, %.2f ms each\n", i,
+          (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart,
+          (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart / i);
+}
+
 START_TEST(font)
 {
     static const char *test_names[] =
@@ -7207,6 +7328,8 @@ START_TEST(font)
     {
         if (!strcmp(argv[2], "AddFontMemResource"))
             test_AddFontMemResource();
+        else if (!strcmp(argv[2], "startup"))
+            draw_startup_text();
         return;
     }
 
@@ -7270,7 +7393,9 @@ START_TEST(font)
     test_fake_bold_font();
     test_bitmap_font_glyph_index();
     test_GetCharWidthI();
+    test_multithreaded_text();
     test_long_names();
+    test_startup_time();
 
     /* These tests should be last test until RemoveFontResource
      * is properly implemented.
@@ -32,6 +32,9 @@ typedef struct {
     jsdisp_t dispex;
 
     DWORD length;
+
+    /* Elements are kept in dense storage until an operation needs them as regular properties. */
+    dense_elems_t dense;
 } ArrayInstance;
 
 static const WCHAR lengthW[] = {'l','e','n','g','t','h',0};
@@ -103,10 +106,80 @@ static HRESULT get_length(script_ctx_t *ctx, vdisp_t *vdisp, jsdisp_t **jsthis,
     return S_OK;
 }
 
+static inline BOOL is_dense(ArrayInstance *array)
+{
+    return array && !array->dense.sparse;
+}
+
+static BOOL ensure_dense_size(ArrayInstance *array, unsigned size)
+{
+    jsval_t *new_buf;
+    unsigned new_size;
+
+    if(size <= array->dense.size)
+        return TRUE;
+
+    new_size = max(array->dense.size * 2, 8);
+    if(new_size < size)
+        new_size = size;
+
+    new_buf = heap_realloc(array->dense.buf, new_size * sizeof(*new_buf));
+    if(!new_buf)
+        return FALSE;
+
+    array->dense.buf = new_buf;
+    array->dense.size = new_size;
+    return TRUE;
+}
+
+/* Inserts copies of vals at idx, moving the following elements up. */
+static HRESULT insert_dense(ArrayInstance *array, unsigned idx, const jsval_t *vals, unsigned cnt)
+{
+    jsval_t *buf;
+    unsigned i;
+    HRESULT hres;
+
+    assert(idx <= array->dense.cnt && array->dense.cnt + cnt <= DENSE_ELEMS_MAX);
+
+    if(!ensure_dense_size(array, array->dense.cnt + cnt))
+        return E_OUTOFMEMORY;
+
+    if(cnt && !array->dense.props_before)
+        array->dense.props_before = array->dispex.prop_cnt;
+
+    buf = array->dense.buf;
+    memmove(buf+idx+cnt, buf+idx, (array->dense.cnt-idx) * sizeof(*buf));
+
+    for(i = 0; i < cnt; i++) {
+        hres = jsval_copy(vals[i], buf+idx+i);
+        if(FAILED(hres)) {
+            while(i--)
+                jsval_release(buf[idx+i]);
+            memmove(buf+idx, buf+idx+cnt, (array->dense.cnt-idx) * sizeof(*buf));
+            return hres;
+        }
+    }
+
+    array->dense.cnt += cnt;
+    if(array->length < array->dense.cnt)
+        array->length = array->dense.cnt;
+    return S_OK;
+}
+
+static void truncate_dense(ArrayInstance *array, DWORD length)
+{
+    while(array->dense.cnt > length)
+        jsval_release(array->dense.buf[--array->dense.cnt]);
+}
+
 static HRESULT set_length(jsdisp_t *obj, DWORD length)
 {
     if(is_class(obj, JSCLASS_ARRAY)) {
-        array_from_jsdisp(obj)->length = length;
+        ArrayInstance *array = array_from_jsdisp(obj);
+
+        if(is_dense(array))
+            truncate_dense(array, length);
+        array->length = length;
         return S_OK;
     }
 
@@ -153,6 +226,12 @@ static HRESULT Array_set_length(script_ctx_t *ctx, jsdisp_t *jsthis, jsval_t val
     if(len!=(DWORD)len)
         return throw_range_error(ctx, JS_E_INVALID_LENGTH, NULL);
 
+    if(is_dense(This)) {
+        truncate_dense(This, len);
+        This->length = len;
+        return S_OK;
+    }
+
     for(i=len; i < This->length; i++) {
         hres = jsdisp_delete_idx(&This->dispex, i);
         if(FAILED(hres))
@@ -415,6 +494,7 @@ static HRESULT Array_pop(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned
 static HRESULT Array_push(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *jsthis;
     DWORD length = 0;
     unsigned i;
@@ -426,10 +506,17 @@ static HRESULT Array_push(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigne
     if(FAILED(hres))
         return hres;
 
-    for(i=0; i < argc; i++) {
-        hres = jsdisp_propput_idx(jsthis, length+i, argv[i]);
+    array = array_this(vthis);
+    if(is_dense(array) && length == array->dense.cnt && argc <= DENSE_ELEMS_MAX - length) {
+        hres = insert_dense(array, length, argv, argc);
         if(FAILED(hres))
             return hres;
+    }else {
+        for(i=0; i < argc; i++) {
+            hres = jsdisp_propput_idx(jsthis, length+i, argv[i]);
+            if(FAILED(hres))
+                return hres;
+        }
     }
 
     hres = set_length(jsthis, length+argc);
@@ -499,6 +586,7 @@ static HRESULT Array_reverse(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsi
 static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *jsthis;
     DWORD length = 0, i;
     jsval_t v, ret;
@@ -520,6 +608,19 @@ static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsign
         return S_OK;
     }
 
+    array = array_this(vthis);
+    if(is_dense(array) && length == array->dense.cnt) {
+        ret = array->dense.buf[0];
+        memmove(array->dense.buf, array->dense.buf+1, --array->dense.cnt * sizeof(*array->dense.buf));
+        array->length--;
+
+        if(r)
+            *r = ret;
+        else
+            jsval_release(ret);
+        return S_OK;
+    }
+
     hres = jsdisp_get_idx(jsthis, 0, &ret);
     if(hres == DISP_E_UNKNOWNNAME) {
         ret = jsval_undefined();
@@ -553,6 +654,7 @@ static HRESULT Array_shift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsign
 /* ECMA-262 3rd Edition    15.4.4.10 */
 static HRESULT Array_slice(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *arr, *jsthis;
     DOUBLE range;
     DWORD length, start, end, idx;
@@ -594,22 +696,31 @@ static HRESULT Array_slice(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsign
     if(FAILED(hres))
         return hres;
 
-    for(idx=start; idx<end; idx++) {
-        jsval_t v;
-
-        hres = jsdisp_get_idx(jsthis, idx, &v);
-        if(hres == DISP_E_UNKNOWNNAME)
-            continue;
-
-        if(SUCCEEDED(hres)) {
-            hres = jsdisp_propput_idx(arr, idx-start, v);
-            jsval_release(v);
-        }
-
+    array = array_this(vthis);
+    if(is_dense(array) && start < end && end <= array->dense.cnt) {
+        hres = insert_dense(array_from_jsdisp(arr), 0, array->dense.buf+start, end-start);
         if(FAILED(hres)) {
             jsdisp_release(arr);
             return hres;
         }
+    }else {
+        for(idx=start; idx<end; idx++) {
+            jsval_t v;
+
+            hres = jsdisp_get_idx(jsthis, idx, &v);
+            if(hres == DISP_E_UNKNOWNNAME)
+                continue;
+
+            if(SUCCEEDED(hres)) {
+                hres = jsdisp_propput_idx(arr, idx-start, v);
+                jsval_release(v);
+            }
+
+            if(FAILED(hres)) {
+                jsdisp_release(arr);
+                return hres;
+            }
+        }
     }
 
     if(r)
@@ -1116,6 +1227,7 @@ static HRESULT Array_map(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned
 static HRESULT Array_unshift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsigned argc, jsval_t *argv,
         jsval_t *r)
 {
+    ArrayInstance *array;
     jsdisp_t *jsthis;
     WCHAR buf[14], *buf_end, *str;
     DWORD i, length;
@@ -1129,6 +1241,17 @@ static HRESULT Array_unshift(script_ctx_t *ctx, vdisp_t *vthis, WORD flags, unsi
     if(FAILED(hres))
         return hres;
 
+    array = array_this(vthis);
+    if(is_dense(array) && length == array->dense.cnt && argc <= DENSE_ELEMS_MAX - length) {
+        hres = insert_dense(array, 0, argv, argc);
+        if(FAILED(hres))
+            return hres;
+
+        if(r)
+            *r = ctx->version < 2 ? jsval_undefined() : jsval_number(array->length);
+        return S_OK;
+    }
+
     if(argc) {
         buf_end = buf + ARRAY_SIZE(buf)-1;
         *buf_end-- = 0;
@@ -1184,7 +1307,11 @@ static HRESULT Array_get_value(script_ctx_t *ctx, jsdisp_t *jsthis, jsval_t *r)
 
 static void Array_destructor(jsdisp_t *dispex)
 {
-    heap_free(dispex);
+    ArrayInstance *array = array_from_jsdisp(dispex);
+
+    truncate_dense(array, 0);
+    heap_free(array->dense.buf);
+    heap_free(array);
 }
 
 static void Array_on_put(jsdisp_t *dispex, const WCHAR *name)
@@ -1208,6 +1335,52 @@ static void Array_on_put(jsdisp_t *dispex, const WCHAR *name)
         array->length = id+1;
 }
 
+static dense_elems_t *Array_dense_elems(jsdisp_t *dispex)
+{
+    return &array_from_jsdisp(dispex)->dense;
+}
+
+static HRESULT Array_dense_put(jsdisp_t *dispex, unsigned idx, jsval_t val)
+{
+    ArrayInstance *array = array_from_jsdisp(dispex);
+    jsval_t copy;
+    HRESULT hres;
+
+    if(idx == array->dense.cnt)
+        return insert_dense(array, idx, &val, 1);
+
+    hres = jsval_copy(val, &copy);
+    if(FAILED(hres))
+        return hres;
+
+    jsval_release(array->dense.buf[idx]);
+    array->dense.buf[idx] = copy;
+    return S_OK;
+}
+
+static HRESULT Array_dense_to_sparse(jsdisp_t *dispex)
+{
+    ArrayInstance *array = array_from_jsdisp(dispex);
+    jsval_t *buf = array->dense.buf;
+    unsigned i, cnt = array->dense.cnt;
+    HRESULT hres = S_OK;
+
+    TRACE("%p %u\n", array, cnt);
+
+    array->dense.sparse = TRUE;
+    array->dense.buf = NULL;
+    array->dense.cnt = array->dense.size = 0;
+
+    for(i = 0; i < cnt; i++) {
+        if(SUCCEEDED(hres))
+            hres = jsdisp_propput_idx(&array->dispex, i, buf[i]);
+        jsval_release(buf[i]);
+    }
+
+    heap_free(buf);
+    return hres;
+}
+
 static const builtin_prop_t Array_props[] = {
     {concatW,                Array_concat,               PROPF_METHOD|1},
     {forEachW,               Array_forEach,              PROPF_METHOD|PROPF_ES5|1},
@@ -1233,7 +1406,13 @@ static const builtin_info_t Array_info = {
     ARRAY_SIZE(Array_props),
     Array_props,
     Array_destructor,
-    Array_on_put
+    Array_on_put,
+    NULL,
+    NULL,
+    NULL,
+    Array_dense_elems,
+    Array_dense_put,
+    Array_dense_to_sparse
 };
 
 static const builtin_prop_t ArrayInst_props[] = {
@@ -1246,7 +1425,13 @@ static const builtin_info_t ArrayInst_info = {
     ARRAY_SIZE(ArrayInst_props),
     ArrayInst_props,
     Array_destructor,
-    Array_on_put
+    Array_on_put,
+    NULL,
+    NULL,
+    NULL,
+    Array_dense_elems,
+    Array_dense_put,
+    Array_dense_to_sparse
 };
 
 /* ECMA-262 5.1 Edition    15.4.3.2 */
@@ -28,6 +28,12 @@ WINE_DEFAULT_DEBUG_CHANNEL(jscript);
 #define FDEX_VERSION_MASK 0xf0000000
 #define GOLDEN_RATIO 0x9E3779B9U
 
+/* DISPIDs of elements kept in dense storage, see dense_elems_t */
+#define DENSE_ID_BASE 0x40000000
+#define DENSE_ID(idx) ((DISPID)(DENSE_ID_BASE + (idx)))
+
+static const WCHAR idx_formatW[] = {'%','u',0};
+
 typedef enum {
     PROP_JSVAL,
     PROP_BUILTIN,
@@ -71,6 +77,51 @@ static inline dispex_prop_t *get_prop(jsdisp_t *This, DISPID id)
     return This->props+id;
 }
 
+static inline dense_elems_t *get_dense_storage(jsdisp_t *This)
+{
+    return This->builtin_info->dense_elems ? This->builtin_info->dense_elems(This) : NULL;
+}
+
+static inline dense_elems_t *get_dense(jsdisp_t *This)
+{
+    dense_elems_t *dense = get_dense_storage(This);
+    return dense && !dense->sparse ? dense : NULL;
+}
+
+static inline BOOL is_dense_id(jsdisp_t *This, DISPID id)
+{
+    return id >= DENSE_ID_BASE && This->builtin_info->dense_elems;
+}
+
+static jsval_t *get_dense_elem(jsdisp_t *This, DISPID id)
+{
+    dense_elems_t *dense = get_dense(This);
+    unsigned idx = id - DENSE_ID_BASE;
+
+    return dense && idx < dense->cnt ? dense->buf+idx : NULL;
+}
+
+static BOOL parse_array_idx(const WCHAR *name, unsigned *ret)
+{
+    const WCHAR *ptr = name;
+    unsigned idx = 0;
+
+    if(!isdigitW(*ptr) || (*ptr == '0' && ptr[1]))
+        return FALSE;
+
+    for(; isdigitW(*ptr); ptr++) {
+        if(idx > (0xfffffffe - (*ptr-'0')) / 10)
+            return FALSE;
+        idx = idx*10 + (*ptr-'0');
+    }
+
+    if(*ptr)
+        return FALSE;
+
+    *ret = idx;
+    return TRUE;
+}
+
 static DWORD get_flags(jsdisp_t *This, dispex_prop_t *prop)
 {
     if(prop->type == PROP_PROTREF) {
@@ -161,10 +212,23 @@ static inline HRESULT resize_props(jsdisp_t *This)
     return S_OK;
 }
 
+static HRESULT dense_to_sparse(jsdisp_t *This, dense_elems_t *dense)
+{
+    /* The elements are appended to the property table, remember where for GetNextDispID. */
+    dense->sparse_pos = This->prop_cnt;
+    dense->sparse_cnt = dense->cnt;
+    return This->builtin_info->dense_to_sparse(This);
+}
+
 static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_type_t type, DWORD flags)
 {
+    dense_elems_t *dense;
     dispex_prop_t *prop;
-    unsigned bucket;
+    unsigned bucket, idx;
+
+    /* Elements can be regular properties only once the object stopped using dense storage. */
+    if((dense = get_dense(This)) && parse_array_idx(name, &idx) && FAILED(dense_to_sparse(This, dense)))
+        return NULL;
 
     if(FAILED(resize_props(This)))
         return NULL;
@@ -195,11 +259,40 @@ static dispex_prop_t *alloc_protref(jsdisp_t *This, const WCHAR *name, DWORD ref
     return ret;
 }
 
+/*
+ * Own properties created after the first element have to follow it in for-in
+ * order, which only regular properties can express. Called before such a
+ * property is created, updates *prop if the property table was reallocated.
+ */
+static HRESULT dense_add_prop(jsdisp_t *This, dispex_prop_t **prop)
+{
+    dense_elems_t *dense = get_dense(This);
+    DWORD pos = *prop ? *prop - This->props : 0;
+    HRESULT hres;
+
+    if(!dense || !dense->props_before)
+        return S_OK;
+
+    hres = dense_to_sparse(This, dense);
+    if(*prop)
+        *prop = This->props + pos;
+    return hres;
+}
+
 static HRESULT find_prop_name(jsdisp_t *This, unsigned hash, const WCHAR *name, dispex_prop_t **ret)
 {
     const builtin_prop_t *builtin;
     unsigned bucket, pos, prev = 0;
+    dense_elems_t *dense;
     dispex_prop_t *prop;
+    unsigned idx;
+
+    /* Existing elements looked up by name need to be regular properties. */
+    if((dense = get_dense(This)) && parse_array_idx(name, &idx) && idx < dense->cnt) {
+        HRESULT hres = dense_to_sparse(This, dense);
+        if(FAILED(hres))
+            return hres;
+    }
 
     bucket = get_props_idx(This, hash);
     pos = This->props[bucket].bucket_head;
@@ -305,6 +398,10 @@ static HRESULT ensure_prop_name(jsdisp_t *This, const WCHAR *name, DWORD create_
     if(SUCCEEDED(hres) && (!prop || prop->type == PROP_DELETED)) {
         TRACE("creating prop %s flags %x\n", debugstr_w(name), create_flags);
 
+        hres = dense_add_prop(This, &prop);
+        if(FAILED(hres))
+            return hres;
+
         if(prop) {
             prop->type = PROP_JSVAL;
             prop->flags = create_flags;
@@ -322,6 +419,91 @@ static HRESULT ensure_prop_name(jsdisp_t *This, const WCHAR *name, DWORD create_
     return hres;
 }
 
+/* Returns S_FALSE if the object switched to regular properties and the element has to be looked up by name. */
+static HRESULT dense_get_id(jsdisp_t *This, dense_elems_t *dense, unsigned idx, DWORD flags, DISPID *id)
+{
+    HRESULT hres;
+
+    if(idx < dense->cnt) {
+        *id = DENSE_ID(idx);
+        return S_OK;
+    }
+
+    if(flags & fdexNameEnsure) {
+        /* The element is appended by the assignment, see disp_propput. */
+        if(idx == dense->cnt && idx < DENSE_ELEMS_MAX) {
+            *id = DENSE_ID(idx);
+            return S_OK;
+        }
+    }else {
+        dispex_prop_t *prop = NULL;
+        WCHAR name[12];
+
+        if(This->prototype) {
+            sprintfW(name, idx_formatW, idx);
+            hres = find_prop_name_prot(This->prototype, string_hash(name), name, &prop);
+            if(FAILED(hres))
+                return hres;
+        }
+        if(!prop || prop->type == PROP_DELETED)
+            return DISP_E_UNKNOWNNAME;
+    }
+
+    hres = dense_to_sparse(This, dense);
+    return FAILED(hres) ? hres : S_FALSE;
+}
+
+/* Returns S_FALSE if the object switched to regular properties and the element has to be deleted by name. */
+static HRESULT dense_delete(jsdisp_t *This, dense_elems_t *dense, unsigned idx)
+{
+    HRESULT hres;
+
+    if(idx >= dense->cnt)
+        return S_OK;
+
+    if(idx == dense->cnt-1) {
+        jsval_release(dense->buf[--dense->cnt]);
+        return S_OK;
+    }
+
+    hres = dense_to_sparse(This, dense);
+    return FAILED(hres) ? hres : S_FALSE;
+}
+
+/* Looks up the property of an element DISPID that can't be served from dense storage. */
+static HRESULT get_dense_id_prop(jsdisp_t *This, DISPID id, BOOL prot, dispex_prop_t **ret)
+{
+    dense_elems_t *dense = get_dense(This);
+    dispex_prop_t *prop = NULL;
+    WCHAR name[12];
+    HRESULT hres;
+
+    sprintfW(name, idx_formatW, id - DENSE_ID_BASE);
+
+    /* Missing elements only need regular properties if a prototype provides them. */
+    if(dense && id - DENSE_ID_BASE >= dense->cnt) {
+        if(prot && This->prototype) {
+            hres = find_prop_name_prot(This->prototype, string_hash(name), name, &prop);
+            if(FAILED(hres))
+                return hres;
+        }
+        if(!prop || prop->type == PROP_DELETED) {
+            *ret = NULL;
+            return S_OK;
+        }
+    }
+
+    if(prot)
+        hres = find_prop_name_prot(This, string_hash(name), name, &prop);
+    else
+        hres = find_prop_name(This, string_hash(name), name, &prop);
+    if(FAILED(hres))
+        return hres;
+
+    *ret = prop && prop->type != PROP_DELETED ? prop : NULL;
+    return S_OK;
+}
+
 static IDispatch *get_this(DISPPARAMS *dp)
 {
     DWORD i;
@@ -514,6 +696,10 @@ static HRESULT prop_put(jsdisp_t *This, dispex_prop_t *prop, jsval_t val)
         return prop->u.p->setter(This->ctx, This, val);
     case PROP_PROTREF:
     case PROP_DELETED:
+        hres = dense_add_prop(This, &prop);
+        if(FAILED(hres))
+            return hres;
+
         prop->type = PROP_JSVAL;
         prop->flags = PROPF_ENUMERABLE | PROPF_CONFIGURABLE | PROPF_WRITABLE;
         prop->u.val = jsval_undefined();
@@ -562,6 +748,7 @@ HRESULT builtin_set_const(script_ctx_t *ctx, jsdisp_t *jsthis, jsval_t value)
 static HRESULT fill_protrefs(jsdisp_t *This)
 {
     dispex_prop_t *iter, *prop;
+    dense_elems_t *dense;
     HRESULT hres;
 
     if(!This->prototype)
@@ -569,6 +756,13 @@ static HRESULT fill_protrefs(jsdisp_t *This)
 
     fill_protrefs(This->prototype);
 
+    /* Inherited elements need to be regular properties to get protrefs. */
+    if((dense = get_dense(This->prototype)) && dense->cnt) {
+        hres = dense_to_sparse(This->prototype, dense);
+        if(FAILED(hres))
+            return hres;
+    }
+
     for(iter = This->prototype->props; iter < This->prototype->props+This->prototype->prop_cnt; iter++) {
         if(!iter->name)
             continue;
@@ -713,10 +907,27 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
     if(pvarRes)
         V_VT(pvarRes) = VT_EMPTY;
 
-    prop = get_prop(This, id);
-    if(!prop || prop->type == PROP_DELETED) {
-        TRACE("invalid id\n");
-        return DISP_E_MEMBERNOTFOUND;
+    if(is_dense_id(This, id)) {
+        /*
+         * Element reads and writes are served by jsdisp_propget and jsdisp_propput_idx, ids
+         * returned by fdexNameEnsure may refer to elements that don't exist yet.
+         */
+        prop = NULL;
+        if(wFlags & (DISPATCH_METHOD|DISPATCH_CONSTRUCT)) {
+            hres = get_dense_id_prop(This, id, TRUE, &prop);
+            if(FAILED(hres))
+                return hres;
+            if(!prop) {
+                TRACE("invalid id\n");
+                return DISP_E_MEMBERNOTFOUND;
+            }
+        }
+    }else {
+        prop = get_prop(This, id);
+        if(!prop || prop->type == PROP_DELETED) {
+            TRACE("invalid id\n");
+            return DISP_E_MEMBERNOTFOUND;
+        }
     }
 
     clear_ei(This->ctx);
@@ -746,14 +957,16 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
     case DISPATCH_PROPERTYGET: {
         jsval_t r;
 
-        hres = prop_get(This, prop, &r);
+        hres = prop ? prop_get(This, prop, &r) : jsdisp_propget(This, id, &r);
         if(SUCCEEDED(hres)) {
             hres = jsval_to_variant(r, pvarRes);
             jsval_release(r);
         }
         break;
     }
-    case DISPATCH_PROPERTYPUT: {
+    case DISPATCH_PROPERTYPUT:
+    case DISPATCH_PROPERTYPUTREF:
+    case DISPATCH_PROPERTYPUT|DISPATCH_PROPERTYPUTREF: {
         jsval_t val;
         DWORD i;
 
@@ -771,7 +984,7 @@ static HRESULT WINAPI DispatchEx_InvokeEx(IDispatchEx *iface, DISPID id, LCID lc
         if(FAILED(hres))
             return hres;
 
-        hres = prop_put(This, prop, val);
+        hres = prop ? prop_put(This, prop, val) : jsdisp_propput_idx(This, id - DENSE_ID_BASE, val);
         jsval_release(val);
         break;
     }
@@ -834,7 +1047,22 @@ static HRESULT WINAPI DispatchEx_DeleteMemberByDispID(IDispatchEx *iface, DISPID
 
     TRACE("(%p)->(%x)\n", This, id);
 
-    prop = get_prop(This, id);
+    if(is_dense_id(This, id)) {
+        dense_elems_t *dense = get_dense(This);
+        HRESULT hres;
+
+        if(dense) {
+            hres = dense_delete(This, dense, id - DENSE_ID_BASE);
+            if(hres != S_FALSE)
+                return hres;
+        }
+
+        hres = get_dense_id_prop(This, id, FALSE, &prop);
+        if(FAILED(hres))
+            return hres;
+    }else {
+        prop = get_prop(This, id);
+    }
     if(!prop) {
         WARN("invalid id\n");
         return DISP_E_MEMBERNOTFOUND;
@@ -857,6 +1085,22 @@ static HRESULT WINAPI DispatchEx_GetMemberName(IDispatchEx *iface, DISPID id, BS
 
     TRACE("(%p)->(%x %p)\n", This, id, pbstrName);
 
+    if(is_dense_id(This, id)) {
+        WCHAR name[12];
+
+        if(!get_dense_elem(This, id)) {
+            HRESULT hres = get_dense_id_prop(This, id, TRUE, &prop);
+            if(FAILED(hres))
+                return hres;
+            if(!prop)
+                return DISP_E_MEMBERNOTFOUND;
+        }
+
+        sprintfW(name, idx_formatW, id - DENSE_ID_BASE);
+        *pbstrName = SysAllocString(name);
+        return *pbstrName ? S_OK : E_OUTOFMEMORY;
+    }
+
     prop = get_prop(This, id);
     if(!prop || !prop->name || prop->type == PROP_DELETED)
         return DISP_E_MEMBERNOTFOUND;
@@ -868,9 +1112,51 @@ static HRESULT WINAPI DispatchEx_GetMemberName(IDispatchEx *iface, DISPID id, BS
     return S_OK;
 }
 
+/*
+ * Splits the property table into the ranges enumerated in order. Dense
+ * elements are enumerated before ranges[*elems_range].
+ */
+static unsigned get_enum_ranges(jsdisp_t *This, DWORD ranges[4][2], unsigned *elems_range)
+{
+    dense_elems_t *dense = get_dense_storage(This);
+    DWORD before, pos, end;
+
+    if(!dense) {
+        ranges[0][0] = 0;
+        ranges[0][1] = This->prop_cnt;
+        *elems_range = 1;
+        return 1;
+    }
+
+    before = min(dense->props_before, This->prop_cnt);
+    ranges[0][0] = 0;
+    ranges[0][1] = before;
+    *elems_range = 1;
+
+    if(!dense->sparse) {
+        ranges[1][0] = before;
+        ranges[1][1] = This->prop_cnt;
+        return 2;
+    }
+
+    /* The elements moved to the end of the table when the object switched to regular properties. */
+    pos = min(max(dense->sparse_pos, before), This->prop_cnt);
+    end = min(pos + dense->sparse_cnt, This->prop_cnt);
+    ranges[1][0] = pos;
+    ranges[1][1] = end;
+    ranges[2][0] = before;
+    ranges[2][1] = pos;
+    ranges[3][0] = end;
+    ranges[3][1] = This->prop_cnt;
+    return 4;
+}
+
 static HRESULT WINAPI DispatchEx_GetNextDispID(IDispatchEx *iface, DWORD grfdex, DISPID id, DISPID *pid)
 {
     jsdisp_t *This = impl_from_IDispatchEx(iface);
+    unsigned range, range_cnt, elems_range;
+    DWORD ranges[4][2], pos;
+    dense_elems_t *dense;
     dispex_prop_t *iter;
     HRESULT hres;
 
@@ -882,19 +1168,59 @@ static HRESULT WINAPI DispatchEx_GetNextDispID(IDispatchEx *iface, DWORD grfdex,
             return hres;
     }
 
-    if(id+1>=0 && id+1<This->prop_cnt) {
-        iter = &This->props[id+1];
+    range_cnt = get_enum_ranges(This, ranges, &elems_range);
+
+    if(is_dense_id(This, id) && (dense = get_dense(This))) {
+        unsigned idx = id - DENSE_ID_BASE;
+
+        if(idx+1 < dense->cnt) {
+            *pid = DENSE_ID(idx+1);
+            return S_OK;
+        }
+
+        range = elems_range;
+        pos = 0;
     }else {
-        *pid = DISPID_STARTENUM;
-        return S_FALSE;
+        if(is_dense_id(This, id)) {
+            WCHAR name[12];
+
+            /* The elements were moved to the property table, continue after the current one. */
+            sprintfW(name, idx_formatW, id - DENSE_ID_BASE);
+            hres = find_prop_name(This, string_hash(name), name, &iter);
+            if(FAILED(hres))
+                return hres;
+            if(!iter) {
+                *pid = DISPID_STARTENUM;
+                return S_FALSE;
+            }
+            id = prop_to_id(This, iter);
+        }
+
+        if(id == DISPID_STARTENUM) {
+            range = 0;
+            pos = 0;
+        }else {
+            for(range = 0; range < range_cnt; range++) {
+                if(ranges[range][0] <= id && id < ranges[range][1])
+                    break;
+            }
+            pos = id+1;
+        }
     }
 
-    while(iter < This->props + This->prop_cnt) {
-        if(iter->name && (get_flags(This, iter) & PROPF_ENUMERABLE) && iter->type!=PROP_DELETED) {
-            *pid = prop_to_id(This, iter);
+    while(range < range_cnt) {
+        for(iter = This->props+max(pos, ranges[range][0]); iter < This->props+ranges[range][1]; iter++) {
+            if(iter->name && (get_flags(This, iter) & PROPF_ENUMERABLE) && iter->type!=PROP_DELETED) {
+                *pid = prop_to_id(This, iter);
+                return S_OK;
+            }
+        }
+
+        if(++range == elems_range && (dense = get_dense(This)) && dense->cnt) {
+            *pid = DENSE_ID(0);
             return S_OK;
         }
-        iter++;
+        pos = 0;
     }
 
     *pid = DISPID_STARTENUM;
@@ -1087,9 +1413,17 @@ jsdisp_t *iface_to_jsdisp(IDispatch *iface)
 
 HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *id)
 {
+    dense_elems_t *dense;
     dispex_prop_t *prop;
+    unsigned idx;
     HRESULT hres;
 
+    if((dense = get_dense(jsdisp)) && parse_array_idx(name, &idx)) {
+        hres = dense_get_id(jsdisp, dense, idx, flags, id);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     if(flags & fdexNameEnsure)
         hres = ensure_prop_name(jsdisp, name, PROPF_ENUMERABLE | PROPF_CONFIGURABLE | PROPF_WRITABLE,
                                 &prop);
@@ -1107,6 +1441,22 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+HRESULT jsdisp_get_idx_id(jsdisp_t *jsdisp, DWORD idx, DWORD flags, DISPID *id)
+{
+    dense_elems_t *dense;
+    WCHAR name[12];
+    HRESULT hres;
+
+    if((dense = get_dense(jsdisp)) && idx != 0xffffffff) {
+        hres = dense_get_id(jsdisp, dense, idx, flags, id);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
+    sprintfW(name, idx_formatW, idx);
+    return jsdisp_get_id(jsdisp, name, flags, id);
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -1135,7 +1485,25 @@ HRESULT jsdisp_call(jsdisp_t *disp, DISPID id, WORD flags, unsigned argc, jsval_
 {
     dispex_prop_t *prop;
 
-    prop = get_prop(disp, id);
+    if(is_dense_id(disp, id)) {
+        jsval_t *elem;
+        HRESULT hres;
+
+        if((elem = get_dense_elem(disp, id))) {
+            if(!is_object_instance(*elem)) {
+                FIXME("invoke %s\n", debugstr_jsval(*elem));
+                return E_FAIL;
+            }
+
+            return disp_call_value(disp->ctx, get_object(*elem), to_disp(disp), flags, argc, argv, r);
+        }
+
+        hres = get_dense_id_prop(disp, id, TRUE, &prop);
+        if(FAILED(hres))
+            return hres;
+    }else {
+        prop = get_prop(disp, id);
+    }
     if(!prop)
         return DISP_E_MEMBERNOTFOUND;
 
@@ -1369,10 +1737,22 @@ HRESULT jsdisp_propput_name(jsdisp_t *obj, const WCHAR *name, jsval_t val)
 
 HRESULT jsdisp_propput_idx(jsdisp_t *obj, DWORD idx, jsval_t val)
 {
+    dense_elems_t *dense;
     WCHAR buf[12];
 
     static const WCHAR formatW[] = {'%','d',0};
 
+    if((dense = get_dense(obj))) {
+        HRESULT hres;
+
+        if(idx <= dense->cnt && idx < DENSE_ELEMS_MAX)
+            return obj->builtin_info->dense_put(obj, idx, val);
+
+        hres = dense_to_sparse(obj, dense);
+        if(FAILED(hres))
+            return hres;
+    }
+
     sprintfW(buf, formatW, idx);
     return jsdisp_propput_name(obj, buf, val);
 }
@@ -1386,11 +1766,13 @@ HRESULT disp_propput(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t val)
     if(jsdisp) {
         dispex_prop_t *prop;
 
-        prop = get_prop(jsdisp, id);
-        if(prop)
-            hres = prop_put(jsdisp, prop, val);
-        else
-            hres = DISP_E_MEMBERNOTFOUND;
+        /* Element ids returned by fdexNameEnsure may refer to elements that don't exist yet. */
+        if(is_dense_id(jsdisp, id)) {
+            hres = jsdisp_propput_idx(jsdisp, id - DENSE_ID_BASE, val);
+        }else {
+            prop = get_prop(jsdisp, id);
+            hres = prop ? prop_put(jsdisp, prop, val) : DISP_E_MEMBERNOTFOUND;
+        }
 
         jsdisp_release(jsdisp);
     }else {
@@ -1445,12 +1827,28 @@ HRESULT jsdisp_propget_name(jsdisp_t *obj, const WCHAR *name, jsval_t *val)
 
 HRESULT jsdisp_get_idx(jsdisp_t *obj, DWORD idx, jsval_t *r)
 {
+    dense_elems_t *dense;
     WCHAR name[12];
     dispex_prop_t *prop;
     HRESULT hres;
 
     static const WCHAR formatW[] = {'%','d',0};
 
+    if((dense = get_dense(obj))) {
+        DISPID id;
+
+        if(idx < dense->cnt)
+            return jsval_copy(dense->buf[idx], r);
+
+        hres = dense_get_id(obj, dense, idx, 0, &id);
+        if(hres == DISP_E_UNKNOWNNAME) {
+            *r = jsval_undefined();
+            return hres;
+        }
+        if(FAILED(hres))
+            return hres;
+    }
+
     sprintfW(name, formatW, idx);
 
     hres = find_prop_name_prot(obj, string_hash(name), name, &prop);
@@ -1469,7 +1867,23 @@ HRESULT jsdisp_propget(jsdisp_t *jsdisp, DISPID id, jsval_t *val)
 {
     dispex_prop_t *prop;
 
-    prop = get_prop(jsdisp, id);
+    if(is_dense_id(jsdisp, id)) {
+        jsval_t *elem;
+        HRESULT hres;
+
+        if((elem = get_dense_elem(jsdisp, id)))
+            return jsval_copy(*elem, val);
+
+        hres = get_dense_id_prop(jsdisp, id, TRUE, &prop);
+        if(FAILED(hres))
+            return hres;
+        if(!prop) {
+            *val = jsval_undefined();
+            return S_OK;
+        }
+    }else {
+        prop = get_prop(jsdisp, id);
+    }
     if(!prop)
         return DISP_E_MEMBERNOTFOUND;
 
@@ -1515,11 +1929,18 @@ HRESULT disp_propget(script_ctx_t *ctx, IDispatch *disp, DISPID id, jsval_t *val
 HRESULT jsdisp_delete_idx(jsdisp_t *obj, DWORD idx)
 {
     static const WCHAR formatW[] = {'%','d',0};
+    dense_elems_t *dense;
     WCHAR buf[12];
     dispex_prop_t *prop;
     BOOL b;
     HRESULT hres;
 
+    if((dense = get_dense(obj))) {
+        hres = dense_delete(obj, dense, idx);
+        if(hres != S_FALSE)
+            return hres;
+    }
+
     sprintfW(buf, formatW, idx);
 
     hres = find_prop_name(obj, string_hash(buf), buf, &prop);
@@ -1537,13 +1958,23 @@ HRESULT disp_delete(IDispatch *disp, DISPID id, BOOL *ret)
 
     jsdisp = iface_to_jsdisp(disp);
     if(jsdisp) {
-        dispex_prop_t *prop;
+        dispex_prop_t *prop = NULL;
 
-        prop = get_prop(jsdisp, id);
-        if(prop)
+        if(is_dense_id(jsdisp, id)) {
+            dense_elems_t *dense = get_dense(jsdisp);
+
+            hres = dense ? dense_delete(jsdisp, dense, id - DENSE_ID_BASE) : S_FALSE;
+            if(hres == S_FALSE)
+                hres = get_dense_id_prop(jsdisp, id, FALSE, &prop);
+            if(hres == S_OK && !prop)
+                *ret = TRUE;
+        }else {
+            prop = get_prop(jsdisp, id);
+            hres = prop ? S_OK : DISP_E_MEMBERNOTFOUND;
+        }
+
+        if(SUCCEEDED(hres) && prop)
             hres = delete_prop(prop, ret);
-        else
-            hres = DISP_E_MEMBERNOTFOUND;
 
         jsdisp_release(jsdisp);
         return hres;
@@ -1573,8 +2004,10 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
 
     jsdisp = iface_to_jsdisp(disp);
     if(jsdisp) {
+        dense_elems_t *dense;
         dispex_prop_t *prop;
         const WCHAR *ptr;
+        unsigned idx;
 
         ptr = jsstr_flatten(name);
         if(!ptr) {
@@ -1582,6 +2015,15 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
             return E_OUTOFMEMORY;
         }
 
+        if((dense = get_dense(jsdisp)) && parse_array_idx(ptr, &idx)) {
+            hres = dense_delete(jsdisp, dense, idx);
+            if(hres != S_FALSE) {
+                *ret = TRUE;
+                jsdisp_release(jsdisp);
+                return hres;
+            }
+        }
+
         hres = find_prop_name(jsdisp, string_hash(ptr), ptr, &prop);
         if(prop) {
             hres = delete_prop(prop, ret);
@@ -1626,9 +2068,27 @@ HRESULT disp_delete_name(script_ctx_t *ctx, IDispatch *disp, jsstr_t *name, BOOL
 HRESULT jsdisp_get_own_property(jsdisp_t *obj, const WCHAR *name, BOOL flags_only,
                                 property_desc_t *desc)
 {
+    dense_elems_t *dense;
     dispex_prop_t *prop;
+    unsigned idx;
     HRESULT hres;
 
+    if((dense = get_dense(obj)) && parse_array_idx(name, &idx)) {
+        if(idx >= dense->cnt)
+            return DISP_E_UNKNOWNNAME;
+
+        memset(desc, 0, sizeof(*desc));
+        desc->explicit_value = TRUE;
+        if(!flags_only) {
+            hres = jsval_copy(dense->buf[idx], &desc->value);
+            if(FAILED(hres))
+                return hres;
+        }
+        desc->flags = PROPF_ENUMERABLE | PROPF_WRITABLE | PROPF_CONFIGURABLE;
+        desc->mask = PROPF_ENUMERABLE | PROPF_WRITABLE | PROPF_CONFIGURABLE;
+        return S_OK;
+    }
+
     hres = find_prop_name(obj, string_hash(name), name, &prop);
     if(FAILED(hres))
         return hres;
@@ -1676,6 +2136,12 @@ HRESULT jsdisp_define_property(jsdisp_t *obj, const WCHAR *name, property_desc_t
     if(FAILED(hres))
         return hres;
 
+    if(!prop || prop->type == PROP_DELETED || prop->type == PROP_PROTREF) {
+        hres = dense_add_prop(obj, &prop);
+        if(FAILED(hres))
+            return hres;
+    }
+
     if(!prop && !(prop = alloc_prop(obj, name, PROP_DELETED, 0)))
        return E_OUTOFMEMORY;
 
@@ -1014,14 +1014,32 @@ static HRESULT interp_func(script_ctx_t *ctx)
     return stack_push(ctx, jsval_obj(dispex));
 }
 
+/* Returns TRUE if v is a number that is a valid array index, so its string conversion may be skipped. */
+static inline BOOL get_array_idx(jsval_t v, DWORD *ret)
+{
+    double n;
+
+    if(!is_number(v))
+        return FALSE;
+
+    n = get_number(v);
+    if(!(n >= 0.0 && n < 4294967295.0) || n != (DWORD)n)
+        return FALSE;
+
+    *ret = n;
+    return TRUE;
+}
+
 /* ECMA-262 3rd Edition    11.2.1 */
 static HRESULT interp_array(script_ctx_t *ctx)
 {
     jsstr_t *name_str;
     const WCHAR *name;
     jsval_t v, namev;
+    jsdisp_t *jsdisp;
     IDispatch *obj;
     DISPID id;
+    DWORD idx;
     HRESULT hres;
 
     TRACE("\n");
@@ -1034,15 +1052,19 @@ static HRESULT interp_array(script_ctx_t *ctx)
         return hres;
     }
 
-    hres = to_flat_string(ctx, namev, &name_str, &name);
-    jsval_release(namev);
-    if(FAILED(hres)) {
-        IDispatch_Release(obj);
-        return hres;
-    }
+    if(get_array_idx(namev, &idx) && (jsdisp = to_jsdisp(obj))) {
+        hres = jsdisp_get_idx_id(jsdisp, idx, 0, &id);
+    }else {
+        hres = to_flat_string(ctx, namev, &name_str, &name);
+        jsval_release(namev);
+        if(FAILED(hres)) {
+            IDispatch_Release(obj);
+            return hres;
+        }
 
-    hres = disp_get_id(ctx, obj, name, NULL, 0, &id);
-    jsstr_release(name_str);
+        hres = disp_get_id(ctx, obj, name, NULL, 0, &id);
+        jsstr_release(name_str);
+    }
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1092,9 +1114,11 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     jsval_t objv, namev;
     const WCHAR *name;
     jsstr_t *name_str;
+    jsdisp_t *jsdisp;
     IDispatch *obj;
     exprval_t ref;
     DISPID id;
+    DWORD idx;
     HRESULT hres;
 
     TRACE("%x\n", arg);
@@ -1104,17 +1128,21 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
 
     hres = to_object(ctx, objv, &obj);
     jsval_release(objv);
-    if(SUCCEEDED(hres)) {
-        hres = to_flat_string(ctx, namev, &name_str, &name);
+    if(SUCCEEDED(hres) && get_array_idx(namev, &idx) && (jsdisp = to_jsdisp(obj))) {
+        hres = jsdisp_get_idx_id(jsdisp, idx, arg, &id);
+    }else {
+        if(SUCCEEDED(hres)) {
+            hres = to_flat_string(ctx, namev, &name_str, &name);
+            if(FAILED(hres))
+                IDispatch_Release(obj);
+        }
+        jsval_release(namev);
         if(FAILED(hres))
-            IDispatch_Release(obj);
-    }
-    jsval_release(namev);
-    if(FAILED(hres))
-        return hres;
+            return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
-    jsstr_release(name_str);
+        hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+        jsstr_release(name_str);
+    }
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
         ref.u.idref.disp = obj;
@@ -73,6 +73,7 @@ void script_release(script_ctx_t *ctx)
     clear_ei(ctx);
     if(ctx->cc)
         release_cc(ctx->cc);
+    release_regexp_cache(ctx);
     heap_pool_free(&ctx->tmp_heap);
     if(ctx->last_match)
         jsstr_release(ctx->last_match);
@@ -62,7 +62,7 @@ typedef struct {
 } heap_pool_t;
 
 void heap_pool_init(heap_pool_t*) DECLSPEC_HIDDEN;
-void *heap_pool_alloc(heap_pool_t*,DWORD) __WINE_ALLOC_SIZE(2) DECLSPEC_HIDDEN;
+void *heap_pool_alloc(heap_pool_t*,size_t) __WINE_ALLOC_SIZE(2) DECLSPEC_HIDDEN;
 void *heap_pool_grow(heap_pool_t*,void*,DWORD,DWORD) DECLSPEC_HIDDEN;
 void heap_pool_clear(heap_pool_t*) DECLSPEC_HIDDEN;
 void heap_pool_free(heap_pool_t*) DECLSPEC_HIDDEN;
@@ -210,6 +210,29 @@ typedef struct {
     builtin_setter_t setter;
 } builtin_prop_t;
 
+/*
+ * Elements of objects that store their indexed properties in a contiguous
+ * buffer (arrays). Elements [0, cnt) are all present; dispex.c exposes them
+ * through DISPIDs outside of the property table range and asks the object
+ * to switch to regular properties (setting sparse) when a lookup can't be
+ * served densely.
+ *
+ * For-in keeps the insertion order: the elements follow the first
+ * props_before property table entries and, after the switch, are found at
+ * [sparse_pos, sparse_pos+sparse_cnt) of the table.
+ */
+typedef struct {
+    jsval_t *buf;
+    unsigned cnt;
+    unsigned size;
+    BOOL sparse;
+    DWORD props_before;
+    DWORD sparse_pos;
+    unsigned sparse_cnt;
+} dense_elems_t;
+
+#define DENSE_ELEMS_MAX 0x3fffffff
+
 typedef struct {
     jsclass_t class;
     builtin_prop_t value_prop;
@@ -220,6 +243,9 @@ typedef struct {
     unsigned (*idx_length)(jsdisp_t*);
     HRESULT (*idx_get)(jsdisp_t*,unsigned,jsval_t*);
     HRESULT (*idx_put)(jsdisp_t*,unsigned,jsval_t);
+    dense_elems_t *(*dense_elems)(jsdisp_t*);
+    HRESULT (*dense_put)(jsdisp_t*,unsigned,jsval_t);
+    HRESULT (*dense_to_sparse)(jsdisp_t*);
 } builtin_info_t;
 
 struct jsdisp_t {
@@ -291,6 +317,7 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_idx_id(jsdisp_t*,DWORD,DWORD,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -432,6 +459,13 @@ struct _script_ctx_t {
     DWORD last_match_index;
     DWORD last_match_length;
 
+    /* recently compiled regular expressions, reused by RegExp objects with the same source and flags */
+    struct {
+        jsstr_t *src;
+        struct regexp_t *regexp;
+    } regexp_cache[8];
+    unsigned regexp_cache_next;
+
     jsdisp_t *global;
     jsdisp_t *function_constr;
     jsdisp_t *array_constr;
@@ -489,6 +523,7 @@ struct match_state_t;
 HRESULT regexp_match_next(script_ctx_t*,jsdisp_t*,DWORD,jsstr_t*,struct match_state_t**) DECLSPEC_HIDDEN;
 HRESULT parse_regexp_flags(const WCHAR*,DWORD,DWORD*) DECLSPEC_HIDDEN;
 HRESULT regexp_string_match(script_ctx_t*,jsdisp_t*,jsstr_t*,jsval_t*) DECLSPEC_HIDDEN;
+void release_regexp_cache(script_ctx_t*) DECLSPEC_HIDDEN;
 
 BOOL bool_obj_value(jsdisp_t*) DECLSPEC_HIDDEN;
 unsigned array_get_length(jsdisp_t*) DECLSPEC_HIDDEN;
@@ -575,7 +575,7 @@ static void RegExp_destructor(jsdisp_t *dispex)
     RegExpInstance *This = regexp_from_jsdisp(dispex);
 
     if(This->jsregexp)
-        regexp_destroy(This->jsregexp);
+        regexp_release(This->jsregexp);
     jsval_release(This->last_index_val);
     jsstr_release(This->str);
     heap_free(This);
@@ -641,6 +641,53 @@ static HRESULT alloc_regexp(script_ctx_t *ctx, jsdisp_t *object_prototype, RegEx
     return S_OK;
 }
 
+/*
+ * Compiled regexps are shared between RegExp objects with the same source and flags,
+ * so that regexp literals evaluated in a loop are compiled only once. The bytecode
+ * refers to the source string, so the objects share the cached string as well.
+ */
+static regexp_t *compile_regexp(script_ctx_t *ctx, jsstr_t *src, const WCHAR *str, DWORD flags, jsstr_t **ret_src)
+{
+    regexp_t *regexp;
+    unsigned i;
+
+    for(i = 0; i < ARRAY_SIZE(ctx->regexp_cache); i++) {
+        if(ctx->regexp_cache[i].regexp && ctx->regexp_cache[i].regexp->flags == flags
+                && jsstr_eq(ctx->regexp_cache[i].src, src)) {
+            *ret_src = jsstr_addref(ctx->regexp_cache[i].src);
+            return regexp_addref(ctx->regexp_cache[i].regexp);
+        }
+    }
+
+    regexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(src), flags, FALSE);
+    if(!regexp)
+        return NULL;
+
+    i = ctx->regexp_cache_next++ % ARRAY_SIZE(ctx->regexp_cache);
+    if(ctx->regexp_cache[i].regexp) {
+        regexp_release(ctx->regexp_cache[i].regexp);
+        jsstr_release(ctx->regexp_cache[i].src);
+    }
+    ctx->regexp_cache[i].src = jsstr_addref(src);
+    ctx->regexp_cache[i].regexp = regexp_addref(regexp);
+
+    *ret_src = jsstr_addref(src);
+    return regexp;
+}
+
+void release_regexp_cache(script_ctx_t *ctx)
+{
+    unsigned i;
+
+    for(i = 0; i < ARRAY_SIZE(ctx->regexp_cache); i++) {
+        if(!ctx->regexp_cache[i].regexp)
+            continue;
+        regexp_release(ctx->regexp_cache[i].regexp);
+        jsstr_release(ctx->regexp_cache[i].src);
+        ctx->regexp_cache[i].regexp = NULL;
+    }
+}
+
 HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **ret)
 {
     RegExpInstance *regexp;
@@ -657,12 +704,12 @@ HRESULT create_regexp(script_ctx_t *ctx, jsstr_t *src, DWORD flags, jsdisp_t **r
     if(FAILED(hres))
         return hres;
 
-    regexp->str = jsstr_addref(src);
     regexp->last_index_val = jsval_number(0);
 
-    regexp->jsregexp = regexp_new(ctx, &ctx->tmp_heap, str, jsstr_length(regexp->str), flags, FALSE);
+    regexp->jsregexp = compile_regexp(ctx, src, str, flags, &regexp->str);
     if(!regexp->jsregexp) {
         WARN("regexp_new failed\n");
+        regexp->str = jsstr_addref(src);
         jsdisp_release(&regexp->dispex);
         return E_FAIL;
     }
@@ -72,7 +72,7 @@ void heap_pool_init(heap_pool_t *heap)
     list_init(&heap->custom_blocks);
 }
 
-void *heap_pool_alloc(heap_pool_t *heap, DWORD size)
+void *heap_pool_alloc(heap_pool_t *heap, size_t size)
 {
     struct list *list;
     void *tmp;
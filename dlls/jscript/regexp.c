@@ -38,7 +38,7 @@
 
 #include "wine/debug.h"
 
-WINE_DEFAULT_DEBUG_CHANNEL(jscript);
+WINE_DEFAULT_DEBUG_CHANNEL(regexp);
 
 /* FIXME: Better error handling */
 #define ReportRegExpError(a,b,c)
@@ -3070,6 +3070,69 @@ good:
     return x;
 }
 
+/*
+ * Returns the first position at or after cp where the op every match starts
+ * with (see FindStartOp) can succeed, or NULL if there is none. This lets
+ * MatchRegExp skip over input without setting up a full match attempt.
+ */
+static const WCHAR *
+SkipToStart(REGlobalData *gData, const WCHAR *cp)
+{
+    regexp_t *re = gData->regexp;
+    const WCHAR *cpend = gData->cpend;
+    const WCHAR *source;
+    RECharSet *charSet;
+    WCHAR ch;
+
+    switch (re->start_op) {
+      case REOP_BOL:
+        if (cp == gData->cpbegin)
+            return cp;
+        if (!(re->flags & REG_MULTILINE))
+            return NULL;
+        for (; cp <= cpend; cp++) {
+            if (RE_IS_LINE_TERM(cp[-1]))
+                return cp;
+        }
+        return NULL;
+      case REOP_FLAT:
+        source = re->source + re->start_arg;
+        while ((size_t)(cpend - cp) >= re->start_len) {
+            cp = memchrW(cp, *source, cpend - cp - re->start_len + 1);
+            if (!cp)
+                return NULL;
+            if (!memcmp(cp + 1, source + 1, (re->start_len - 1) * sizeof(WCHAR)))
+                return cp;
+            cp++;
+        }
+        return NULL;
+      case REOP_FLAT1:
+      case REOP_UCFLAT1:
+        return memchrW(cp, re->start_arg, cpend - cp);
+      case REOP_FLAT1i:
+      case REOP_UCFLAT1i:
+        ch = toupperW(re->start_arg);
+        for (; cp < cpend; cp++) {
+            if (toupperW(*cp) == ch)
+                return cp;
+        }
+        return NULL;
+      case REOP_CLASS:
+        charSet = &re->classList[re->start_arg];
+        assert(charSet->converted);
+        if (!charSet->length)
+            return NULL;
+        for (; cp < cpend; cp++) {
+            ch = *cp;
+            if (ch <= charSet->length && (charSet->u.bits[ch >> 3] & (1 << (ch & 0x7))))
+                return cp;
+        }
+        return NULL;
+      default:
+        return cp;
+    }
+}
+
 static match_state_t *MatchRegExp(REGlobalData *gData, match_state_t *x)
 {
     match_state_t *result;
@@ -3082,6 +3145,10 @@ static match_state_t *MatchRegExp(REGlobalData *gData, match_state_t *x)
      * in order to detect end-of-input/line condition.
      */
     for (cp2 = cp; cp2 <= gData->cpend; cp2++) {
+        const WCHAR *next = SkipToStart(gData, cp2);
+        if (!next || (next != cp2 && (gData->regexp->flags & REG_STICKY)))
+            return NULL;
+        cp2 = next;
         gData->skipped = cp2 - cp;
         x->cp = cp2;
         for (j = 0; j < gData->regexp->parenCount; j++)
@@ -3178,7 +3245,7 @@ HRESULT regexp_execute(regexp_t *regexp, void *cx, heap_pool_t *pool,
     return S_OK;
 }
 
-void regexp_destroy(regexp_t *re)
+static void regexp_destroy(regexp_t *re)
 {
     if (re->classList) {
         UINT i;
@@ -3192,6 +3259,61 @@ void regexp_destroy(regexp_t *re)
     heap_free(re);
 }
 
+void regexp_release(regexp_t *re)
+{
+    if (!--re->ref)
+        regexp_destroy(re);
+}
+
+/*
+ * Finds a simple op that has to match at the start of every match, looking
+ * through the capturing parens it may be nested in. Anything more complex
+ * (alternatives, quantifiers, assertions) leaves start_op as REOP_EMPTY.
+ */
+static void
+FindStartOp(regexp_t *re)
+{
+    jsbytecode *pc = re->program;
+    size_t index;
+
+    re->start_op = REOP_EMPTY;
+    re->start_arg = 0;
+    re->start_len = 0;
+
+    while (*pc == REOP_LPAREN)
+        pc = ReadCompactIndex(pc + 1, &index);
+
+    switch (*pc) {
+      case REOP_BOL:
+        re->start_op = REOP_BOL;
+        break;
+      case REOP_FLAT:
+        pc = ReadCompactIndex(pc + 1, &re->start_arg);
+        ReadCompactIndex(pc, &re->start_len);
+        re->start_op = REOP_FLAT;
+        break;
+      case REOP_FLATi:
+        ReadCompactIndex(pc + 1, &index);
+        re->start_arg = re->source[index];
+        re->start_op = REOP_FLAT1i;
+        break;
+      case REOP_FLAT1:
+      case REOP_FLAT1i:
+        re->start_arg = pc[1];
+        re->start_op = *pc;
+        break;
+      case REOP_UCFLAT1:
+      case REOP_UCFLAT1i:
+        re->start_arg = GET_ARG(pc + 1);
+        re->start_op = *pc;
+        break;
+      case REOP_CLASS:
+        ReadCompactIndex(pc + 1, &re->start_arg);
+        re->start_op = REOP_CLASS;
+        break;
+    }
+}
+
 regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
         DWORD str_len, WORD flags, BOOL flat)
 {
@@ -3277,12 +3399,32 @@ regexp_t* regexp_new(void *cx, heap_pool_t *pool, const WCHAR *str,
             re = tmp;
     }
 
+    re->ref = 1;
     re->flags = flags;
     re->parenCount = state.parenCount;
     re->source = str;
     re->source_len = str_len;
+    FindStartOp(re);
 
 out:
     heap_pool_clear(mark);
     return re;
 }
+
+HRESULT regexp_set_flags(regexp_t **regexp, void *cx, heap_pool_t *pool, WORD flags)
+{
+    if(((*regexp)->flags & REG_FOLD) != (flags & REG_FOLD)) {
+        regexp_t *new_regexp = regexp_new(cx, pool, (*regexp)->source,
+                (*regexp)->source_len, flags, FALSE);
+
+        if(!new_regexp)
+            return E_FAIL;
+
+        regexp_release(*regexp);
+        *regexp = new_regexp;
+    }else {
+        (*regexp)->flags = flags;
+    }
+
+    return S_OK;
+}
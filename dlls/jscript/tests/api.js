@@ -1157,6 +1157,100 @@ tmp = arr.shift();
 ok(tmp === 1, "[1,].shift() = " + tmp);
 ok(arr.toString() === "", "arr = " + arr.toString());
 
+arr = [1,2,3];
+arr[5] = 6;
+ok(arr.length === 6, "arr.length = " + arr.length);
+ok(!(4 in arr), "4 in arr");
+ok(arr.toString() === "1,2,3,,,6", "arr = " + arr.toString());
+arr.length = 2;
+ok(arr.toString() === "1,2", "arr = " + arr.toString());
+ok(arr[5] === undefined, "arr[5] = " + arr[5]);
+
+arr = [1,2,3,4];
+delete arr[3];
+ok(arr.length === 4, "arr.length = " + arr.length);
+ok(!(3 in arr), "3 in arr");
+delete arr[1];
+ok(!(1 in arr), "1 in arr");
+ok(arr.toString() === "1,,3,", "arr = " + arr.toString());
+
+arr = new Array(3);
+arr[0] = "a";
+arr[1] = "b";
+ok(arr.length === 3, "arr.length = " + arr.length);
+ok(arr.hasOwnProperty("1"), "arr doesn't have own property 1");
+ok(!arr.hasOwnProperty("2"), "arr has own property 2");
+arr[arr.length] = "d";
+ok(arr.length === 4, "arr.length = " + arr.length);
+ok(arr.toString() === "a,b,,d", "arr = " + arr.toString());
+
+arr = [];
+for(i = 0; i < 100; i++)
+    arr[i] = i;
+ok(arr.length === 100, "arr.length = " + arr.length);
+tmp = 0;
+for(i in arr)
+    tmp += arr[i];
+ok(tmp === 4950, "sum = " + tmp);
+tmp = arr.slice(10, 13);
+ok(tmp.toString() === "10,11,12", "arr.slice(10, 13) = " + tmp);
+tmp = arr.shift();
+ok(tmp === 0, "arr.shift() = " + tmp);
+ok(arr[0] === 1 && arr[98] === 99 && arr.length === 99, "unexpected array");
+arr.length = 3;
+arr.prop = "test";
+tmp = 0;
+for(i in arr)
+    tmp++;
+ok(tmp === 4, "enumerated " + tmp + " properties");
+
+function enum_props(o) {
+    var r = [];
+    for(var p in o)
+        r.push(p);
+    return r.join();
+}
+
+arr = [];
+arr.a = 1;
+arr.push(1, 2);
+arr.b = 2;
+arr.push(3);
+tmp = enum_props(arr);
+ok(tmp === "a,0,1,b,2", "enumerated " + tmp);
+
+arr = [1,2];
+Array.prototype.protoProp = 3;
+tmp = enum_props(arr);
+ok(tmp === "0,1,protoProp", "enumerated " + tmp);
+arr.c = 3;
+tmp = enum_props(arr);
+ok(tmp === "0,1,protoProp,c", "enumerated " + tmp);
+delete Array.prototype.protoProp;
+
+arr = [1,2,3];
+tmp = [];
+for(i in arr) {
+    if(i === "0")
+        arr.d = 4;
+    tmp.push(i);
+}
+ok(tmp.join() === "0,1,2,d", "enumerated " + tmp.join());
+
+arr = [1,2];
+try {
+    arr[arr.length] = (function() { throw 1; })();
+}catch(e) {}
+ok(arr.length === 2, "arr.length = " + arr.length);
+ok(!(2 in arr), "2 in arr");
+arr[arr.length] = arr.pop();
+ok(arr.length === 3, "arr.length = " + arr.length);
+ok(arr.toString() === "1,,2", "arr = " + arr.toString());
+arr = [1];
+arr[arr.length]++;
+ok(arr.length === 2, "arr.length = " + arr.length);
+ok(isNaN(arr[1]), "arr[1] = " + arr[1]);
+
 obj = new Object();
 obj[0] = "test";
 obj[2] = 3;
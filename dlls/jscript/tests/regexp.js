@@ -677,4 +677,32 @@ ok(re.ignoreCase === false, "re.ignoreCase = " + re.ignoreCase);
 ok(re.multiline === true, "re.multiline = " + re.multiline);
 ok(re.global === true, "re.global = " + re.global);
 
+m = /(b)(c)/.exec("abcbc");
+ok(m.index === 1, "m.index = " + m.index);
+ok(m[0] === "bc", "m[0] = " + m[0]);
+m = /((xy)z)/.exec("xyxyzxz");
+ok(m.index === 2, "m.index = " + m.index);
+ok(m[1] === "xyz", "m[1] = " + m[1]);
+m = /(B)c/i.exec("abCBc");
+ok(m.index === 1, "m.index = " + m.index);
+ok(m[1] === "b", "m[1] = " + m[1]);
+m = /([xy]z)/.exec("aaxyzz");
+ok(m.index === 3, "m.index = " + m.index);
+ok(m[1] === "yz", "m[1] = " + m[1]);
+ok(/(^b)/.exec("ab") === null, "/(^b)/ matched \"ab\"");
+m = /(^b)/m.exec("a\nb");
+ok(m.index === 2, "m.index = " + m.index);
+ok(/(xyz)/.exec("xyxy") === null, "/(xyz)/ matched \"xyxy\"");
+
+re = /(a)/g;
+tmp = /(a)/g;
+ok(re !== tmp, "regexp literals are the same object");
+re.exec("aa");
+ok(re.lastIndex === 1, "re.lastIndex = " + re.lastIndex);
+ok(tmp.lastIndex === 0, "tmp.lastIndex = " + tmp.lastIndex);
+for(i = 0; i < 3; i++) {
+    tmp = "xaxa".replace(/(a)/g, "b");
+    ok(tmp === "xbxb", "tmp = " + tmp);
+}
+
 reportSuccess();
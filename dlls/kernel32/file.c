@@ -628,6 +628,16 @@ BOOL WINAPI GetOverlappedResult(HANDLE hFile, LPOVERLAPPED lpOverlapped,
             return FALSE;
 
         status = lpOverlapped->Internal;
+        /* requests that ntdll completes without the server don't signal the file and
+         * wake the status instead; the timeout covers other requests that signaled it */
+        while (status == STATUS_PENDING && !lpOverlapped->hEvent)
+        {
+            LARGE_INTEGER timeout;
+
+            timeout.QuadPart = -10 * 10000;
+            RtlWaitOnAddress( &lpOverlapped->Internal, &status, sizeof(status), &timeout );
+            status = lpOverlapped->Internal;
+        }
         if (status == STATUS_PENDING) status = STATUS_SUCCESS;
     }
 
@@ -1690,53 +1690,63 @@ static int fork_and_exec( const RTL_USER_PROCESS_PARAMETERS *params, const char
 
     if (!(pid = fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
-        {
-            close( fd[0] );
+        volatile int exec_err = 0;
+        int new_session = (params->ConsoleFlags || params->ConsoleHandle == KERNEL32_CONSOLE_ALLOC ||
+                           (params->hStdInput == INVALID_HANDLE_VALUE &&
+                            params->hStdOutput == INVALID_HANDLE_VALUE));
+
+        close( fd[0] );
 
-            if (params->ConsoleFlags || params->ConsoleHandle == KERNEL32_CONSOLE_ALLOC ||
-                (params->hStdInput == INVALID_HANDLE_VALUE && params->hStdOutput == INVALID_HANDLE_VALUE))
+        if (new_session)
+        {
+            int nullfd = open( "/dev/null", O_RDWR );
+            /* close stdin and stdout */
+            if (nullfd != -1)
             {
-                int nullfd = open( "/dev/null", O_RDWR );
-                setsid();
-                /* close stdin and stdout */
-                if (nullfd != -1)
-                {
-                    dup2( nullfd, 0 );
-                    dup2( nullfd, 1 );
-                    close( nullfd );
-                }
+                dup2( nullfd, 0 );
+                dup2( nullfd, 1 );
+                close( nullfd );
             }
-            else
+        }
+        else
+        {
+            if (stdin_fd != -1)
             {
-                if (stdin_fd != -1)
-                {
-                    dup2( stdin_fd, 0 );
-                    close( stdin_fd );
-                }
-                if (stdout_fd != -1)
-                {
-                    dup2( stdout_fd, 1 );
-                    close( stdout_fd );
-                }
-                if (stderr_fd != -1)
-                {
-                    dup2( stderr_fd, 2 );
-                    close( stderr_fd );
-                }
+                dup2( stdin_fd, 0 );
+                close( stdin_fd );
             }
+            if (stdout_fd != -1)
+            {
+                dup2( stdout_fd, 1 );
+                close( stdout_fd );
+            }
+            if (stderr_fd != -1)
+            {
+                dup2( stderr_fd, 2 );
+                close( stderr_fd );
+            }
+        }
 
-            /* Reset signals that we previously set to SIG_IGN */
-            signal( SIGPIPE, SIG_DFL );
+        /* Reset signals that we previously set to SIG_IGN */
+        signal( SIGPIPE, SIG_DFL );
 
-            if (newdir) chdir(newdir);
+        if (newdir) chdir(newdir);
 
-            if (argv && envp) execve( filename, argv, envp );
+        /* the child is set up for the exec already, so the grandchild only has to
+         * start its session and exec or exit, and can borrow the child's address space */
+        if (!argv || !envp) exec_err = ENOMEM;
+        else if (!(pid = vfork()))  /* grandchild */
+        {
+            if (new_session) setsid();
+            execve( filename, argv, envp );
+            exec_err = errno;
+            _exit(1);
         }
+        else if (pid == -1) exec_err = errno;
 
-        if (pid <= 0)  /* grandchild if exec failed or child if fork failed */
+        if (exec_err)  /* exec or fork failed */
         {
-            err = errno;
+            err = exec_err;
             write( fd[1], &err, sizeof(err) );
             _exit(1);
         }
@@ -2073,36 +2083,50 @@ static pid_t spawn_loader( const RTL_USER_PROCESS_PARAMETERS *params, int socket
 
     if (!(pid = fork()))  /* child */
     {
-        if (!(pid = fork()))  /* grandchild */
-        {
-            char preloader_reserve[64], socket_env[64];
-            ULONGLONG res_start = pe_info->base;
-            ULONGLONG res_end   = pe_info->base + pe_info->map_size;
+        char preloader_reserve[64], socket_env[64];
+        ULONGLONG res_start = pe_info->base;
+        ULONGLONG res_end   = pe_info->base + pe_info->map_size;
+        int new_session = (params->ConsoleFlags || params->ConsoleHandle == KERNEL32_CONSOLE_ALLOC ||
+                           (params->hStdInput == INVALID_HANDLE_VALUE &&
+                            params->hStdOutput == INVALID_HANDLE_VALUE));
+        char ***cmdlines = NULL;
+        unsigned int i;
 
-            if (params->ConsoleFlags || params->ConsoleHandle == KERNEL32_CONSOLE_ALLOC ||
-                (params->hStdInput == INVALID_HANDLE_VALUE && params->hStdOutput == INVALID_HANDLE_VALUE))
-            {
-                setsid();
-                set_stdio_fd( -1, -1 );  /* close stdin and stdout */
-            }
-            else set_stdio_fd( stdin_fd, stdout_fd );
+        if (new_session) set_stdio_fd( -1, -1 );  /* close stdin and stdout */
+        else set_stdio_fd( stdin_fd, stdout_fd );
 
-            if (stdin_fd != -1) close( stdin_fd );
-            if (stdout_fd != -1) close( stdout_fd );
+        if (stdin_fd != -1) close( stdin_fd );
+        if (stdout_fd != -1) close( stdout_fd );
 
-            /* Reset signals that we previously set to SIG_IGN */
-            signal( SIGPIPE, SIG_DFL );
+        /* Reset signals that we previously set to SIG_IGN */
+        signal( SIGPIPE, SIG_DFL );
 
-            sprintf( socket_env, "WINESERVERSOCKET=%u", socketfd );
-            sprintf( preloader_reserve, "WINEPRELOADRESERVE=%x%08x-%x%08x",
-                     (ULONG)(res_start >> 32), (ULONG)res_start, (ULONG)(res_end >> 32), (ULONG)res_end );
+        sprintf( socket_env, "WINESERVERSOCKET=%u", socketfd );
+        sprintf( preloader_reserve, "WINEPRELOADRESERVE=%x%08x-%x%08x",
+                 (ULONG)(res_start >> 32), (ULONG)res_start, (ULONG)(res_end >> 32), (ULONG)res_end );
 
-            putenv( preloader_reserve );
-            putenv( socket_env );
-            if (winedebug) putenv( winedebug );
-            if (wineloader) putenv( wineloader );
-            if (unixdir) chdir(unixdir);
+        putenv( preloader_reserve );
+        putenv( socket_env );
+        if (winedebug) putenv( winedebug );
+        if (wineloader) putenv( wineloader );
+        if (unixdir) chdir(unixdir);
 
+        /* resolve the loader command lines here, so that the grandchild only has to
+         * start its session and exec or exit, and can borrow the child's address space */
+        if (argv) cmdlines = wine_get_wine_binary_cmdlines( loader, argv, getenv("WINELOADER") );
+
+        if (cmdlines)
+        {
+            if (!(pid = vfork()))  /* grandchild */
+            {
+                if (new_session) setsid();
+                for (i = 0; cmdlines[i]; i++) execv( cmdlines[i][0], cmdlines[i] );
+                _exit(1);
+            }
+        }
+        else if (!(pid = fork()))  /* grandchild */
+        {
+            if (new_session) setsid();
             if (argv) wine_exec_wine_binary( loader, argv, getenv("WINELOADER") );
             _exit(1);
         }
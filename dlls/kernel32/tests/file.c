@@ -63,6 +63,7 @@ static void (WINAPI *pRtlInitAnsiString)(PANSI_STRING,PCSZ);
 static void (WINAPI *pRtlFreeUnicodeString)(PUNICODE_STRING);
 static BOOL (WINAPI *pSetFileCompletionNotificationModes)(HANDLE, UCHAR);
 static HANDLE (WINAPI *pFindFirstStreamW)(LPCWSTR filename, STREAM_INFO_LEVELS infolevel, void *data, DWORD flags);
+static BOOL (WINAPI *pCancelIoEx)(HANDLE, LPOVERLAPPED);
 
 static char filename[MAX_PATH];
 static const char sillytext[] =
@@ -105,6 +106,7 @@ static void InitFunctionPointers(void)
     pGetFileInformationByHandleEx = (void *) GetProcAddress(hkernel32, "GetFileInformationByHandleEx");
     pOpenFileById = (void *) GetProcAddress(hkernel32, "OpenFileById");
     pSetFileValidData = (void *) GetProcAddress(hkernel32, "SetFileValidData");
+    pCancelIoEx = (void *) GetProcAddress(hkernel32, "CancelIoEx");
     pCopyFile2 = (void *) GetProcAddress(hkernel32, "CopyFile2");
     pCreateFile2 = (void *) GetProcAddress(hkernel32, "CreateFile2");
     pGetFinalPathNameByHandleA = (void *) GetProcAddress(hkernel32, "GetFinalPathNameByHandleA");
@@ -5247,6 +5249,204 @@ static void test_overlapped_read(void)
     ok(ret, "Unexpected error %u.\n", GetLastError());
 }
 
+#define TEST_CANCEL_READ_COUNT 8
+
+static void test_overlapped_read_cancel(void)
+{
+    DECLSPEC_ALIGN(TEST_OVERLAPPED_READ_SIZE) static unsigned char buffer[TEST_CANCEL_READ_COUNT][TEST_OVERLAPPED_READ_SIZE];
+    static const char prefix[] = "pfx";
+    OVERLAPPED ov[TEST_CANCEL_READ_COUNT], *pov;
+    char temp_path[MAX_PATH];
+    char file_name[MAX_PATH];
+    DWORD bytes_count, i;
+    ULONG_PTR key;
+    HANDLE hfile, port;
+    DWORD ret;
+
+    if (!pCancelIoEx)
+    {
+        win_skip("CancelIoEx not available\n");
+        return;
+    }
+
+    ret = GetTempPathA(MAX_PATH, temp_path);
+    ok(ret, "Unexpect error %u.\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, file_name);
+    ok(ret, "Unexpected error %u.\n", GetLastError());
+
+    hfile = CreateFileA(file_name, GENERIC_WRITE, 0,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
+    ok(hfile != INVALID_HANDLE_VALUE, "Failed to create file, GetLastError() %u.\n", GetLastError());
+    memset(buffer, 0x55, sizeof(buffer));
+    ret = WriteFile(hfile, buffer, sizeof(buffer), &bytes_count, NULL);
+    ok(ret && bytes_count == sizeof(buffer),
+            "Unexpected WriteFile result, ret %#x, bytes_count %u, GetLastError() %u.\n",
+            ret, bytes_count, GetLastError());
+    CloseHandle(hfile);
+
+    hfile = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, NULL);
+    ok(hfile != INVALID_HANDLE_VALUE, "Failed to create file, GetLastError() %u.\n", GetLastError());
+    port = CreateIoCompletionPort(hfile, NULL, 0xdead, 0);
+    ok(port != NULL, "CreateIoCompletionPort failed, GetLastError() %u.\n", GetLastError());
+
+    /* cancel; each read either completed or was aborted */
+    for (i = 0; i < TEST_CANCEL_READ_COUNT; i++)
+    {
+        memset(&ov[i], 0, sizeof(ov[i]));
+        S(U(ov[i])).Offset = i * TEST_OVERLAPPED_READ_SIZE;
+        ret = ReadFile(hfile, buffer[i], TEST_OVERLAPPED_READ_SIZE, NULL, &ov[i]);
+        ok(ret || GetLastError() == ERROR_IO_PENDING,
+                "Unexpected ReadFile result, ret %#x, GetLastError() %u.\n", ret, GetLastError());
+    }
+
+    ret = pCancelIoEx(hfile, NULL);
+    ok(ret || GetLastError() == ERROR_NOT_FOUND, "CancelIoEx failed, GetLastError() %u.\n", GetLastError());
+
+    for (i = 0; i < TEST_CANCEL_READ_COUNT; i++)
+    {
+        ret = GetOverlappedResult(hfile, &ov[i], &bytes_count, TRUE);
+        if (ret)
+            ok(bytes_count == TEST_OVERLAPPED_READ_SIZE, "%u: Unexpected read size %u.\n", i, bytes_count);
+        else
+            ok(GetLastError() == ERROR_OPERATION_ABORTED, "%u: Unexpected error %u.\n", i, GetLastError());
+    }
+
+    /* every read is reported to the port */
+    for (i = 0; i < TEST_CANCEL_READ_COUNT; i++)
+    {
+        pov = NULL;
+        ret = GetQueuedCompletionStatus(port, &bytes_count, &key, &pov, 1000);
+        ok(pov != NULL, "%u: No completion, GetLastError() %u.\n", i, GetLastError());
+        if (!pov) break;
+        ok(key == 0xdead, "%u: Unexpected key %#lx.\n", i, key);
+        ok(pov->Internal == STATUS_SUCCESS || pov->Internal == STATUS_CANCELLED,
+                "%u: Unexpected status %#lx.\n", i, pov->Internal);
+    }
+
+    ret = pCancelIoEx(hfile, NULL);
+    ok(!ret && GetLastError() == ERROR_NOT_FOUND, "Unexpected CancelIoEx result, ret %#x, GetLastError() %u.\n",
+            ret, GetLastError());
+
+    /* close with reads pending; the completions are still posted */
+    for (i = 0; i < TEST_CANCEL_READ_COUNT; i++)
+    {
+        ov[i].Internal = 0xdeadbeef;
+        ret = ReadFile(hfile, buffer[i], TEST_OVERLAPPED_READ_SIZE, NULL, &ov[i]);
+        ok(ret || GetLastError() == ERROR_IO_PENDING,
+                "Unexpected ReadFile result, ret %#x, GetLastError() %u.\n", ret, GetLastError());
+    }
+
+    CloseHandle(hfile);
+
+    for (i = 0; i < TEST_CANCEL_READ_COUNT; i++)
+    {
+        pov = NULL;
+        ret = GetQueuedCompletionStatus(port, &bytes_count, &key, &pov, 1000);
+        ok(pov != NULL, "%u: No completion, GetLastError() %u.\n", i, GetLastError());
+        if (!pov) break;
+        ok(pov->Internal == STATUS_SUCCESS || pov->Internal == STATUS_CANCELLED,
+                "%u: Unexpected status %#lx.\n", i, pov->Internal);
+        if (pov->Internal == STATUS_SUCCESS)
+            ok(pov->InternalHigh == TEST_OVERLAPPED_READ_SIZE, "%u: Unexpected read size %lu.\n",
+                    i, pov->InternalHigh);
+    }
+
+    CloseHandle(port);
+    ret = DeleteFileA(file_name);
+    ok(ret, "Unexpected error %u.\n", GetLastError());
+}
+
+#define TEST_QUEUE_DEPTH_MAX 64
+
+static DWORD read_block(HANDLE hfile, OVERLAPPED *ov, void *buffer, DWORD index, DWORD blocks)
+{
+    BOOL ret;
+
+    memset(ov, 0, sizeof(*ov));
+    S(U(*ov)).Offset = (index * 7 % blocks) * TEST_OVERLAPPED_READ_SIZE;
+    ret = ReadFile(hfile, buffer, TEST_OVERLAPPED_READ_SIZE, NULL, ov);
+    ok(ret || GetLastError() == ERROR_IO_PENDING,
+            "Unexpected ReadFile result, ret %#x, GetLastError() %u.\n", ret, GetLastError());
+    return ret || GetLastError() == ERROR_IO_PENDING;
+}
+
+static void test_overlapped_read_queue_depth(void)
+{
+    static const DWORD depths[] = {1, 4, 16, TEST_QUEUE_DEPTH_MAX};
+    static const char prefix[] = "pfx";
+    static const DWORD blocks = 256;
+    OVERLAPPED ov[TEST_QUEUE_DEPTH_MAX], *pov;
+    LARGE_INTEGER freq, start, end;
+    char temp_path[MAX_PATH];
+    char file_name[MAX_PATH];
+    DWORD bytes_count, count, issued, done, i, d;
+    unsigned char *buffer;
+    ULONG_PTR key;
+    HANDLE hfile, port;
+    DWORD ret;
+
+    count = winetest_interactive ? 100000 : 1000;
+
+    ret = GetTempPathA(MAX_PATH, temp_path);
+    ok(ret, "Unexpect error %u.\n", GetLastError());
+    ret = GetTempFileNameA(temp_path, prefix, 0, file_name);
+    ok(ret, "Unexpected error %u.\n", GetLastError());
+
+    buffer = VirtualAlloc(NULL, blocks * TEST_OVERLAPPED_READ_SIZE, MEM_COMMIT, PAGE_READWRITE);
+    hfile = CreateFileA(file_name, GENERIC_WRITE, 0,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_NO_BUFFERING, NULL);
+    ok(hfile != INVALID_HANDLE_VALUE, "Failed to create file, GetLastError() %u.\n", GetLastError());
+    ret = WriteFile(hfile, buffer, blocks * TEST_OVERLAPPED_READ_SIZE, &bytes_count, NULL);
+    ok(ret && bytes_count == blocks * TEST_OVERLAPPED_READ_SIZE,
+            "Unexpected WriteFile result, ret %#x, bytes_count %u, GetLastError() %u.\n",
+            ret, bytes_count, GetLastError());
+    CloseHandle(hfile);
+
+    hfile = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED | FILE_FLAG_NO_BUFFERING, NULL);
+    ok(hfile != INVALID_HANDLE_VALUE, "Failed to create file, GetLastError() %u.\n", GetLastError());
+    port = CreateIoCompletionPort(hfile, NULL, 0, 0);
+    ok(port != NULL, "CreateIoCompletionPort failed, GetLastError() %u.\n", GetLastError());
+
+    QueryPerformanceFrequency(&freq);
+    for (d = 0; d < ARRAY_SIZE(depths); d++)
+    {
+        issued = done = 0;
+        QueryPerformanceCounter(&start);
+        /* keep depths[d] reads in flight, reusing the overlapped of each completed one */
+        for (i = 0; i < depths[d] && issued < count; i++)
+            issued += read_block(hfile, &ov[i], buffer + i * TEST_OVERLAPPED_READ_SIZE, issued, blocks);
+        while (done < issued)
+        {
+            ret = GetQueuedCompletionStatus(port, &bytes_count, &key, &pov, 5000);
+            if (!ret || bytes_count != TEST_OVERLAPPED_READ_SIZE) break;
+            done++;
+            if (issued < count)
+            {
+                i = pov - ov;
+                issued += read_block(hfile, pov, buffer + i * TEST_OVERLAPPED_READ_SIZE, issued, blocks);
+            }
+        }
+        QueryPerformanceCounter(&end);
+        ok(done == count, "depth %u: %u of %u reads done, GetLastError() %u.\n",
+                depths[d], done, count, GetLastError());
+        while (done < issued &&
+                (GetQueuedCompletionStatus(port, &bytes_count, &key, &pov, 5000) || pov))
+            done++;
+
+        trace("depth %u: %u reads in %.1f ms, %.0f IOPS\n", depths[d], count,
+                (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart,
+                count * (double)freq.QuadPart / max(end.QuadPart - start.QuadPart, 1));
+    }
+
+    CloseHandle(hfile);
+    CloseHandle(port);
+    VirtualFree(buffer, 0, MEM_RELEASE);
+    ret = DeleteFileA(file_name);
+    ok(ret, "Unexpected error %u.\n", GetLastError());
+}
+
 static void test_file_readonly_access(void)
 {
     static const DWORD default_sharing = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
@@ -5406,6 +5606,8 @@ START_TEST(file)
     test_GetFileAttributesExW();
     test_post_completion();
     test_overlapped_read();
+    test_overlapped_read_cancel();
+    test_overlapped_read_queue_depth();
     test_file_readonly_access();
     test_find_file_stream();
 }
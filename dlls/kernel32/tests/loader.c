@@ -2170,6 +2170,100 @@ static void test_import_resolution(void)
     }
 }
 
+static void test_relocated_image(void)
+{
+    static const char * const strings[] = { "first image", "other image" };
+    char temp_path[MAX_PATH];
+    char dll_name[MAX_PATH];
+    DWORD dummy;
+    HANDLE hfile;
+    HMODULE mod;
+    void *reserved;
+    struct relocs
+    {
+        ULONG_PTR ptr;
+        char str[16];
+        IMAGE_BASE_RELOCATION rel;
+        WORD entries[2];
+    } data, *ptr;
+    IMAGE_NT_HEADERS nt;
+    IMAGE_SECTION_HEADER section;
+    int test;
+
+    GetTempPathA(MAX_PATH, temp_path);
+    GetTempFileNameA(temp_path, "ldr", 0, dll_name);
+
+    for (test = 0; test < ARRAY_SIZE(strings); test++)
+    {
+#define DATA_RVA(ptr) (page_size + ((char *)(ptr) - (char *)&data))
+        nt = nt_header_template;
+        nt.FileHeader.NumberOfSections = 1;
+        nt.FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER);
+        nt.FileHeader.Characteristics = IMAGE_FILE_EXECUTABLE_IMAGE | IMAGE_FILE_32BIT_MACHINE | IMAGE_FILE_DLL;
+        nt.OptionalHeader.SectionAlignment = page_size;
+        nt.OptionalHeader.FileAlignment = 0x200;
+        nt.OptionalHeader.ImageBase = 0x12340000;
+        nt.OptionalHeader.SizeOfImage = 2 * page_size;
+        nt.OptionalHeader.SizeOfHeaders = nt.OptionalHeader.FileAlignment;
+        nt.OptionalHeader.NumberOfRvaAndSizes = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+        memset( nt.OptionalHeader.DataDirectory, 0, sizeof(nt.OptionalHeader.DataDirectory) );
+        nt.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size = sizeof(data.rel) + sizeof(data.entries);
+        nt.OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress = DATA_RVA(&data.rel);
+
+        memset( &data, 0, sizeof(data) );
+        data.ptr = nt.OptionalHeader.ImageBase + DATA_RVA( data.str );
+        strcpy( data.str, strings[test] );
+        data.rel.VirtualAddress = page_size;
+        data.rel.SizeOfBlock = sizeof(data.rel) + sizeof(data.entries);
+#ifdef _WIN64
+        data.entries[0] = (IMAGE_REL_BASED_DIR64 << 12) | offsetof( struct relocs, ptr );
+#else
+        data.entries[0] = (IMAGE_REL_BASED_HIGHLOW << 12) | offsetof( struct relocs, ptr );
+#endif
+
+        /* the file is rewritten in place, the second load must not see the first contents */
+        hfile = CreateFileA(dll_name, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, 0, 0);
+        ok( hfile != INVALID_HANDLE_VALUE, "creation failed\n" );
+
+        memset( &section, 0, sizeof(section) );
+        memcpy( section.Name, ".data", sizeof(".data") );
+        section.PointerToRawData = nt.OptionalHeader.FileAlignment;
+        section.VirtualAddress = nt.OptionalHeader.SectionAlignment;
+        section.Misc.VirtualSize = sizeof(data);
+        section.SizeOfRawData = sizeof(data);
+        section.Characteristics = IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE;
+
+        WriteFile(hfile, &dos_header, sizeof(dos_header), &dummy, NULL);
+        WriteFile(hfile, &nt, sizeof(nt), &dummy, NULL);
+        WriteFile(hfile, &section, sizeof(section), &dummy, NULL);
+
+        SetFilePointer( hfile, section.PointerToRawData, NULL, SEEK_SET );
+        WriteFile(hfile, &data, sizeof(data), &dummy, NULL);
+
+        CloseHandle( hfile );
+
+        /* occupy the preferred base to force a relocation */
+        reserved = VirtualAlloc( (void *)nt.OptionalHeader.ImageBase, nt.OptionalHeader.SizeOfImage,
+                                 MEM_RESERVE, PAGE_NOACCESS );
+        ok( reserved != NULL, "failed to reserve %p err %u\n",
+            (void *)nt.OptionalHeader.ImageBase, GetLastError() );
+
+        mod = LoadLibraryA( dll_name );
+        ok( mod != NULL, "failed to load err %u\n", GetLastError() );
+        if (mod)
+        {
+            ok( (ULONG_PTR)mod != nt.OptionalHeader.ImageBase, "image not relocated\n" );
+            ptr = (struct relocs *)((char *)mod + page_size);
+            ok( ptr->ptr == (ULONG_PTR)ptr->str, "pointer %p instead of %p\n", (void *)ptr->ptr, ptr->str );
+            ok( !strcmp( ptr->str, strings[test] ), "%u: wrong data %s\n", test, ptr->str );
+            FreeLibrary( mod );
+        }
+        if (reserved) VirtualFree( reserved, 0, MEM_RELEASE );
+#undef DATA_RVA
+    }
+    DeleteFileA( dll_name );
+}
+
 #define MAX_COUNT 10
 static HANDLE attached_thread[MAX_COUNT];
 static DWORD attached_thread_count;
@@ -3923,6 +4017,7 @@ START_TEST(loader)
     test_ImportDescriptors();
     test_section_access();
     test_import_resolution();
+    test_relocated_image();
     test_ExitProcess();
     test_InMemoryOrderModuleList();
     test_dll_file( "ntdll.dll" );
@@ -3785,6 +3785,42 @@ static void test_ProcThreadAttributeList(void)
     pDeleteProcThreadAttributeList(&list);
 }
 
+static void test_spawn_latency(void)
+{
+    char buffer[MAX_PATH];
+    STARTUPINFOA si;
+    PROCESS_INFORMATION info;
+    LARGE_INTEGER freq, start, created, end;
+    LONGLONG create_time = 0, total_time = 0;
+    DWORD ret, count, i;
+
+    count = winetest_interactive ? 200 : 10;
+    memset(&si, 0, sizeof(si));
+    si.cb = sizeof(si);
+    sprintf(buffer, "\"%s\" tests/process.c quit", selfname);
+
+    QueryPerformanceFrequency(&freq);
+    for (i = 0; i < count; i++)
+    {
+        QueryPerformanceCounter(&start);
+        ret = CreateProcessA(NULL, buffer, NULL, NULL, FALSE, 0, NULL, NULL, &si, &info);
+        QueryPerformanceCounter(&created);
+        ok(ret, "CreateProcess failed: %u\n", GetLastError());
+        if (!ret) break;
+        ret = WaitForSingleObject(info.hProcess, 30000);
+        QueryPerformanceCounter(&end);
+        ok(ret == WAIT_OBJECT_0, "child didn't exit: %u\n", ret);
+        CloseHandle(info.hProcess);
+        CloseHandle(info.hThread);
+        create_time += created.QuadPart - start.QuadPart;
+        total_time += end.QuadPart - start.QuadPart;
+    }
+    if (!i) return;
+
+    trace("%u processes: CreateProcess %.2f ms, until exit %.2f ms on average\n", i,
+          create_time * 1000.0 / freq.QuadPart / i, total_time * 1000.0 / freq.QuadPart / i);
+}
+
 START_TEST(process)
 {
     HANDLE job;
@@ -3811,6 +3847,8 @@ START_TEST(process)
             Sleep(100);
             return;
         }
+        else if (!strcmp(myARGV[2], "quit"))
+            return;
         else if (!strcmp(myARGV[2], "nested") && myARGC >= 4)
         {
             char                buffer[MAX_PATH];
@@ -3873,6 +3911,7 @@ START_TEST(process)
     test_ProcThreadAttributeList();
     test_SuspendProcessState();
     test_SuspendProcessNewThread();
+    test_spawn_latency();
 
     /* things that can be tested:
      *  lookup:         check the way program to be executed is searched
@@ -84,7 +84,7 @@ static void test_VirtualAllocEx(void)
     BOOL b;
     DWORD old_prot;
     MEMORY_BASIC_INFORMATION info;
-    HANDLE hProcess;
+    HANDLE hProcess, hRead;
 
     /* not exported in all windows-versions  */
     if ((!pVirtualAllocEx) || (!pVirtualFreeEx)) {
@@ -221,7 +221,34 @@ static void test_VirtualAllocEx(void)
 
     ok(pVirtualFreeEx(hProcess, addr1, 0, MEM_RELEASE), "VirtualFreeEx failed\n");
 
+    /* access rights are checked for each direction */
+    addr1 = pVirtualAllocEx(hProcess, NULL, 0x1000, MEM_COMMIT, PAGE_READWRITE);
+    ok(addr1 != NULL, "VirtualAllocEx error %u\n", GetLastError());
+    b = DuplicateHandle( GetCurrentProcess(), hProcess, GetCurrentProcess(), &hRead,
+                         PROCESS_VM_READ, FALSE, 0 );
+    ok( b, "DuplicateHandle error %u\n", GetLastError() );
+    i = 0x12345678;
+    b = WriteProcessMemory(hProcess, addr1, &i, sizeof(i), &bytes_written);
+    ok( b && bytes_written == sizeof(i), "WriteProcessMemory error %u\n", GetLastError() );
+    i = 0;
+    b = ReadProcessMemory(hRead, addr1, &i, sizeof(i), &bytes_read);
+    ok( b && bytes_read == sizeof(i), "ReadProcessMemory error %u\n", GetLastError() );
+    ok( i == 0x12345678, "wrong value %lx\n", i );
+    SetLastError(0xdeadbeef);
+    b = WriteProcessMemory(hRead, addr1, &i, sizeof(i), &bytes_written);
+    ok( !b, "WriteProcessMemory succeeded\n" );
+    ok( GetLastError() == ERROR_ACCESS_DENIED, "wrong error %u\n", GetLastError() );
+
     TerminateProcess(hProcess, 0);
+    ok( !WaitForSingleObject( hProcess, 1000 ), "process didn't exit\n" );
+
+    /* the memory of a dead process is gone, even if its pid gets reused */
+    b = ReadProcessMemory(hRead, addr1, &i, sizeof(i), &bytes_read);
+    ok( !b, "ReadProcessMemory succeeded\n" );
+    b = WriteProcessMemory(hProcess, addr1, &i, sizeof(i), &bytes_written);
+    ok( !b, "WriteProcessMemory succeeded\n" );
+
+    CloseHandle(hRead);
     CloseHandle(hProcess);
 }
 
@@ -2304,6 +2331,89 @@ static void test_write_watch(void)
     VirtualFree( base, 0, MEM_RELEASE );
 }
 
+/* more written ranges than a single kernel page scan returns when the kernel tracks the writes */
+static void test_write_watch_scattered(void)
+{
+    static void *results[256];
+    ULONG_PTR count;
+    ULONG i, pagesize;
+    SYSTEM_INFO si;
+    DWORD ret, old_prot;
+    char *base;
+
+    if (!pGetWriteWatch || !pResetWriteWatch)
+    {
+        win_skip( "GetWriteWatch not supported\n" );
+        return;
+    }
+
+    GetSystemInfo( &si );
+    base = VirtualAlloc( 0, 256 * si.dwPageSize, MEM_RESERVE | MEM_COMMIT | MEM_WRITE_WATCH, PAGE_READWRITE );
+    if (!base)
+    {
+        win_skip( "MEM_WRITE_WATCH not supported\n" );
+        return;
+    }
+
+    for (i = 0; i < 256; i += 2) base[i * si.dwPageSize] = 1;
+
+    count = 256;
+    ret = pGetWriteWatch( 0, base, 256 * si.dwPageSize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( pagesize == si.dwPageSize, "wrong pagesize %u\n", pagesize );
+    ok( count == 128, "wrong count %lu\n", count );
+    for (i = 0; i < count; i++)
+        ok( results[i] == base + 2 * i * pagesize, "%u: wrong result %p\n", i, results[i] );
+
+    count = 10;
+    ret = pGetWriteWatch( 0, base, 256 * pagesize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( count == 10, "wrong count %lu\n", count );
+    for (i = 0; i < count; i++)
+        ok( results[i] == base + 2 * i * pagesize, "%u: wrong result %p\n", i, results[i] );
+
+    ret = pResetWriteWatch( base + 64 * pagesize, 64 * pagesize );
+    ok( !ret, "ResetWriteWatch failed %u\n", GetLastError() );
+
+    count = 256;
+    ret = pGetWriteWatch( 0, base, 256 * pagesize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( count == 96, "wrong count %lu\n", count );
+    ok( results[31] == base + 62 * pagesize, "wrong result %p\n", results[31] );
+    ok( results[32] == base + 128 * pagesize, "wrong result %p\n", results[32] );
+
+    count = 256;
+    ret = pGetWriteWatch( WRITE_WATCH_FLAG_RESET, base, 256 * pagesize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( count == 96, "wrong count %lu\n", count );
+
+    count = 256;
+    ret = pGetWriteWatch( 0, base, 256 * pagesize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( count == 0, "wrong count %lu\n", count );
+
+    /* pages written before are tracked again after a reset */
+    base[pagesize + 1] = 2;
+    base[200 * pagesize] = 2;
+
+    ret = VirtualProtect( base + 2 * pagesize, pagesize, PAGE_READONLY, &old_prot );
+    ok( ret, "VirtualProtect failed error %u\n", GetLastError() );
+    ret = VirtualProtect( base + 2 * pagesize, pagesize, PAGE_READWRITE, &old_prot );
+    ok( ret, "VirtualProtect failed error %u\n", GetLastError() );
+    ok( old_prot == PAGE_READONLY, "wrong old prot %x\n", old_prot );
+    base[2 * pagesize + 1] = 2;
+
+    count = 256;
+    ret = pGetWriteWatch( 0, base, 256 * pagesize, results, &count, &pagesize );
+    ok( !ret, "GetWriteWatch failed %u\n", GetLastError() );
+    ok( count == 3, "wrong count %lu\n", count );
+    ok( results[0] == base + pagesize, "wrong result %p\n", results[0] );
+    ok( results[1] == base + 2 * pagesize, "wrong result %p\n", results[1] );
+    ok( results[2] == base + 200 * pagesize, "wrong result %p\n", results[2] );
+
+    VirtualFree( base, 0, MEM_RELEASE );
+}
+
 #if defined(__i386__) || defined(__x86_64__)
 
 static DWORD WINAPI stack_commit_func( void *arg )
@@ -4460,6 +4570,7 @@ START_TEST(virtual)
     test_IsBadWritePtr();
     test_IsBadCodePtr();
     test_write_watch();
+    test_write_watch_scattered();
 #if defined(__i386__) || defined(__x86_64__)
     test_stack_commit();
 #endif
@@ -82,6 +82,7 @@ static char utf16_bom[2] = { 0xff, 0xfe };
 #define MSVCRT_FD_BLOCK_SIZE 32
 
 #define MSVCRT_INTERNAL_BUFSIZ 4096
+#define MSVCRT_MAX_INTERNAL_BUFSIZ 0x10000
 
 /* ioinfo structure size is different in msvcrXX.dll's */
 typedef struct {
@@ -703,6 +704,28 @@ static BOOL msvcrt_alloc_buffer(MSVCRT_FILE* file)
     return TRUE;
 }
 
+/* INTERNAL: Grow the buffer of a stream that is read sequentially
+ *
+ * The buffer is only grown once it has been consumed entirely after a
+ * fill that returned a good part of it, so streams that seek around keep
+ * the default size. Buffers sized by setvbuf are left alone.
+ */
+static void msvcrt_grow_buffer(MSVCRT_FILE* file)
+{
+    char *base;
+
+    if((file->_flag & (MSVCRT__IOMYBUF | MSVCRT__IOSETVBUF)) != MSVCRT__IOMYBUF || file->_cnt
+            || file->_bufsiz < MSVCRT_INTERNAL_BUFSIZ
+            || file->_bufsiz >= MSVCRT_MAX_INTERNAL_BUFSIZ
+            || file->_ptr - file->_base < file->_bufsiz / 2)
+        return;
+
+    if(!(base = MSVCRT_realloc(file->_base, file->_bufsiz * 2)))
+        return;
+    file->_base = file->_ptr = base;
+    file->_bufsiz *= 2;
+}
+
 /* INTERNAL: Allocate temporary buffer for stdout and stderr */
 static BOOL add_std_buffer(MSVCRT_FILE *file)
 {
@@ -2740,6 +2763,27 @@ static int read_utf8(ioinfo *fdinfo, MSVCRT_wchar_t *buf, unsigned int count)
     return num_read*2;
 }
 
+/* INTERNAL: Return the length of the leading run of characters in buf
+ * that are neither '\r' nor ctrl-z, checking a word at a time */
+static unsigned int text_run_len(const char *buf, unsigned int count)
+{
+    static const ULONG_PTR ones = ~(ULONG_PTR)0 / 0xff;
+    static const ULONG_PTR highs = ~(ULONG_PTR)0 / 0xff * 0x80;
+    const char *p = buf, *end = buf + count;
+    ULONG_PTR w, cr, eof;
+
+    while (end - p >= sizeof(w))
+    {
+        memcpy(&w, p, sizeof(w));
+        cr = w ^ (ones * '\r');
+        eof = w ^ (ones * 0x1a);
+        if ((((cr - ones) & ~cr) | ((eof - ones) & ~eof)) & highs) break;
+        p += sizeof(w);
+    }
+    while (p < end && *p != '\r' && *p != 0x1a) p++;
+    return p - buf;
+}
+
 /*********************************************************************
  * (internal) read_i
  *
@@ -2821,6 +2865,17 @@ static int read_i(int fd, ioinfo *fdinfo, void *buf, unsigned int count)
 
             for (i=0, j=0; i<num_read; i+=1+utf16)
             {
+                /* move runs of characters that need no translation at once */
+                if (!utf16)
+                {
+                    DWORD len = text_run_len(bufstart + i, num_read - i);
+
+                    if (len && i != j) memmove(bufstart + j, bufstart + i, len);
+                    i += len;
+                    j += len;
+                    if (i == num_read) break;
+                }
+
                 /* in text mode, a ctrl-z signals EOF */
                 if (bufstart[i]==0x1a && (!utf16 || bufstart[i+1]==0))
                 {
@@ -3488,21 +3543,24 @@ int CDECL MSVCRT__write(int fd, const void* buf, unsigned int count)
 
         if (!(info->exflag & (EF_UTF8|EF_UTF16)))
         {
+            const char *lf, *end = s + count;
+
             /* find number of \n */
-            for (nr_lf=0, i=0; i<count; i++)
-                if (s[i] == '\n')
-                    nr_lf++;
+            for (nr_lf=0, lf=s; (lf = memchr(lf, '\n', end-lf)); lf++)
+                nr_lf++;
             if (nr_lf)
             {
                 size = count+nr_lf;
                 if ((q = p = MSVCRT_malloc(size)))
                 {
-                    for (s = buf, i = 0, j = 0; i < count; i++)
+                    for (j = 0; (lf = memchr(s, '\n', end-s)); s = lf+1)
                     {
-                        if (s[i] == '\n')
-                            p[j++] = '\r';
-                        p[j++] = s[i];
+                        memcpy(p+j, s, lf-s);
+                        j += lf-s;
+                        p[j++] = '\r';
+                        p[j++] = '\n';
                     }
+                    memcpy(p+j, s, end-s);
                 }
                 else
                 {
@@ -3720,6 +3778,7 @@ int CDECL MSVCRT__filbuf(MSVCRT_FILE* file)
 
         return c;
     } else {
+        msvcrt_grow_buffer(file);
         file->_cnt = MSVCRT__read(file->_file, file->_base, file->_bufsiz);
         if(file->_cnt<=0) {
             file->_flag |= (file->_cnt == 0) ? MSVCRT__IOEOF : MSVCRT__IOERR;
@@ -4333,6 +4392,7 @@ MSVCRT_size_t CDECL MSVCRT__fread_nolock(void *ptr, MSVCRT_size_t size, MSVCRT_s
   {
     int i;
     if (!file->_cnt && rcnt<file->_bufsiz && (file->_flag & (MSVCRT__IOMYBUF | MSVCRT__USERBUF))) {
+      msvcrt_grow_buffer(file);
       i = MSVCRT__read(file->_file, file->_base, file->_bufsiz);
       file->_ptr = file->_base;
       if (i != -1) {
@@ -4919,7 +4979,7 @@ int CDECL MSVCRT_setvbuf(MSVCRT_FILE* file, char *buf, int mode, MSVCRT_size_t s
     MSVCRT__fflush_nolock(file);
     if(file->_flag & MSVCRT__IOMYBUF)
         MSVCRT_free(file->_base);
-    file->_flag &= ~(MSVCRT__IONBF | MSVCRT__IOMYBUF | MSVCRT__USERBUF);
+    file->_flag &= ~(MSVCRT__IONBF | MSVCRT__IOMYBUF | MSVCRT__USERBUF | MSVCRT__IOSETVBUF);
     file->_cnt = 0;
 
     if(mode == MSVCRT__IONBF) {
@@ -4938,7 +4998,7 @@ int CDECL MSVCRT_setvbuf(MSVCRT_FILE* file, char *buf, int mode, MSVCRT_size_t s
             return -1;
         }
 
-        file->_flag |= MSVCRT__IOMYBUF;
+        file->_flag |= MSVCRT__IOMYBUF | MSVCRT__IOSETVBUF;
         file->_bufsiz = size;
     }
     MSVCRT__unlock_file(file);
@@ -873,6 +873,7 @@ struct MSVCRT__stat64 {
 #define MSVCRT__IOSTRG   0x0040
 #define MSVCRT__IORW     0x0080
 #define MSVCRT__USERBUF  0x0100
+#define MSVCRT__IOSETVBUF 0x0400
 #define MSVCRT__IOCOMMIT 0x4000
 
 #define MSVCRT__S_IEXEC  0x0040
@@ -1199,6 +1200,24 @@ int create_positional_ctx_w(void*, const MSVCRT_wchar_t*, __ms_va_list) DECLSPEC
 printf_arg arg_clbk_valist(void*, int, int, __ms_va_list*) DECLSPEC_HIDDEN;
 printf_arg arg_clbk_positional(void*, int, int, __ms_va_list*) DECLSPEC_HIDDEN;
 
+/* enough significant digits to round any double correctly */
+#define FPNUM_DIGITS 768
+
+/* floating point number being parsed */
+struct fpnum
+{
+    int  base;                      /* 10 or 16 */
+    int  ndigits;                   /* number of significant digits */
+    int  exp;                       /* exponent of the digits, in base units */
+    int  e;                         /* explicit exponent, decimal or binary */
+    BOOL inexact;                   /* nonzero digits were dropped */
+    char digits[FPNUM_DIGITS];
+};
+
+void fpnum_init(struct fpnum*, int) DECLSPEC_HIDDEN;
+void fpnum_add_digit(struct fpnum*, int, BOOL) DECLSPEC_HIDDEN;
+double fpnum_double(const struct fpnum*, int*) DECLSPEC_HIDDEN;
+
 #define MSVCRT_FLT_MIN 1.175494351e-38F
 #define MSVCRT_DBL_MIN 2.2250738585072014e-308
 #define MSVCRT__OVERFLOW  3
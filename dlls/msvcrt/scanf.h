@@ -318,11 +318,9 @@ _FUNCTION_ {
             case 'f':
             case 'g':
             case 'G': { /* read a float */
-                    long double cur = 1, expcnt = 10;
-                    ULONGLONG d, hlp;
-                    int exp = 0, negative = 0;
-                    unsigned fpcontrol;
-                    BOOL negexp;
+                    struct fpnum num;
+                    double cur;
+                    int negative = 0, range;
 
                     /* skip initial whitespace */
                     while ((nch!=_EOF_) && _ISSPACE_(nch))
@@ -336,31 +334,20 @@ _FUNCTION_ {
                         nch = _GETC_(file);
                     }
 
+                    fpnum_init(&num, 10);
+
                     /* get first digit. */
                     if (*locinfo->lconv->decimal_point != nch) {
                         if (!_ISDIGIT_(nch)) break;
-                        d = nch - '0';
+                        fpnum_add_digit(&num, nch - '0', FALSE);
                         nch = _GETC_(file);
                         if (width>0) width--;
                         /* read until no more digits */
                         while (width!=0 && (nch!=_EOF_) && _ISDIGIT_(nch)) {
-                            hlp = d*10 + nch - '0';
-                            nch = _GETC_(file);
-                            if (width>0) width--;
-                            if(d > (ULONGLONG)-1/10 || hlp<d) {
-                                exp++;
-                                break;
-                            }
-                            else
-                                d = hlp;
-                        }
-                        while (width!=0 && (nch!=_EOF_) && _ISDIGIT_(nch)) {
-                            exp++;
+                            fpnum_add_digit(&num, nch - '0', FALSE);
                             nch = _GETC_(file);
                             if (width>0) width--;
                         }
-                    } else {
-                        d = 0; /* Fix: .8 -> 0.8 */
                     }
 
                     /* handle decimals */
@@ -369,16 +356,7 @@ _FUNCTION_ {
                         if (width>0) width--;
 
                         while (width!=0 && (nch!=_EOF_) && _ISDIGIT_(nch)) {
-                            hlp = d*10 + nch - '0';
-                            nch = _GETC_(file);
-                            if (width>0) width--;
-                            if(d > (ULONGLONG)-1/10 || hlp<d)
-                                break;
-
-                            d = hlp;
-                            exp--;
-                        }
-                        while (width!=0 && (nch!=_EOF_) && _ISDIGIT_(nch)) {
+                            fpnum_add_digit(&num, nch - '0', TRUE);
                             nch = _GETC_(file);
                             if (width>0) width--;
                         }
@@ -404,30 +382,10 @@ _FUNCTION_ {
                             nch = _GETC_(file);
                             if (width>0) width--;
                         }
-                        e *= sign;
-
-                        if(exp<0 && e<0 && e+exp>0) exp = INT_MIN;
-                        else if(exp>0 && e>0 && e+exp<0) exp = INT_MAX;
-                        else exp += e;
-                    }
-
-                    fpcontrol = _control87(0, 0);
-                    _control87(MSVCRT__EM_DENORMAL|MSVCRT__EM_INVALID|MSVCRT__EM_ZERODIVIDE
-                            |MSVCRT__EM_OVERFLOW|MSVCRT__EM_UNDERFLOW|MSVCRT__EM_INEXACT, 0xffffffff);
-
-                    negexp = (exp < 0);
-                    if(negexp)
-                        exp = -exp;
-                    /* update 'cur' with this exponent. */
-                    while(exp) {
-                        if(exp & 1)
-                            cur *= expcnt;
-                        exp /= 2;
-                        expcnt = expcnt*expcnt;
+                        num.e = e * sign;
                     }
-                    cur = (negexp ? d/cur : d*cur);
 
-                    _control87(fpcontrol, 0xffffffff);
+                    cur = fpnum_double(&num, &range);
 
                     st = 1;
                     if (!suppress) {
@@ -325,16 +325,83 @@ void CDECL MSVCRT__swab(char* src, char* dst, int len)
   }
 }
 
+void fpnum_init(struct fpnum *num, int base)
+{
+    num->base = base;
+    num->ndigits = 0;
+    num->exp = 0;
+    num->e = 0;
+    num->inexact = FALSE;
+}
+
+/* add a digit of the integer part or of the fraction */
+void fpnum_add_digit(struct fpnum *num, int val, BOOL fraction)
+{
+    if (!val && !num->ndigits)
+    {
+        /* leading zeros only shift the fraction */
+        if (fraction) num->exp--;
+        return;
+    }
+    if (num->ndigits < FPNUM_DIGITS)
+    {
+        num->digits[num->ndigits++] = "0123456789abcdef"[val];
+        if (fraction) num->exp--;
+        return;
+    }
+    /* the remaining digits can only break ties */
+    if (!fraction) num->exp++;
+    if (val) num->inexact = TRUE;
+}
+
+/* convert the number to the nearest double; the host strtod rounds correctly */
+double fpnum_double(const struct fpnum *num, int *err)
+{
+    char buf[FPNUM_DIGITS + 32], *p = buf;
+    LONGLONG exp = num->exp;
+    unsigned fpcontrol;
+    double ret;
+
+    *err = 0;
+    if (!num->ndigits) return 0.0;
+
+    if (num->base == 16)
+    {
+        *p++ = '0';
+        *p++ = 'x';
+    }
+    memcpy(p, num->digits, num->ndigits);
+    p += num->ndigits;
+    if (num->inexact)
+    {
+        *p++ = '1';
+        exp--;
+    }
+    if (num->base == 16) exp *= 4;
+    exp += num->e;
+    if (exp > INT_MAX) exp = INT_MAX;
+    if (exp < INT_MIN) exp = INT_MIN;
+    sprintf(p, "%c%d", num->base == 16 ? 'p' : 'e', (int)exp);
+
+    fpcontrol = _control87(0, 0);
+    _control87(MSVCRT__EM_DENORMAL|MSVCRT__EM_INVALID|MSVCRT__EM_ZERODIVIDE
+            |MSVCRT__EM_OVERFLOW|MSVCRT__EM_UNDERFLOW|MSVCRT__EM_INEXACT, 0xffffffff);
+    ret = strtod(buf, NULL);
+    _control87(fpcontrol, 0xffffffff);
+
+    if(ret==0.0 || isinf(ret))
+        *err = MSVCRT_ERANGE;
+    return ret;
+}
+
 static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale, int *err)
 {
     MSVCRT_pthreadlocinfo locinfo;
-    unsigned __int64 d=0, hlp;
-    unsigned fpcontrol;
-    int exp=0, sign=1;
+    struct fpnum num;
+    int sign=1, range;
     const char *p;
     double ret;
-    long double lret=1, expcnt = 10;
-    BOOL found_digit = FALSE, negexp;
+    BOOL found_digit = FALSE;
     int base = 10;
 
     if(err)
@@ -382,11 +449,12 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
 
     if(p[0] == '0' && MSVCRT__tolower_l(p[1], locale) == 'x') {
         base = 16;
-        expcnt = 2;
         p += 2;
     }
 #endif
 
+    fpnum_init(&num, base);
+
     while((*p>='0' && *p<='9') ||
           (base == 16 && ((*p >= 'a' && *p <= 'f') || (*p >= 'A' && *p <= 'F')))) {
         char c = *p++;
@@ -398,17 +466,7 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
             val = 10 + c - 'a';
         else
             val = 10 + c - 'A';
-        hlp = d*base+val;
-        if(d>MSVCRT_UI64_MAX/base || hlp<d) {
-            exp++;
-            break;
-        } else
-            d = hlp;
-    }
-    while((*p>='0' && *p<='9') ||
-          (base == 16 && ((*p >= 'a' && *p <= 'f') || (*p >= 'A' && *p <= 'F')))) {
-        exp++;
-        p++;
+        fpnum_add_digit(&num, val, FALSE);
     }
 
     if(*p == *locinfo->lconv->decimal_point)
@@ -425,15 +483,8 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
             val = 10 + c - 'a';
         else
             val = 10 + c - 'A';
-        hlp = d*base+val;
-        if(d>MSVCRT_UI64_MAX/base || hlp<d)
-            break;
-        d = hlp;
-        exp--;
+        fpnum_add_digit(&num, val, TRUE);
     }
-    while((*p>='0' && *p<='9') ||
-          (base == 16 && ((*p >= 'a' && *p <= 'f') || (*p >= 'A' && *p <= 'F'))))
-        p++;
 
     if(!found_digit) {
         if(end)
@@ -441,9 +492,6 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
         return 0.0;
     }
 
-    if(base == 16)
-        exp *= 4;
-
     if((base == 10 && (*p=='e' || *p=='E' || *p=='d' || *p=='D')) ||
        (base == 16 && (*p=='p' || *p=='P'))) {
         int e=0, s=1;
@@ -461,11 +509,7 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
                     e = INT_MAX;
                 p++;
             }
-            e *= s;
-
-            if(exp<0 && e<0 && exp+e>=0) exp = INT_MIN;
-            else if(exp>0 && e>0 && exp+e<0) exp = INT_MAX;
-            else exp += e;
+            num.e = e * s;
         } else {
             if(*p=='-' || *p=='+')
                 p--;
@@ -473,28 +517,13 @@ static double strtod_helper(const char *str, char **end, MSVCRT__locale_t locale
         }
     }
 
-    fpcontrol = _control87(0, 0);
-    _control87(MSVCRT__EM_DENORMAL|MSVCRT__EM_INVALID|MSVCRT__EM_ZERODIVIDE
-            |MSVCRT__EM_OVERFLOW|MSVCRT__EM_UNDERFLOW|MSVCRT__EM_INEXACT, 0xffffffff);
-
-    negexp = (exp < 0);
-    if(negexp)
-        exp = -exp;
-    while(exp) {
-        if(exp & 1)
-            lret *= expcnt;
-        exp /= 2;
-        expcnt = expcnt*expcnt;
-    }
-    ret = (long double)sign * (negexp ? d/lret : d*lret);
-
-    _control87(fpcontrol, 0xffffffff);
+    ret = sign * fpnum_double(&num, &range);
 
-    if((d && ret==0.0) || isinf(ret)) {
+    if(range) {
         if(err)
-            *err = MSVCRT_ERANGE;
+            *err = range;
         else
-            *MSVCRT__errno() = MSVCRT_ERANGE;
+            *MSVCRT__errno() = range;
     }
 
     if(end)
@@ -2465,6 +2465,34 @@ static void test_write_flush(void)
     free(tempf);
 }
 
+static void test_setvbuf_read(void)
+{
+    char buffer[1024];
+    char *tempf;
+    FILE *file;
+    int i;
+
+    tempf = _tempnam(".","wne");
+    file = fopen(tempf, "wb");
+    ok(file != NULL, "unable to create test file\n");
+    memset(buffer, 'a', sizeof(buffer));
+    for (i = 0; i < 64; i++)
+        fwrite(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+
+    /* the size requested with setvbuf is kept while reading sequentially */
+    file = fopen(tempf, "rb");
+    ok(file != NULL, "unable to open test file\n");
+    ok(!setvbuf(file, NULL, _IOFBF, 4096), "setvbuf failed\n");
+    for (i = 0; i < 64; i++)
+        ok(fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer), "fread failed\n");
+    ok(file->_bufsiz == 4096, "file->_bufsiz = %d\n", file->_bufsiz);
+    fclose(file);
+
+    unlink(tempf);
+    free(tempf);
+}
+
 static void test_close(void)
 {
     ioinfo *stdout_info, stdout_copy, *stderr_info, stderr_copy;
@@ -2652,6 +2680,7 @@ START_TEST(file)
     test_mktemp();
     test__open_osfhandle();
     test_write_flush();
+    test_setvbuf_read();
     test_close();
     test__creat();
 
@@ -388,13 +388,11 @@ double CDECL MSVCRT__wcstod_l(const MSVCRT_wchar_t* str, MSVCRT_wchar_t** end,
         MSVCRT__locale_t locale)
 {
     MSVCRT_pthreadlocinfo locinfo;
-    unsigned __int64 d=0, hlp;
-    unsigned fpcontrol;
-    int exp=0, sign=1;
+    struct fpnum num;
+    int sign=1, range;
     const MSVCRT_wchar_t *p;
     double ret;
-    long double lret=1, expcnt = 10;
-    BOOL found_digit = FALSE, negexp;
+    BOOL found_digit = FALSE;
 
     if (!MSVCRT_CHECK_PMT(str != NULL)) return 0;
 
@@ -413,33 +411,19 @@ double CDECL MSVCRT__wcstod_l(const MSVCRT_wchar_t* str, MSVCRT_wchar_t** end,
     } else  if(*p == '+')
         p++;
 
+    fpnum_init(&num, 10);
+
     while(*p>='0' && *p<='9') {
         found_digit = TRUE;
-        hlp = d*10+*(p++)-'0';
-        if(d>MSVCRT_UI64_MAX/10 || hlp<d) {
-            exp++;
-            break;
-        } else
-            d = hlp;
-    }
-    while(*p>='0' && *p<='9') {
-        exp++;
-        p++;
+        fpnum_add_digit(&num, *(p++)-'0', FALSE);
     }
     if(*p == *locinfo->lconv->decimal_point)
         p++;
 
     while(*p>='0' && *p<='9') {
         found_digit = TRUE;
-        hlp = d*10+*(p++)-'0';
-        if(d>MSVCRT_UI64_MAX/10 || hlp<d)
-            break;
-
-        d = hlp;
-        exp--;
+        fpnum_add_digit(&num, *(p++)-'0', TRUE);
     }
-    while(*p>='0' && *p<='9')
-        p++;
 
     if(!found_digit) {
         if(end)
@@ -463,11 +447,7 @@ double CDECL MSVCRT__wcstod_l(const MSVCRT_wchar_t* str, MSVCRT_wchar_t** end,
                     e = INT_MAX;
                 p++;
             }
-            e *= s;
-
-            if(exp<0 && e<0 && exp+e>=0) exp = INT_MIN;
-            else if(exp>0 && e>0 && exp+e<0) exp = INT_MAX;
-            else exp += e;
+            num.e = e * s;
         } else {
             if(*p=='-' || *p=='+')
                 p--;
@@ -475,25 +455,10 @@ double CDECL MSVCRT__wcstod_l(const MSVCRT_wchar_t* str, MSVCRT_wchar_t** end,
         }
     }
 
-    fpcontrol = _control87(0, 0);
-    _control87(MSVCRT__EM_DENORMAL|MSVCRT__EM_INVALID|MSVCRT__EM_ZERODIVIDE
-            |MSVCRT__EM_OVERFLOW|MSVCRT__EM_UNDERFLOW|MSVCRT__EM_INEXACT, 0xffffffff);
-
-    negexp = (exp < 0);
-    if(negexp)
-        exp = -exp;
-    while(exp) {
-        if(exp & 1)
-            lret *= expcnt;
-        exp /= 2;
-        expcnt = expcnt*expcnt;
-    }
-    ret = (long double)sign * (negexp ? d/lret : d*lret);
-
-    _control87(fpcontrol, 0xffffffff);
+    ret = sign * fpnum_double(&num, &range);
 
-    if((d && ret==0.0) || isinf(ret))
-        *MSVCRT__errno() = MSVCRT_ERANGE;
+    if(range)
+        *MSVCRT__errno() = range;
 
     if(end)
         *end = (MSVCRT_wchar_t*)p;
@@ -25,11 +25,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 
 #include "wine/debug.h"
+#include "wine/debuglog.h"
 #include "ntdll_misc.h"
 
 WINE_DECLARE_DEBUG_CHANNEL(pid);
@@ -41,6 +46,7 @@ static unsigned char default_flags = (1 << __WINE_DBCL_ERR) | (1 << __WINE_DBCL_
 static int nb_debug_options = -1;
 static int options_size;
 static struct __wine_debug_channel *debug_options;
+static struct debuglog_header *debuglog;  /* binary log mapping, if enabled */
 
 static const char * const debug_classes[] = { "fixme", "err", "warn", "trace" };
 
@@ -65,6 +71,102 @@ static int append_output( struct debug_info *info, const char *str, size_t len )
     return len;
 }
 
+/* claim a free chunk of the binary log for the current thread */
+static struct debuglog_chunk *claim_debuglog_chunk( struct debug_info *info )
+{
+    struct debuglog_chunk *chunk;
+    DWORD tid = GetCurrentThreadId();
+    UINT i, seq;
+
+    if (info->log_chunk) ((struct debuglog_chunk *)info->log_chunk)->owner = 0;
+    info->log_chunk = NULL;
+
+    for (i = 0; i < debuglog->chunk_count; i++)
+    {
+        seq = interlocked_xchg_add( &debuglog->next_seq, 1 );
+        chunk = (struct debuglog_chunk *)((char *)debuglog + (seq % debuglog->chunk_count + 1) * debuglog->chunk_size);
+        if (interlocked_cmpxchg( &chunk->owner, tid, 0 )) continue;  /* still in use */
+        chunk->tid  = tid;
+        chunk->seq  = seq;
+        chunk->used = 0;
+        return info->log_chunk = chunk;
+    }
+    return NULL;
+}
+
+/* store the current output line in the binary log */
+static void debuglog_output( struct debug_info *info, const char *str, size_t len )
+{
+    struct debuglog_chunk *chunk = info->log_chunk;
+    struct debuglog_record *rec;
+    LARGE_INTEGER counter;
+    size_t channel_len = 0, function_len = 0, size;
+    char *ptr;
+
+    if (info->log_cls && info->log_cls != DEBUGLOG_NO_HEADER)
+    {
+        channel_len = strlen( info->log_channel->name );
+        function_len = min( strlen( info->log_function ), 255 );
+    }
+    size = (sizeof(*rec) + channel_len + function_len + len + 7) & ~7;
+
+    if (!chunk || chunk->used + size > debuglog->chunk_size - sizeof(*chunk))
+    {
+        if (!(chunk = claim_debuglog_chunk( info )))
+        {
+            interlocked_xchg_add( &debuglog->lost, 1 );
+            return;
+        }
+    }
+
+    NtQueryPerformanceCounter( &counter, NULL );
+    rec = (struct debuglog_record *)((char *)(chunk + 1) + chunk->used);
+    rec->time         = counter.QuadPart;
+    rec->size         = size;
+    rec->text_len     = len;
+    rec->cls          = channel_len ? info->log_cls - 1 : DEBUGLOG_NO_HEADER;
+    rec->channel_len  = channel_len;
+    rec->function_len = function_len;
+    ptr = (char *)(rec + 1);
+    if (channel_len) memcpy( ptr, info->log_channel->name, channel_len );
+    ptr += channel_len;
+    if (function_len) memcpy( ptr, info->log_function, function_len );
+    ptr += function_len;
+    memcpy( ptr, str, len );
+    chunk->used += size;
+}
+
+/* map the binary log file requested with WINEDEBUGLOG */
+static void init_debuglog(void)
+{
+    const char *name = getenv( "WINEDEBUGLOG" );
+    LARGE_INTEGER freq;
+    char *path;
+    void *ptr;
+    int fd;
+
+    if (!name || !name[0]) return;
+    if (!(path = malloc( strlen(name) + 12 ))) return;
+    sprintf( path, "%s.%u", name, getpid() );
+    fd = open( path, O_RDWR | O_CREAT | O_TRUNC, 0666 );
+    free( path );
+    if (fd == -1) return;
+
+    if (!ftruncate( fd, DEBUGLOG_FILE_SIZE ) &&
+        (ptr = mmap( NULL, DEBUGLOG_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) != MAP_FAILED)
+    {
+        NtQueryPerformanceCounter( NULL, &freq );
+        debuglog = ptr;
+        debuglog->version     = DEBUGLOG_VERSION;
+        debuglog->chunk_size  = DEBUGLOG_CHUNK_SIZE;
+        debuglog->chunk_count = DEBUGLOG_FILE_SIZE / DEBUGLOG_CHUNK_SIZE - 1;
+        debuglog->freq        = freq.QuadPart;
+        if (init_done) debuglog->pid = GetCurrentProcessId();
+        debuglog->magic       = DEBUGLOG_MAGIC;
+    }
+    close( fd );
+}
+
 /* add a new debug option at the end of the option list */
 static void add_option( const char *name, unsigned char set, unsigned char clear )
 {
@@ -184,6 +286,7 @@ static void init_options(void)
     if (!wine_debug) return;
     if (!strcmp( wine_debug, "help" )) debug_usage();
     parse_options( wine_debug );
+    init_debuglog();
 }
 
 /***********************************************************************
@@ -239,8 +342,10 @@ int __cdecl __wine_dbg_output( const char *str )
     if (end)
     {
         ret += append_output( info, str, end + 1 - str );
-        write( 2, info->output, info->out_pos );
+        if (debuglog && init_done) debuglog_output( info, info->output, info->out_pos );
+        else write( 2, info->output, info->out_pos );
         info->out_pos = 0;
+        info->log_cls = 0;
         str = end + 1;
     }
     if (*str) ret += append_output( info, str, strlen( str ));
@@ -260,7 +365,20 @@ int __cdecl __wine_dbg_header( enum __wine_debug_class cls, struct __wine_debug_
     if (!(__wine_dbg_get_channel_flags( channel ) & (1 << cls))) return -1;
 
     /* only print header if we are at the beginning of the line */
-    if (info->out_pos) return 0;
+    if (info->out_pos || info->log_cls) return 0;
+
+    if (debuglog && init_done)
+    {
+        /* the header is stored in binary form with the line */
+        if (function && cls < ARRAY_SIZE( classes ))
+        {
+            info->log_cls      = cls + 1;
+            info->log_channel  = channel;
+            info->log_function = function;
+        }
+        else info->log_cls = DEBUGLOG_NO_HEADER;
+        return 0;
+    }
 
     if (init_done)
     {
@@ -286,4 +404,18 @@ void debug_init(void)
 {
     ntdll_get_thread_data()->debug_info = &initial_info;
     init_done = TRUE;
+    if (debuglog) debuglog->pid = GetCurrentProcessId();
+}
+
+/***********************************************************************
+ *		debug_exit_thread
+ *
+ * Release the binary log chunk owned by the exiting thread.
+ */
+void debug_exit_thread(void)
+{
+    struct debug_info *info = get_info();
+
+    if (info->log_chunk) ((struct debuglog_chunk *)info->log_chunk)->owner = 0;
+    info->log_chunk = NULL;
 }
@@ -95,6 +95,12 @@
 #ifdef HAVE_VALGRIND_MEMCHECK_H
 # include <valgrind/memcheck.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+# include <linux/io_uring.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -102,6 +108,7 @@
 #include "wine/unicode.h"
 #include "wine/debug.h"
 #include "wine/server.h"
+#include "wine/list.h"
 #include "ntdll_misc.h"
 
 #include "winternl.h"
@@ -801,6 +808,444 @@ static NTSTATUS register_async_file_read( HANDLE handle, HANDLE event,
 }
 
 
+#ifdef HAVE_LINUX_IO_URING_H
+
+/* Overlapped I/O on regular files is submitted to an io_uring, instead of
+ * blocking the caller in pread/pwrite. This gives such requests a real
+ * queue depth.
+ *
+ * Only requests that report to a completion port and have neither an event
+ * nor an APC are submitted, since those can be completed without the server:
+ * the IOSB is written directly and the completion is posted to the shared
+ * completion queue. The port is looked up in a list filled when the handle
+ * is bound to it in this process, which keeps a duplicate of the port handle.
+ * The file object is not signaled, so GetOverlappedResult waits on the IOSB
+ * status instead.
+ *
+ * Nothing in the application waits in ntdll for these requests, it waits
+ * on the completion port, so a thread has to reap the ring and complete
+ * them; this is the same as the timer queue thread of the thread pool.
+ * The thread is started with the first request and exits once no request
+ * is pending.
+ *
+ * Pending requests are kept in a list, so that NtCancelIoFile(Ex) and
+ * NtClose can cancel them. Both wait until the cancelled requests have
+ * completed, since the kernel would otherwise write to a buffer that the
+ * application may free as soon as the handle is closed. */
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+
+#define URING_ENTRIES 128
+
+struct uring_io
+{
+    struct list      entry;     /* entry in the pending list */
+    HANDLE           handle;    /* handle the request was issued on */
+    DWORD            tid;       /* thread that issued the request */
+    BOOL             cancelled;
+    IO_STATUS_BLOCK *iosb;
+    HANDLE           port;      /* completion port the request is reported to */
+    ULONG_PTR        key;
+    ULONG_PTR        cvalue;
+    int              fd;        /* private copy of the unix fd */
+    BOOL             write;
+    struct iovec     iov;
+    off_t            offset;
+};
+
+/* completion port bound to a file handle */
+struct uring_port
+{
+    struct list      entry;
+    HANDLE           handle;    /* file handle */
+    HANDLE           port;      /* private duplicate of the completion port handle */
+    ULONG_PTR        key;
+};
+
+static struct list uring_ports = LIST_INIT( uring_ports );
+
+static struct
+{
+    int                  fd;
+    unsigned int         entries;
+    LONG                 inflight;
+    BOOL                 thread_running;
+    struct list          pending;
+    unsigned int        *sq_tail;
+    unsigned int        *sq_mask;
+    unsigned int        *sq_array;
+    unsigned int        *cq_head;
+    unsigned int        *cq_tail;
+    unsigned int        *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+} uring = { -1, 0, 0, FALSE, LIST_INIT( uring.pending ) };
+
+static RTL_RUN_ONCE uring_once = RTL_RUN_ONCE_INIT;
+static RTL_CONDITION_VARIABLE uring_completed = RTL_CONDITION_VARIABLE_INIT;
+
+static RTL_CRITICAL_SECTION uring_section;
+static RTL_CRITICAL_SECTION_DEBUG uring_critsect_debug =
+{
+    0, 0, &uring_section,
+    { &uring_critsect_debug.ProcessLocksList, &uring_critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": uring_section") }
+};
+static RTL_CRITICAL_SECTION uring_section = { &uring_critsect_debug, -1, 0, 0, 0, 0 };
+
+/* hand a submission entry to the kernel; uring_section must be held */
+static BOOL uring_enter_sqe( const struct io_uring_sqe *sqe )
+{
+    unsigned int tail = *uring.sq_tail, index = tail & *uring.sq_mask;
+    int ret;
+
+    uring.sqes[index] = *sqe;
+    uring.sq_array[index] = index;
+    __atomic_store_n( uring.sq_tail, tail + 1, __ATOMIC_RELEASE );
+    ret = syscall( __NR_io_uring_enter, uring.fd, 1, 0, 0, NULL, 0 );
+    /* the kernel only consumes entries in io_uring_enter, so we can take it back */
+    if (ret != 1)
+    {
+        WARN( "io_uring_enter failed: %s\n", strerror(errno) );
+        __atomic_store_n( uring.sq_tail, tail, __ATOMIC_RELEASE );
+    }
+    return ret == 1;
+}
+
+/* perform the remaining part of an io_uring request synchronously */
+static int uring_sync_io( struct uring_io *io )
+{
+    ssize_t ret;
+
+    do
+    {
+        if (io->write) ret = pwrite( io->fd, io->iov.iov_base, io->iov.iov_len, io->offset );
+        else ret = virtual_locked_pread( io->fd, io->iov.iov_base, io->iov.iov_len, io->offset );
+    } while (ret == -1 && errno == EINTR);
+
+    return ret == -1 ? -errno : ret;
+}
+
+/* complete an io_uring request; called from the completion thread */
+static void complete_uring_io( struct uring_io *io, int res )
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG total = 0;
+
+    /* a request that was already running is interrupted instead of cancelled */
+    if (io->cancelled && (res == -ECANCELED || res == -EINTR)) status = STATUS_CANCELLED;
+    else
+    {
+        /* the buffer may be write-watched, in which case the kernel cannot write to it */
+        if (res == -EFAULT || res == -EINTR || res == -EAGAIN) res = uring_sync_io( io );
+
+        while (res > 0)
+        {
+            total += res;
+            io->iov.iov_base = (char *)io->iov.iov_base + res;
+            io->iov.iov_len -= res;
+            io->offset += res;
+            if (!io->iov.iov_len || io->cancelled) break;
+            res = uring_sync_io( io );  /* short transfer */
+        }
+
+        if (res < 0 && !total)
+        {
+            errno = -res;
+            if (io->write && errno == EFAULT) status = STATUS_INVALID_USER_BUFFER;
+            else status = FILE_GetNtStatus();
+        }
+        else if (!total && !io->write && io->iov.iov_len) status = STATUS_END_OF_FILE;
+    }
+
+    TRACE( "%p: status %08x, %u bytes\n", io->iosb, status, total );
+
+    io->iosb->Information = total;
+    io->iosb->u.Status = status;
+    RtlWakeAddressAll( &io->iosb->u.Status );
+    NtSetIoCompletion( io->port, io->key, io->cvalue, status, total );
+    close( io->fd );
+
+    RtlEnterCriticalSection( &uring_section );
+    list_remove( &io->entry );
+    RtlWakeAllConditionVariable( &uring_completed );
+    RtlLeaveCriticalSection( &uring_section );
+
+    RtlFreeHeap( GetProcessHeap(), 0, io );
+    interlocked_xchg_add( &uring.inflight, -1 );
+}
+
+/* thread reaping the io_uring completions */
+static void WINAPI uring_completion_thread( void *arg )
+{
+    for (;;)
+    {
+        unsigned int head = *uring.cq_head;
+
+        while (head != __atomic_load_n( uring.cq_tail, __ATOMIC_ACQUIRE ))
+        {
+            struct io_uring_cqe *cqe = &uring.cqes[head & *uring.cq_mask];
+            struct uring_io *io = (struct uring_io *)(ULONG_PTR)cqe->user_data;
+            int res = cqe->res;
+
+            __atomic_store_n( uring.cq_head, ++head, __ATOMIC_RELEASE );
+            if (io) complete_uring_io( io, res );  /* cancel requests have no data */
+        }
+
+        RtlEnterCriticalSection( &uring_section );
+        if (list_empty( &uring.pending ))
+        {
+            uring.thread_running = FALSE;
+            RtlLeaveCriticalSection( &uring_section );
+            break;
+        }
+        RtlLeaveCriticalSection( &uring_section );
+
+        syscall( __NR_io_uring_enter, uring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0 );
+    }
+    RtlExitUserThread( 0 );
+}
+
+static DWORD WINAPI init_uring( RTL_RUN_ONCE *once, void *param, void **context )
+{
+    struct io_uring_params params;
+    size_t sq_size, cq_size, sqes_size;
+    char *sq = MAP_FAILED, *cq = MAP_FAILED;
+    void *sqes = MAP_FAILED;
+    int fd;
+
+    memset( &params, 0, sizeof(params) );
+    if ((fd = syscall( __NR_io_uring_setup, URING_ENTRIES, &params )) == -1)
+    {
+        TRACE( "io_uring not available: %s\n", strerror(errno) );
+        return TRUE;
+    }
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    if ((sq = mmap( NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQ_RING )) == MAP_FAILED ||
+        (cq = mmap( NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_CQ_RING )) == MAP_FAILED ||
+        (sqes = mmap( NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQES )) == MAP_FAILED)
+    {
+        WARN( "failed to set up io_uring\n" );
+        if (sqes != MAP_FAILED) munmap( sqes, sqes_size );
+        if (cq != MAP_FAILED) munmap( cq, cq_size );
+        if (sq != MAP_FAILED) munmap( sq, sq_size );
+        close( fd );
+        return TRUE;
+    }
+
+    /* each request can also need a cancel entry, the completion ring
+     * is twice the size of the submission ring */
+    uring.entries  = params.sq_entries;
+    uring.sq_tail  = (unsigned int *)(sq + params.sq_off.tail);
+    uring.sq_mask  = (unsigned int *)(sq + params.sq_off.ring_mask);
+    uring.sq_array = (unsigned int *)(sq + params.sq_off.array);
+    uring.cq_head  = (unsigned int *)(cq + params.cq_off.head);
+    uring.cq_tail  = (unsigned int *)(cq + params.cq_off.tail);
+    uring.cq_mask  = (unsigned int *)(cq + params.cq_off.ring_mask);
+    uring.cqes     = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    uring.sqes     = sqes;
+    uring.fd       = fd;
+    TRACE( "using io_uring with %u entries\n", uring.entries );
+    return TRUE;
+}
+
+/* remember the completion port of a file handle; helper for NtSetInformationFile */
+static void uring_bind_port( HANDLE handle, HANDLE port, ULONG_PTR key )
+{
+    struct uring_port *binding;
+
+    RtlRunOnceExecuteOnce( &uring_once, init_uring, NULL, NULL );
+    if (uring.fd == -1) return;
+
+    if (!(binding = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*binding) ))) return;
+    binding->handle = handle;
+    binding->key    = key;
+    if (NtDuplicateObject( NtCurrentProcess(), port, NtCurrentProcess(), &binding->port,
+                           0, 0, DUPLICATE_SAME_ACCESS ))
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, binding );
+        return;
+    }
+
+    RtlEnterCriticalSection( &uring_section );
+    list_add_tail( &uring_ports, &binding->entry );
+    RtlLeaveCriticalSection( &uring_section );
+}
+
+/* submit an overlapped regular file read or write to the io_uring; helper for NtReadFile/NtWriteFile */
+static NTSTATUS uring_submit_io( HANDLE handle, int unix_fd, ULONG_PTR cvalue,
+                                 IO_STATUS_BLOCK *iosb, const void *buffer, ULONG length,
+                                 off_t offset, BOOL write )
+{
+    struct io_uring_sqe sqe;
+    struct uring_port *binding;
+    struct uring_io *io;
+    HANDLE thread;
+    BOOL ret = FALSE;
+
+    if (uring.fd == -1) return STATUS_NOT_SUPPORTED;  /* no handle was bound to a port */
+
+    /* never queue more requests than the completion ring can hold */
+    if (interlocked_xchg_add( &uring.inflight, 1 ) >= uring.entries) goto failed;
+
+    if (!(io = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*io) ))) goto failed;
+    io->handle    = handle;
+    io->tid       = GetCurrentThreadId();
+    io->cancelled = FALSE;
+    io->iosb      = iosb;
+    io->port      = 0;
+    io->key       = 0;
+    io->cvalue    = cvalue;
+    io->write     = write;
+    io->offset    = offset;
+    io->iov.iov_base = (void *)buffer;
+    io->iov.iov_len  = length;
+
+    if ((io->fd = dup( unix_fd )) == -1) goto failed_free;
+
+    memset( &sqe, 0, sizeof(sqe) );
+    sqe.opcode    = write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe.fd        = io->fd;
+    sqe.off       = offset;
+    sqe.addr      = (ULONG_PTR)&io->iov;
+    sqe.len       = 1;
+    sqe.user_data = (ULONG_PTR)io;
+
+    RtlEnterCriticalSection( &uring_section );
+    LIST_FOR_EACH_ENTRY( binding, &uring_ports, struct uring_port, entry )
+    {
+        if (binding->handle != handle) continue;
+        io->port = binding->port;
+        io->key  = binding->key;
+        break;
+    }
+    if (io->port && !uring.thread_running)
+    {
+        if (!RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, NULL, 0, 0,
+                                  uring_completion_thread, NULL, &thread, NULL ))
+        {
+            NtClose( thread );
+            uring.thread_running = TRUE;
+        }
+    }
+    if (io->port && uring.thread_running && (ret = uring_enter_sqe( &sqe )))
+        list_add_tail( &uring.pending, &io->entry );
+    RtlLeaveCriticalSection( &uring_section );
+
+    if (ret) return STATUS_PENDING;
+
+    close( io->fd );
+failed_free:
+    RtlFreeHeap( GetProcessHeap(), 0, io );
+failed:
+    interlocked_xchg_add( &uring.inflight, -1 );
+    return STATUS_NOT_SUPPORTED;
+}
+
+/* cancel the io_uring requests issued on a handle and wait for them to complete */
+static BOOL uring_cancel_io( HANDLE handle, IO_STATUS_BLOCK *iosb, BOOL only_thread )
+{
+    struct io_uring_sqe sqe;
+    struct uring_io *io;
+    DWORD tid = GetCurrentThreadId();
+    BOOL found = FALSE, pending;
+
+    if (uring.fd == -1) return FALSE;
+
+    RtlEnterCriticalSection( &uring_section );
+    LIST_FOR_EACH_ENTRY( io, &uring.pending, struct uring_io, entry )
+    {
+        if (io->handle != handle || (iosb && io->iosb != iosb) || (only_thread && io->tid != tid))
+            continue;
+        found = TRUE;
+        if (io->cancelled) continue;
+        io->cancelled = TRUE;
+
+        memset( &sqe, 0, sizeof(sqe) );
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.fd     = -1;
+        sqe.addr   = (ULONG_PTR)io;
+        uring_enter_sqe( &sqe );
+    }
+
+    /* the request can't be stopped once it runs, wait for it */
+    do
+    {
+        pending = FALSE;
+        LIST_FOR_EACH_ENTRY( io, &uring.pending, struct uring_io, entry )
+        {
+            if (io->handle != handle || !io->cancelled) continue;
+            pending = TRUE;
+            break;
+        }
+        if (pending) RtlSleepConditionVariableCS( &uring_completed, &uring_section, NULL );
+    } while (pending);
+    RtlLeaveCriticalSection( &uring_section );
+
+    return found;
+}
+
+/***********************************************************************
+ *           cancel_uring_io
+ *
+ * Cancel the io_uring requests of a handle that is being closed, and forget its port.
+ */
+void cancel_uring_io( HANDLE handle )
+{
+    struct uring_port *binding;
+    HANDLE port = 0;
+
+    if (uring.fd == -1) return;
+    uring_cancel_io( handle, NULL, FALSE );
+
+    RtlEnterCriticalSection( &uring_section );
+    LIST_FOR_EACH_ENTRY( binding, &uring_ports, struct uring_port, entry )
+    {
+        if (binding->handle != handle) continue;
+        list_remove( &binding->entry );
+        port = binding->port;
+        RtlFreeHeap( GetProcessHeap(), 0, binding );
+        break;
+    }
+    RtlLeaveCriticalSection( &uring_section );
+
+    if (port) NtClose( port );
+}
+
+#else  /* HAVE_LINUX_IO_URING_H */
+
+static void uring_bind_port( HANDLE handle, HANDLE port, ULONG_PTR key )
+{
+}
+
+static NTSTATUS uring_submit_io( HANDLE handle, int unix_fd, ULONG_PTR cvalue,
+                                 IO_STATUS_BLOCK *iosb, const void *buffer, ULONG length,
+                                 off_t offset, BOOL write )
+{
+    return STATUS_NOT_SUPPORTED;
+}
+
+static BOOL uring_cancel_io( HANDLE handle, IO_STATUS_BLOCK *iosb, BOOL only_thread )
+{
+    return FALSE;
+}
+
+void cancel_uring_io( HANDLE handle )
+{
+}
+
+#endif  /* HAVE_LINUX_IO_URING_H */
+
+
 /******************************************************************************
  *  NtReadFile					[NTDLL.@]
  *  ZwReadFile					[NTDLL.@]
@@ -863,6 +1308,13 @@ NTSTATUS WINAPI NtReadFile(HANDLE hFile, HANDLE hEvent,
 
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
         {
+            if (async_read && !hEvent && !apc && cvalue)
+            {
+                status = uring_submit_io( hFile, unix_handle, cvalue, io_status,
+                                          buffer, length, offset->QuadPart, FALSE );
+                if (status == STATUS_PENDING) goto err;
+            }
+
             /* async I/O doesn't make sense on regular files */
             while ((result = virtual_locked_pread( unix_handle, buffer, length, offset->QuadPart )) == -1)
             {
@@ -1267,6 +1719,12 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
                 status = STATUS_INVALID_PARAMETER;
                 goto done;
             }
+            else if (async_write && !hEvent && !apc && cvalue)
+            {
+                status = uring_submit_io( hFile, unix_handle, cvalue, io_status,
+                                          buffer, length, off, TRUE );
+                if (status == STATUS_PENDING) goto err;
+            }
 
             /* async I/O doesn't make sense on regular files */
             while ((result = pwrite( unix_handle, buffer, length, off )) == -1)
@@ -2651,6 +3109,7 @@ NTSTATUS WINAPI NtSetInformationFile(HANDLE handle, PIO_STATUS_BLOCK io,
                 io->u.Status  = wine_server_call( req );
             }
             SERVER_END_REQ;
+            if (!io->u.Status) uring_bind_port( handle, info->CompletionPort, info->CompletionKey );
         } else
             io->u.Status = STATUS_INVALID_PARAMETER_3;
         break;
@@ -3544,8 +4003,12 @@ NTSTATUS WINAPI NtDeleteFile( POBJECT_ATTRIBUTES ObjectAttributes )
  */
 NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATUS_BLOCK io_status )
 {
+    BOOL found;
+
     TRACE("%p %p %p\n", hFile, iosb, io_status );
 
+    found = uring_cancel_io( hFile, iosb, FALSE );
+
     SERVER_START_REQ( cancel_async )
     {
         req->handle      = wine_server_obj_handle( hFile );
@@ -3554,6 +4017,7 @@ NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATU
         io_status->u.Status = wine_server_call( req );
     }
     SERVER_END_REQ;
+    if (found && io_status->u.Status == STATUS_NOT_FOUND) io_status->u.Status = STATUS_SUCCESS;
 
     return io_status->u.Status;
 }
@@ -3565,8 +4029,12 @@ NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATU
  */
 NTSTATUS WINAPI NtCancelIoFile( HANDLE hFile, PIO_STATUS_BLOCK io_status )
 {
+    BOOL found;
+
     TRACE("%p %p\n", hFile, io_status );
 
+    found = uring_cancel_io( hFile, NULL, TRUE );
+
     SERVER_START_REQ( cancel_async )
     {
         req->handle      = wine_server_obj_handle( hFile );
@@ -3575,6 +4043,7 @@ NTSTATUS WINAPI NtCancelIoFile( HANDLE hFile, PIO_STATUS_BLOCK io_status )
         io_status->u.Status = wine_server_call( req );
     }
     SERVER_END_REQ;
+    if (found && io_status->u.Status == STATUS_NOT_FOUND) io_status->u.Status = STATUS_SUCCESS;
 
     return io_status->u.Status;
 }
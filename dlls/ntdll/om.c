@@ -364,10 +364,18 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source,
         if (!(ret = wine_server_call( req )))
         {
             if (dest) *dest = wine_server_ptr_handle( reply->handle );
+            if (dest && dest_process == NtCurrentProcess())
+            {
+                release_completion_shm( *dest );
+                release_value_cache( *dest );
+            }
             if (reply->closed && reply->self)
             {
                 int fd = server_remove_fd_from_cache( source );
                 if (fd != -1) close( fd );
+                cancel_uring_io( source );
+                release_completion_shm( source );
+                release_value_cache( source );
             }
         }
     }
@@ -387,6 +395,9 @@ NTSTATUS close_handle( HANDLE handle )
     NTSTATUS ret;
     int fd = server_remove_fd_from_cache( handle );
 
+    cancel_uring_io( handle );
+    release_completion_shm( handle );
+
     SERVER_START_REQ( close_handle )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -394,6 +405,7 @@ NTSTATUS close_handle( HANDLE handle )
     }
     SERVER_END_REQ;
     if (fd != -1) close( fd );
+    release_value_cache( handle );
 
     if (ret == STATUS_INVALID_HANDLE && handle && NtCurrentTeb()->Peb->BeingDebugged)
     {
@@ -31,6 +31,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "ntstatus.h"
@@ -38,6 +39,7 @@
 #include "wine/library.h"
 #include "ntdll_misc.h"
 #include "wine/debug.h"
+#include "wine/list.h"
 #include "wine/unicode.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(reg);
@@ -45,6 +47,253 @@ WINE_DEFAULT_DEBUG_CHANNEL(reg);
 /* maximum length of a value name in bytes (without terminating null) */
 #define MAX_VALUE_LENGTH (16383 * sizeof(WCHAR))
 
+/* Value queries can be cached in the process when WINEREGCACHE is set.
+ * Entries are keyed by handle and value name, and are valid as long as the
+ * generation counter of the key, which the server shares with all clients,
+ * has not changed. Access rights and Wow64 redirection are resolved when
+ * the handle is opened, so the cache doesn't need to care about them.
+ *
+ * A handle closed by another process with DUPLICATE_CLOSE_SOURCE leaves
+ * its values behind, so they are also dropped whenever a key handle is
+ * returned by NtCreateKey, NtOpenKey or duplicated into this process.
+ * A handle value that another process closes and then reuses by
+ * duplicating a different key into this process is not detected. */
+
+#define VALUE_CACHE_BUCKETS  256  /* number of hash buckets, indexed by handle */
+#define VALUE_CACHE_DEPTH    16   /* maximum number of values per bucket */
+#define VALUE_CACHE_MAX_DATA 512  /* maximum size of the data of a cached value */
+#define VALUE_CACHE_REFS     4096 /* number of reference counters, indexed by handle */
+
+struct cached_value
+{
+    struct list   entry;       /* entry in the hash bucket, most recently used first */
+    HANDLE        handle;      /* key handle */
+    unsigned int  gen_slot;    /* generation counter slot of the key */
+    unsigned int  generation;  /* generation of the key when the value was queried */
+    NTSTATUS      status;      /* query status, success or STATUS_OBJECT_NAME_NOT_FOUND */
+    int           type;        /* value type */
+    data_size_t   total;       /* value data length */
+    USHORT        name_len;    /* value name length in bytes */
+    BYTE          data[1];     /* value name followed by value data */
+};
+
+static struct list value_cache[VALUE_CACHE_BUCKETS];
+static const volatile struct registry_shm *registry_shm;
+static int value_cache_enabled = -1;
+static unsigned int value_cache_closes;  /* number of handles closed, to detect races with queries */
+static LONG value_cache_refs[VALUE_CACHE_REFS];  /* cached values and pending queries per handle hash */
+
+static RTL_CRITICAL_SECTION value_cache_section;
+static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
+{
+    0, 0, &value_cache_section,
+    { &critsect_debug.ProcessLocksList, &critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": value_cache_section") }
+};
+static RTL_CRITICAL_SECTION value_cache_section = { &critsect_debug, -1, 0, 0, 0, 0 };
+
+static inline struct list *get_value_cache_bucket( HANDLE handle )
+{
+    return &value_cache[((ULONG_PTR)handle >> 2) % VALUE_CACHE_BUCKETS];
+}
+
+static inline LONG *get_value_cache_refs( HANDLE handle )
+{
+    return &value_cache_refs[((ULONG_PTR)handle >> 2) % VALUE_CACHE_REFS];
+}
+
+/* remove a value from the cache; must be called with the cache lock held */
+static void remove_cached_value( struct cached_value *value )
+{
+    list_remove( &value->entry );
+    InterlockedDecrement( get_value_cache_refs( value->handle ));
+}
+
+/* check whether the cache is enabled, mapping the generation counters on first use;
+ * must be called with the cache lock held */
+static BOOL init_value_cache(void)
+{
+    const char *env;
+    HANDLE handle = 0;
+    SIZE_T size = 0;
+    void *ptr = NULL;
+    unsigned int i;
+
+    if (value_cache_enabled != -1) return value_cache_enabled;
+    value_cache_enabled = 0;
+    if (!(env = getenv( "WINEREGCACHE" )) || !atoi( env )) return FALSE;
+
+    SERVER_START_REQ( get_registry_shm )
+    {
+        if (!wine_server_call( req )) handle = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (!handle) return FALSE;
+    if (NtMapViewOfSection( handle, NtCurrentProcess(), &ptr, 0, 0, NULL, &size,
+                            ViewShare, 0, PAGE_READONLY )) ptr = NULL;
+    NtClose( handle );
+    if (!ptr) return FALSE;
+
+    for (i = 0; i < VALUE_CACHE_BUCKETS; i++) list_init( &value_cache[i] );
+    registry_shm = ptr;
+    value_cache_enabled = 1;
+    TRACE( "registry value cache enabled\n" );
+    return TRUE;
+}
+
+/* look up a value in the cache and copy its data; return FALSE if not found */
+static BOOL get_cached_value( HANDLE handle, const UNICODE_STRING *name, NTSTATUS *status,
+                              int *type, data_size_t *total, void *data, data_size_t size )
+{
+    struct list *bucket = get_value_cache_bucket( handle );
+    struct cached_value *value;
+    BOOL ret = FALSE;
+
+    RtlEnterCriticalSection( &value_cache_section );
+    if (init_value_cache())
+    {
+        LIST_FOR_EACH_ENTRY( value, bucket, struct cached_value, entry )
+        {
+            if (value->handle != handle || value->name_len != name->Length) continue;
+            if (memcmp( value->data, name->Buffer, name->Length )) continue;
+            if (registry_shm->generation[value->gen_slot] != value->generation)
+            {
+                remove_cached_value( value );
+                RtlFreeHeap( GetProcessHeap(), 0, value );
+                break;
+            }
+            list_remove( &value->entry );
+            list_add_head( bucket, &value->entry );
+            *status = value->status;
+            *type   = value->type;
+            *total  = value->total;
+            if (size) memcpy( data, value->data + value->name_len, min( size, value->total ));
+            ret = TRUE;
+            break;
+        }
+    }
+    RtlLeaveCriticalSection( &value_cache_section );
+    return ret;
+}
+
+/* add a value to the cache, unless a handle was closed since the query was sent */
+static void add_cached_value( HANDLE handle, const UNICODE_STRING *name, unsigned int closes,
+                              NTSTATUS status, int type, data_size_t total, const void *data,
+                              unsigned int gen_slot, unsigned int generation )
+{
+    struct list *bucket = get_value_cache_bucket( handle );
+    struct cached_value *value;
+    unsigned int count = 0;
+
+    if (gen_slot >= REGISTRY_SHM_SLOTS) return;
+    if (!(value = RtlAllocateHeap( GetProcessHeap(), 0,
+                                   FIELD_OFFSET( struct cached_value, data[name->Length + total] ))))
+        return;
+    value->handle     = handle;
+    value->gen_slot   = gen_slot;
+    value->generation = generation;
+    value->status     = status;
+    value->type       = type;
+    value->total      = total;
+    value->name_len   = name->Length;
+    memcpy( value->data, name->Buffer, name->Length );
+    memcpy( value->data + name->Length, data, total );
+
+    RtlEnterCriticalSection( &value_cache_section );
+    if (closes == value_cache_closes)
+    {
+        list_add_head( bucket, &value->entry );
+        InterlockedIncrement( get_value_cache_refs( handle ));
+        count = list_count( bucket );
+        value = NULL;
+    }
+    /* drop the least recently used value if the bucket is full */
+    if (count > VALUE_CACHE_DEPTH)
+    {
+        value = LIST_ENTRY( list_tail( bucket ), struct cached_value, entry );
+        remove_cached_value( value );
+    }
+    RtlLeaveCriticalSection( &value_cache_section );
+    RtlFreeHeap( GetProcessHeap(), 0, value );
+}
+
+/***********************************************************************
+ *           release_value_cache
+ *
+ * Drop the cached values of a handle after it has been closed, or when it
+ * gets returned for a key since another process may have closed it.
+ * Handles without cached values or pending queries, like all the handles
+ * that are not keys, are skipped without taking the lock.
+ */
+void release_value_cache( HANDLE handle )
+{
+    struct list *bucket = get_value_cache_bucket( handle );
+    struct cached_value *value, *next;
+
+    if (value_cache_enabled != 1) return;
+    if (!*get_value_cache_refs( handle )) return;
+
+    RtlEnterCriticalSection( &value_cache_section );
+    value_cache_closes++;
+    LIST_FOR_EACH_ENTRY_SAFE( value, next, bucket, struct cached_value, entry )
+    {
+        if (value->handle != handle) continue;
+        remove_cached_value( value );
+        RtlFreeHeap( GetProcessHeap(), 0, value );
+    }
+    RtlLeaveCriticalSection( &value_cache_section );
+}
+
+/* query a value from the server, and cache it if the cache is enabled */
+static NTSTATUS query_value( HANDLE handle, const UNICODE_STRING *name, int *type,
+                             data_size_t *total, void *data, data_size_t size )
+{
+    BYTE buffer[VALUE_CACHE_MAX_DATA];
+    void *reply_ptr = data;
+    data_size_t reply_size = size;
+    unsigned int gen_slot, generation, closes = 0;
+    BOOL cache = value_cache_enabled == 1;
+    NTSTATUS ret;
+
+    if (cache)
+    {
+        /* a close racing with the query has to update value_cache_closes */
+        InterlockedIncrement( get_value_cache_refs( handle ));
+        RtlEnterCriticalSection( &value_cache_section );
+        closes = value_cache_closes;
+        RtlLeaveCriticalSection( &value_cache_section );
+        /* make sure that small values are retrieved completely */
+        if (size < sizeof(buffer))
+        {
+            reply_ptr = buffer;
+            reply_size = sizeof(buffer);
+        }
+    }
+
+    SERVER_START_REQ( get_key_value )
+    {
+        req->hkey = wine_server_obj_handle( handle );
+        wine_server_add_data( req, name->Buffer, name->Length );
+        if (reply_size) wine_server_set_reply( req, reply_ptr, reply_size );
+        ret = wine_server_call( req );
+        *type      = reply->type;
+        *total     = reply->total;
+        gen_slot   = reply->gen_slot;
+        generation = reply->generation;
+    }
+    SERVER_END_REQ;
+
+    if (reply_ptr == buffer && !ret && size) memcpy( data, buffer, min( size, *total ));
+
+    if (cache)
+    {
+        if ((!ret || ret == STATUS_OBJECT_NAME_NOT_FOUND) && *total <= min( reply_size, VALUE_CACHE_MAX_DATA ))
+            add_cached_value( handle, name, closes, ret, *type, *total, reply_ptr, gen_slot, generation );
+        InterlockedDecrement( get_value_cache_refs( handle ));
+    }
+    return ret;
+}
+
 /******************************************************************************
  * NtCreateKey [NTDLL.@]
  * ZwCreateKey [NTDLL.@]
@@ -76,6 +325,7 @@ NTSTATUS WINAPI NtCreateKey( PHANDLE retkey, ACCESS_MASK access, const OBJECT_AT
         if (dispos && !ret) *dispos = reply->created ? REG_CREATED_NEW_KEY : REG_OPENED_EXISTING_KEY;
     }
     SERVER_END_REQ;
+    if (!ret) release_value_cache( *retkey );
 
     TRACE("<- %p\n", *retkey);
     RtlFreeHeap( GetProcessHeap(), 0, objattr );
@@ -140,6 +390,7 @@ static NTSTATUS open_key( PHANDLE retkey, ACCESS_MASK access, const OBJECT_ATTRI
         *retkey = wine_server_ptr_handle( reply->hkey );
     }
     SERVER_END_REQ;
+    if (!ret) release_value_cache( *retkey );
     TRACE("<- %p\n", *retkey);
     return ret;
 }
@@ -537,6 +788,8 @@ NTSTATUS WINAPI DECLSPEC_HOTPATCH NtQueryValueKey( HANDLE handle, const UNICODE_
     NTSTATUS ret;
     UCHAR *data_ptr;
     unsigned int fixed_size, min_size;
+    data_size_t data_size, total;
+    int type;
 
     TRACE( "(%p,%s,%d,%p,%d)\n", handle, debugstr_us(name), info_class, info, length );
 
@@ -574,21 +827,17 @@ NTSTATUS WINAPI DECLSPEC_HOTPATCH NtQueryValueKey( HANDLE handle, const UNICODE_
         return STATUS_INVALID_PARAMETER;
     }
 
-    SERVER_START_REQ( get_key_value )
+    data_size = (length > fixed_size && data_ptr) ? length - fixed_size : 0;
+    if (!get_cached_value( handle, name, &ret, &type, &total, data_ptr, data_size ))
+        ret = query_value( handle, name, &type, &total, data_ptr, data_size );
+
+    if (!ret)
     {
-        req->hkey = wine_server_obj_handle( handle );
-        wine_server_add_data( req, name->Buffer, name->Length );
-        if (length > fixed_size && data_ptr) wine_server_set_reply( req, data_ptr, length - fixed_size );
-        if (!(ret = wine_server_call( req )))
-        {
-            copy_key_value_info( info_class, info, length, reply->type,
-                                 name->Length, reply->total );
-            *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : reply->total);
-            if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
-            else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
-        }
+        copy_key_value_info( info_class, info, length, type, name->Length, total );
+        *result_len = fixed_size + (info_class == KeyValueBasicInformation ? 0 : total);
+        if (length < min_size) ret = STATUS_BUFFER_TOO_SMALL;
+        else if (length < *result_len) ret = STATUS_BUFFER_OVERFLOW;
     }
-    SERVER_END_REQ;
     return ret;
 }
 
@@ -981,6 +981,34 @@ done:
 }
 
 
+/***********************************************************************
+ *           server_get_completion_fd
+ *
+ * Retrieve the fd of the shared queue of a completion port. The returned
+ * fd must be closed by the caller.
+ */
+int server_get_completion_fd( HANDLE handle )
+{
+    sigset_t sigset;
+    obj_handle_t fd_handle;
+    int fd = -1;
+
+    server_enter_uninterrupted_section( &fd_cache_section, &sigset );
+    SERVER_START_REQ( get_completion_shm )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        if (!wine_server_call( req ))
+        {
+            fd = receive_fd( &fd_handle );
+            assert( wine_server_ptr_handle(fd_handle) == handle );
+        }
+    }
+    SERVER_END_REQ;
+    server_leave_uninterrupted_section( &fd_cache_section, &sigset );
+    return fd;
+}
+
+
 /***********************************************************************
  *           wine_server_fd_to_handle   (NTDLL.@)
  *
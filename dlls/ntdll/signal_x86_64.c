@@ -334,12 +334,13 @@ static inline struct amd64_thread_data *amd64_thread_data(void)
 
 struct dynamic_unwind_entry
 {
-    struct list entry;
-
     /* memory region which matches this entry */
     DWORD64 base;
     DWORD64 end;
 
+    /* highest end address of this entry and all entries sorted before it */
+    DWORD64 max_end;
+
     /* lookup table */
     RUNTIME_FUNCTION *table;
     DWORD count;
@@ -348,18 +349,114 @@ struct dynamic_unwind_entry
     /* user defined callback */
     PGET_RUNTIME_FUNCTION_CALLBACK callback;
     PVOID context;
+
+    /* registration order, the first registered entry wins when ranges overlap */
+    ULONG64 serial;
+
+    /* one reference for the index, plus one for each callback in progress */
+    LONG refcount;
 };
 
-static struct list dynamic_unwind_list = LIST_INIT(dynamic_unwind_list);
+/* entries sorted by base address, so that lookups can use a binary search;
+ * unwinding threads only take the lock shared and don't block each other */
+static struct dynamic_unwind_entry **dynamic_unwind_index;
+static unsigned int dynamic_unwind_count, dynamic_unwind_size;
+static ULONG64 dynamic_unwind_serial;
+static RTL_SRWLOCK dynamic_unwind_lock = RTL_SRWLOCK_INIT;
 
-static RTL_CRITICAL_SECTION dynamic_unwind_section;
-static RTL_CRITICAL_SECTION_DEBUG dynamic_unwind_debug =
+static void update_dynamic_unwind_max_end( unsigned int pos )
 {
-    0, 0, &dynamic_unwind_section,
-    { &dynamic_unwind_debug.ProcessLocksList, &dynamic_unwind_debug.ProcessLocksList },
-      0, 0, { (DWORD_PTR)(__FILE__ ": dynamic_unwind_section") }
-};
-static RTL_CRITICAL_SECTION dynamic_unwind_section = { &dynamic_unwind_debug, -1, 0, 0, 0, 0 };
+    DWORD64 max_end = pos ? dynamic_unwind_index[pos - 1]->max_end : 0;
+
+    for (; pos < dynamic_unwind_count; pos++)
+    {
+        max_end = max( max_end, dynamic_unwind_index[pos]->end );
+        dynamic_unwind_index[pos]->max_end = max_end;
+    }
+}
+
+/* must be called with dynamic_unwind_lock held exclusively */
+static BOOL add_dynamic_unwind_entry( struct dynamic_unwind_entry *entry )
+{
+    unsigned int pos;
+
+    if (dynamic_unwind_count == dynamic_unwind_size)
+    {
+        unsigned int new_size = max( 16, dynamic_unwind_size * 2 );
+        struct dynamic_unwind_entry **new_index;
+
+        if (dynamic_unwind_index)
+            new_index = RtlReAllocateHeap( GetProcessHeap(), 0, dynamic_unwind_index,
+                                           new_size * sizeof(*new_index) );
+        else
+            new_index = RtlAllocateHeap( GetProcessHeap(), 0, new_size * sizeof(*new_index) );
+        if (!new_index) return FALSE;
+        dynamic_unwind_index = new_index;
+        dynamic_unwind_size = new_size;
+    }
+
+    for (pos = dynamic_unwind_count; pos && dynamic_unwind_index[pos - 1]->base > entry->base; pos--)
+        dynamic_unwind_index[pos] = dynamic_unwind_index[pos - 1];
+    dynamic_unwind_index[pos] = entry;
+    dynamic_unwind_count++;
+    entry->serial = dynamic_unwind_serial++;
+    entry->refcount = 1;
+    update_dynamic_unwind_max_end( pos );
+    return TRUE;
+}
+
+/* must be called with dynamic_unwind_lock held exclusively */
+static void remove_dynamic_unwind_entry( unsigned int pos )
+{
+    dynamic_unwind_count--;
+    memmove( &dynamic_unwind_index[pos], &dynamic_unwind_index[pos + 1],
+             (dynamic_unwind_count - pos) * sizeof(*dynamic_unwind_index) );
+    update_dynamic_unwind_max_end( pos );
+}
+
+/* must be called with dynamic_unwind_lock held */
+static struct dynamic_unwind_entry *find_dynamic_unwind_entry( ULONG64 pc )
+{
+    struct dynamic_unwind_entry *entry, *found = NULL;
+    int min = 0, max = dynamic_unwind_count - 1, pos = -1;
+
+    /* find the last entry starting at or before pc */
+    while (min <= max)
+    {
+        int mid = (min + max) / 2;
+        if (dynamic_unwind_index[mid]->base <= pc)
+        {
+            pos = mid;
+            min = mid + 1;
+        }
+        else max = mid - 1;
+    }
+
+    /* ranges may overlap, walk back as long as an earlier entry can still contain pc */
+    for (; pos >= 0 && dynamic_unwind_index[pos]->max_end > pc; pos--)
+    {
+        entry = dynamic_unwind_index[pos];
+        if (pc < entry->end && (!found || entry->serial < found->serial)) found = entry;
+    }
+    return found;
+}
+
+static void release_dynamic_unwind_entry( struct dynamic_unwind_entry *entry )
+{
+    if (!InterlockedDecrement( &entry->refcount )) RtlFreeHeap( GetProcessHeap(), 0, entry );
+}
+
+static BOOL register_dynamic_unwind_entry( struct dynamic_unwind_entry *entry )
+{
+    BOOL ret;
+
+    RtlAcquireSRWLockExclusive( &dynamic_unwind_lock );
+    ret = add_dynamic_unwind_entry( entry );
+    RtlReleaseSRWLockExclusive( &dynamic_unwind_lock );
+
+    if (!ret) RtlFreeHeap( GetProcessHeap(), 0, entry );
+    return ret;
+}
 
 /***********************************************************************
  * Definitions for Win32 unwind tables
@@ -2540,8 +2637,9 @@ static RUNTIME_FUNCTION *find_function_info( ULONG64 pc, HMODULE module,
  */
 static RUNTIME_FUNCTION *lookup_function_info( ULONG64 pc, ULONG64 *base, LDR_MODULE **module )
 {
-    RUNTIME_FUNCTION *func = NULL;
-    struct dynamic_unwind_entry *entry;
+    RUNTIME_FUNCTION *func = NULL, *table = NULL;
+    struct dynamic_unwind_entry *entry, *callback_entry = NULL;
+    DWORD count = 0;
     ULONG size;
 
     /* PE module or wine module */
@@ -2559,22 +2657,36 @@ static RUNTIME_FUNCTION *lookup_function_info( ULONG64 pc, ULONG64 *base, LDR_MO
     {
         *module = NULL;
 
-        RtlEnterCriticalSection( &dynamic_unwind_section );
-        LIST_FOR_EACH_ENTRY( entry, &dynamic_unwind_list, struct dynamic_unwind_entry, entry )
+        RtlAcquireSRWLockShared( &dynamic_unwind_lock );
+        if ((entry = find_dynamic_unwind_entry( pc )))
         {
-            if (pc >= entry->base && pc < entry->end)
-            {
-                *base = entry->base;
+            *base = entry->base;
 
-                /* use callback or lookup in function table */
-                if (entry->callback)
-                    func = entry->callback( pc, entry->context );
-                else
-                    func = find_function_info( pc, (HMODULE)entry->base, entry->table, entry->count );
-                break;
+            /* use callback or lookup in function table */
+            if (entry->callback)
+            {
+                InterlockedIncrement( &entry->refcount );
+                callback_entry = entry;
+            }
+            else
+            {
+                table = entry->table;
+                count = entry->count;
             }
         }
-        RtlLeaveCriticalSection( &dynamic_unwind_section );
+        RtlReleaseSRWLockShared( &dynamic_unwind_lock );
+
+        /* the lock isn't recursive, so it's not held while running the callback or reading the
+         * table: both belong to the application, which may register or delete tables from there,
+         * or fault and end up here again; the reference keeps the entry alive if it gets deleted
+         * meanwhile */
+        if (callback_entry)
+        {
+            func = callback_entry->callback( pc, callback_entry->context );
+            release_dynamic_unwind_entry( callback_entry );
+        }
+        else if (table)
+            func = find_function_info( pc, (HMODULE)*base, table, count );
     }
 
     return func;
@@ -3468,11 +3580,7 @@ BOOLEAN CDECL RtlAddFunctionTable( RUNTIME_FUNCTION *table, DWORD count, DWORD64
     entry->callback  = NULL;
     entry->context   = NULL;
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    list_add_tail( &dynamic_unwind_list, &entry->entry );
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
-
-    return TRUE;
+    return register_dynamic_unwind_entry( entry );
 }
 
 
@@ -3504,11 +3612,7 @@ BOOLEAN CDECL RtlInstallFunctionTableCallback( DWORD64 table, DWORD64 base, DWOR
     entry->callback  = callback;
     entry->context   = context;
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    list_add_tail( &dynamic_unwind_list, &entry->entry );
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
-
-    return TRUE;
+    return register_dynamic_unwind_entry( entry );
 }
 
 
@@ -3534,9 +3638,8 @@ DWORD WINAPI RtlAddGrowableFunctionTable( void **table, RUNTIME_FUNCTION *functi
     entry->callback  = NULL;
     entry->context   = NULL;
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    list_add_tail( &dynamic_unwind_list, &entry->entry );
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
+    if (!register_dynamic_unwind_entry( entry ))
+        return STATUS_NO_MEMORY;
 
     *table = entry;
 
@@ -3550,12 +3653,14 @@ DWORD WINAPI RtlAddGrowableFunctionTable( void **table, RUNTIME_FUNCTION *functi
 void WINAPI RtlGrowFunctionTable( void *table, DWORD count )
 {
     struct dynamic_unwind_entry *entry;
+    unsigned int i;
 
     TRACE( "%p, %u\n", table, count );
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    LIST_FOR_EACH_ENTRY( entry, &dynamic_unwind_list, struct dynamic_unwind_entry, entry )
+    RtlAcquireSRWLockExclusive( &dynamic_unwind_lock );
+    for (i = 0; i < dynamic_unwind_count; i++)
     {
+        entry = dynamic_unwind_index[i];
         if (entry == table)
         {
             if (count > entry->count && count <= entry->max_count)
@@ -3563,7 +3668,7 @@ void WINAPI RtlGrowFunctionTable( void *table, DWORD count )
             break;
         }
     }
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
+    RtlReleaseSRWLockExclusive( &dynamic_unwind_lock );
 }
 
 
@@ -3573,22 +3678,24 @@ void WINAPI RtlGrowFunctionTable( void *table, DWORD count )
 void WINAPI RtlDeleteGrowableFunctionTable( void *table )
 {
     struct dynamic_unwind_entry *entry, *to_free = NULL;
+    unsigned int i;
 
     TRACE( "%p\n", table );
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    LIST_FOR_EACH_ENTRY( entry, &dynamic_unwind_list, struct dynamic_unwind_entry, entry )
+    RtlAcquireSRWLockExclusive( &dynamic_unwind_lock );
+    for (i = 0; i < dynamic_unwind_count; i++)
     {
+        entry = dynamic_unwind_index[i];
         if (entry == table)
         {
             to_free = entry;
-            list_remove( &entry->entry );
+            remove_dynamic_unwind_entry( i );
             break;
         }
     }
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
+    RtlReleaseSRWLockExclusive( &dynamic_unwind_lock );
 
-    RtlFreeHeap( GetProcessHeap(), 0, to_free );
+    if (to_free) release_dynamic_unwind_entry( to_free );
 }
 
 
@@ -3598,25 +3705,28 @@ void WINAPI RtlDeleteGrowableFunctionTable( void *table )
 BOOLEAN CDECL RtlDeleteFunctionTable( RUNTIME_FUNCTION *table )
 {
     struct dynamic_unwind_entry *entry, *to_free = NULL;
+    unsigned int i, pos = 0;
 
     TRACE( "%p\n", table );
 
-    RtlEnterCriticalSection( &dynamic_unwind_section );
-    LIST_FOR_EACH_ENTRY( entry, &dynamic_unwind_list, struct dynamic_unwind_entry, entry )
+    RtlAcquireSRWLockExclusive( &dynamic_unwind_lock );
+    /* delete the first registered entry for that table */
+    for (i = 0; i < dynamic_unwind_count; i++)
     {
-        if (entry->table == table)
+        entry = dynamic_unwind_index[i];
+        if (entry->table == table && (!to_free || entry->serial < to_free->serial))
         {
             to_free = entry;
-            list_remove( &entry->entry );
-            break;
+            pos = i;
         }
     }
-    RtlLeaveCriticalSection( &dynamic_unwind_section );
+    if (to_free) remove_dynamic_unwind_entry( pos );
+    RtlReleaseSRWLockExclusive( &dynamic_unwind_lock );
 
     if (!to_free)
         return FALSE;
 
-    RtlFreeHeap( GetProcessHeap(), 0, to_free );
+    release_dynamic_unwind_entry( to_free );
     return TRUE;
 }
 
@@ -46,6 +46,9 @@
 #ifdef HAVE_SCHED_H
 # include <sched.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -1300,7 +1303,10 @@ NTSTATUS WINAPI NtCreateIoCompletion( PHANDLE CompletionPort, ACCESS_MASK Desire
         req->concurrent = NumberOfConcurrentThreads;
         wine_server_add_data( req, objattr, len );
         if (!(status = wine_server_call( req )))
+        {
             *CompletionPort = wine_server_ptr_handle( reply->handle );
+            release_completion_shm( *CompletionPort );
+        }
     }
     SERVER_END_REQ;
 
@@ -1308,6 +1314,204 @@ NTSTATUS WINAPI NtCreateIoCompletion( PHANDLE CompletionPort, ACCESS_MASK Desire
     return status;
 }
 
+/* Completion ports have a queue shared with the server, so that messages
+ * posted and removed by clients don't need a server round trip. The server
+ * is only involved for blocking waits, and when the shared queue is full. */
+
+/* a mapping of the shared queue, kept alive by the cache and by the threads using it */
+struct completion_map
+{
+    struct completion_shm *shm;
+    LONG                   refcount;
+};
+
+#define COMPLETION_CACHE_BLOCK_SIZE  (65536 / sizeof(struct completion_map *))
+#define COMPLETION_CACHE_ENTRIES     128
+#define COMPLETION_MAP_NONE          ((struct completion_map *)~(ULONG_PTR)0)
+
+static struct completion_map **completion_cache[COMPLETION_CACHE_ENTRIES];
+/* held shared to reference a cached mapping, exclusive to change the cache */
+static RTL_SRWLOCK completion_cache_lock = RTL_SRWLOCK_INIT;
+
+static inline unsigned int completion_handle_to_index( HANDLE handle, unsigned int *entry )
+{
+    unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
+    *entry = idx / COMPLETION_CACHE_BLOCK_SIZE;
+    return idx % COMPLETION_CACHE_BLOCK_SIZE;
+}
+
+static void release_completion_map( struct completion_map *map )
+{
+    if (map && interlocked_xchg_add( &map->refcount, -1 ) == 1)
+    {
+        munmap( map->shm, sizeof(*map->shm) );
+        RtlFreeHeap( GetProcessHeap(), 0, map );
+    }
+}
+
+/* get a reference to the shared queue of a completion port, mapping it on first use */
+static struct completion_map *get_completion_map( HANDLE handle )
+{
+    unsigned int entry, idx = completion_handle_to_index( handle, &entry );
+    struct completion_map *map, *cached;
+    int fd;
+
+    if (entry >= COMPLETION_CACHE_ENTRIES) return NULL;
+
+    if (!completion_cache[entry])
+    {
+        struct completion_map **block = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                                         COMPLETION_CACHE_BLOCK_SIZE * sizeof(*block) );
+        if (!block) return NULL;
+        if (interlocked_cmpxchg_ptr( (void **)&completion_cache[entry], block, NULL ))
+            RtlFreeHeap( GetProcessHeap(), 0, block );
+    }
+
+    RtlAcquireSRWLockShared( &completion_cache_lock );
+    if ((map = completion_cache[entry][idx]) && map != COMPLETION_MAP_NONE)
+        interlocked_xchg_add( &map->refcount, 1 );
+    RtlReleaseSRWLockShared( &completion_cache_lock );
+    if (map) return map == COMPLETION_MAP_NONE ? NULL : map;
+
+    map = COMPLETION_MAP_NONE;
+    if ((fd = server_get_completion_fd( handle )) != -1)
+    {
+        void *ptr = mmap( NULL, sizeof(struct completion_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if (ptr != MAP_FAILED)
+        {
+            if ((map = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*map) )))
+            {
+                map->shm = ptr;
+                map->refcount = 2;  /* one for the cache, one for the caller */
+            }
+            else
+            {
+                munmap( ptr, sizeof(struct completion_shm) );
+                map = COMPLETION_MAP_NONE;
+            }
+        }
+        close( fd );
+    }
+
+    RtlAcquireSRWLockExclusive( &completion_cache_lock );
+    if ((cached = completion_cache[entry][idx]))
+    {
+        if (cached != COMPLETION_MAP_NONE) interlocked_xchg_add( &cached->refcount, 1 );
+    }
+    else completion_cache[entry][idx] = map;
+    RtlReleaseSRWLockExclusive( &completion_cache_lock );
+
+    if (cached)
+    {
+        if (map != COMPLETION_MAP_NONE)
+        {
+            munmap( map->shm, sizeof(*map->shm) );
+            RtlFreeHeap( GetProcessHeap(), 0, map );
+        }
+        map = cached;
+    }
+    return map == COMPLETION_MAP_NONE ? NULL : map;
+}
+
+/***********************************************************************
+ *           release_completion_shm
+ *
+ * Drop the cached shared queue of a handle that was closed or (re)created.
+ * The queue stays mapped until the threads still using it are done.
+ */
+void release_completion_shm( HANDLE handle )
+{
+    unsigned int entry, idx = completion_handle_to_index( handle, &entry );
+    struct completion_map *map;
+
+    if (entry >= COMPLETION_CACHE_ENTRIES || !completion_cache[entry]) return;
+
+    RtlAcquireSRWLockExclusive( &completion_cache_lock );
+    map = completion_cache[entry][idx];
+    completion_cache[entry][idx] = NULL;
+    RtlReleaseSRWLockExclusive( &completion_cache_lock );
+
+    if (map != COMPLETION_MAP_NONE) release_completion_map( map );
+}
+
+static inline struct completion_shm_entry *completion_shm_entry( struct completion_shm *shm, int pos )
+{
+    return &shm->entries[((unsigned int)pos / 2) % COMPLETION_SHM_ENTRIES];
+}
+
+static inline BOOL completion_shm_closed( struct completion_shm *shm )
+{
+    return *(volatile int *)&shm->tail & COMPLETION_SHM_CLOSED;
+}
+
+/* add a message to the shared queue; same algorithm as in the server */
+static BOOL completion_shm_push( struct completion_shm *shm, ULONG_PTR key, ULONG_PTR value,
+                                 NTSTATUS status, SIZE_T information )
+{
+    struct completion_shm_entry *entry;
+    int pos = *(volatile int *)&shm->tail, prev, diff;
+
+    for (;;)
+    {
+        /* the server holds older messages, the new one has to go after them */
+        if (pos & COMPLETION_SHM_CLOSED) return FALSE;
+        entry = completion_shm_entry( shm, pos );
+        diff = *(volatile int *)&entry->seq - pos;
+        if (diff < 0) return FALSE;  /* queue is full */
+        if (!diff)
+        {
+            if ((prev = interlocked_cmpxchg( &shm->tail, pos + 2, pos )) == pos) break;
+            pos = prev;
+        }
+        else pos = *(volatile int *)&shm->tail;
+    }
+    entry->ckey        = key;
+    entry->cvalue      = value;
+    entry->status      = status;
+    entry->information = information;
+    interlocked_xchg( &entry->seq, pos + 2 );
+    return TRUE;
+}
+
+/* remove a message from the shared queue */
+static BOOL completion_shm_pop( struct completion_shm *shm, ULONG_PTR *key, ULONG_PTR *value,
+                                IO_STATUS_BLOCK *iosb )
+{
+    struct completion_shm_entry *entry;
+    int pos = *(volatile int *)&shm->head, prev, diff;
+
+    for (;;)
+    {
+        entry = completion_shm_entry( shm, pos );
+        diff = *(volatile int *)&entry->seq - (pos + 2);
+        if (diff < 0) return FALSE;  /* queue is empty */
+        if (!diff)
+        {
+            if ((prev = interlocked_cmpxchg( &shm->head, pos + 2, pos )) == pos) break;
+            pos = prev;
+        }
+        else pos = *(volatile int *)&shm->head;
+    }
+    *key              = entry->ckey;
+    *value            = entry->cvalue;
+    iosb->Information = entry->information;
+    iosb->u.Status    = entry->status;
+    interlocked_xchg( &entry->seq, pos + 2 * COMPLETION_SHM_ENTRIES );
+    return TRUE;
+}
+
+/* wait for the port to be signaled, telling producers that they need to wake us up */
+static NTSTATUS wait_completion( HANDLE port, struct completion_shm *shm, BOOLEAN alertable,
+                                 const LARGE_INTEGER *timeout )
+{
+    NTSTATUS status;
+
+    if (shm) interlocked_xchg_add( &shm->waiters, 1 );
+    status = NtWaitForSingleObject( port, alertable, timeout );
+    if (shm) interlocked_xchg_add( &shm->waiters, -1 );
+    return status;
+}
+
 /******************************************************************
  *              NtSetIoCompletion (NTDLL.@)
  *              ZwSetIoCompletion (NTDLL.@)
@@ -1325,11 +1529,32 @@ NTSTATUS WINAPI NtSetIoCompletion( HANDLE CompletionPort, ULONG_PTR CompletionKe
                                    ULONG_PTR CompletionValue, NTSTATUS Status,
                                    SIZE_T NumberOfBytesTransferred )
 {
+    struct completion_map *map;
     NTSTATUS status;
 
     TRACE("(%p, %lx, %lx, %x, %lx)\n", CompletionPort, CompletionKey,
           CompletionValue, Status, NumberOfBytesTransferred);
 
+    if ((map = get_completion_map( CompletionPort )))
+    {
+        if (completion_shm_push( map->shm, CompletionKey, CompletionValue, Status, NumberOfBytesTransferred ))
+        {
+            status = STATUS_SUCCESS;
+            if (*(volatile int *)&map->shm->waiters)
+            {
+                SERVER_START_REQ( wake_completion )
+                {
+                    req->handle = wine_server_obj_handle( CompletionPort );
+                    status = wine_server_call( req );
+                }
+                SERVER_END_REQ;
+            }
+            release_completion_map( map );
+            return status;
+        }
+        release_completion_map( map );
+    }
+
     SERVER_START_REQ( add_completion )
     {
         req->handle      = wine_server_obj_handle( CompletionPort );
@@ -1361,30 +1586,45 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
                                       PULONG_PTR CompletionValue, PIO_STATUS_BLOCK iosb,
                                       PLARGE_INTEGER WaitTime )
 {
+    struct completion_map *map;
+    struct completion_shm *shm;
     NTSTATUS status;
 
     TRACE("(%p, %p, %p, %p, %p)\n", CompletionPort, CompletionKey,
           CompletionValue, iosb, WaitTime);
 
+    map = get_completion_map( CompletionPort );
+    shm = map ? map->shm : NULL;
+
     for(;;)
     {
-        SERVER_START_REQ( remove_completion )
+        if (shm && completion_shm_pop( shm, CompletionKey, CompletionValue, iosb ))
         {
-            req->handle = wine_server_obj_handle( CompletionPort );
-            if (!(status = wine_server_call( req )))
+            status = STATUS_SUCCESS;
+            break;
+        }
+
+        if (!shm || completion_shm_closed( shm ))
+        {
+            SERVER_START_REQ( remove_completion )
             {
-                *CompletionKey    = reply->ckey;
-                *CompletionValue  = reply->cvalue;
-                iosb->Information = reply->information;
-                iosb->u.Status    = reply->status;
+                req->handle = wine_server_obj_handle( CompletionPort );
+                if (!(status = wine_server_call( req )))
+                {
+                    *CompletionKey    = reply->ckey;
+                    *CompletionValue  = reply->cvalue;
+                    iosb->Information = reply->information;
+                    iosb->u.Status    = reply->status;
+                }
             }
+            SERVER_END_REQ;
+            if (status != STATUS_PENDING) break;
         }
-        SERVER_END_REQ;
-        if (status != STATUS_PENDING) break;
 
-        status = NtWaitForSingleObject( CompletionPort, FALSE, WaitTime );
+        status = wait_completion( CompletionPort, shm, FALSE, WaitTime );
         if (status != WAIT_OBJECT_0) break;
     }
+    release_completion_map( map );
     return status;
 }
 
@@ -1395,15 +1635,35 @@ NTSTATUS WINAPI NtRemoveIoCompletion( HANDLE CompletionPort, PULONG_PTR Completi
 NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMATION *info, ULONG count,
                                         ULONG *written, LARGE_INTEGER *timeout, BOOLEAN alertable )
 {
-    NTSTATUS ret;
+    struct completion_map *map;
+    struct completion_shm *shm;
+    NTSTATUS ret = STATUS_PENDING;
     ULONG i = 0;
 
     TRACE("%p %p %u %p %p %u\n", port, info, count, written, timeout, alertable);
 
+    map = get_completion_map( port );
+    shm = map ? map->shm : NULL;
+
     for (;;)
     {
         while (i < count)
         {
+            if (shm)
+            {
+                if (completion_shm_pop( shm, &info[i].CompletionKey, &info[i].CompletionValue,
+                                        &info[i].IoStatusBlock ))
+                {
+                    ++i;
+                    continue;
+                }
+                if (!completion_shm_closed( shm ))
+                {
+                    ret = STATUS_PENDING;
+                    break;
+                }
+            }
+
             SERVER_START_REQ( remove_completion )
             {
                 req->handle = wine_server_obj_handle( port );
@@ -1429,10 +1689,11 @@ NTSTATUS WINAPI NtRemoveIoCompletionEx( HANDLE port, FILE_IO_COMPLETION_INFORMAT
             break;
         }
 
-        ret = NtWaitForSingleObject( port, alertable, timeout );
+        ret = wait_completion( port, shm, alertable, timeout );
         if (ret != WAIT_OBJECT_0) break;
     }
 
+    release_completion_map( map );
     *written = i ? i : 1;
     return ret;
 }
@@ -1465,6 +1726,7 @@ NTSTATUS WINAPI NtOpenIoCompletion( HANDLE *handle, ACCESS_MASK access, const OB
             wine_server_add_data( req, attr->ObjectName->Buffer, attr->ObjectName->Length );
         status = wine_server_call( req );
         *handle = wine_server_ptr_handle( reply->handle );
+        if (!status) release_completion_shm( *handle );
     }
     SERVER_END_REQ;
     return status;
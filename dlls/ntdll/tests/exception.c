@@ -2080,12 +2080,29 @@ static RUNTIME_FUNCTION* CALLBACK dynamic_unwind_callback( DWORD64 pc, PVOID con
     return &runtime_func;
 }
 
+struct delete_table_context
+{
+    ULONG_PTR table;
+    DWORD count;
+};
+
+static RUNTIME_FUNCTION* CALLBACK delete_table_callback( DWORD64 pc, PVOID context )
+{
+    struct delete_table_context *ctx = context;
+
+    /* the entry being looked up goes away while its callback runs */
+    ok( pRtlDeleteFunctionTable( (PRUNTIME_FUNCTION)ctx->table ),
+        "RtlDeleteFunctionTable failed for table = %p\n", (PVOID)ctx->table );
+    return dynamic_unwind_callback( pc, &ctx->count );
+}
+
 static void test_dynamic_unwind(void)
 {
     static const int code_offset = 1024;
     char buf[2 * sizeof(RUNTIME_FUNCTION) + 4];
-    RUNTIME_FUNCTION *runtime_func, *func;
+    RUNTIME_FUNCTION *runtime_func, *func, overlap_func;
     ULONG_PTR table, base;
+    struct delete_table_context delete_context;
     void *growable_table;
     NTSTATUS status;
     DWORD count;
@@ -2192,6 +2209,65 @@ static void test_dynamic_unwind(void)
     ok( !pRtlDeleteFunctionTable( (PRUNTIME_FUNCTION)table ),
         "RtlDeleteFunctionTable returned success for nonexistent table = %p\n", (PVOID)table );
 
+    /* Overlapping tables, the first registered one is used */
+    runtime_func = (RUNTIME_FUNCTION *)buf;
+    runtime_func->BeginAddress = code_offset;
+    runtime_func->EndAddress   = code_offset + 16;
+    runtime_func->UnwindData   = 0;
+    ok( pRtlAddFunctionTable( runtime_func, 1, (ULONG_PTR)code_mem ),
+        "RtlAddFunctionTable failed for runtime_func = %p\n", runtime_func );
+    overlap_func.BeginAddress = code_offset - 8;
+    overlap_func.EndAddress   = code_offset + 8;
+    overlap_func.UnwindData   = 0;
+    ok( pRtlAddFunctionTable( &overlap_func, 1, (ULONG_PTR)code_mem + 8 ),
+        "RtlAddFunctionTable failed for overlap_func = %p\n", &overlap_func );
+
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 4, &base, NULL );
+    ok( func == runtime_func,
+        "RtlLookupFunctionEntry didn't return expected function, expected: %p, got: %p\n", runtime_func, func );
+    ok( base == (ULONG_PTR)code_mem,
+        "RtlLookupFunctionEntry returned invalid base, expected: %lx, got: %lx\n", (ULONG_PTR)code_mem, base );
+
+    ok( pRtlDeleteFunctionTable( runtime_func ),
+        "RtlDeleteFunctionTable failed for runtime_func = %p\n", runtime_func );
+
+    base = 0xdeadbeef;
+    func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 4, &base, NULL );
+    ok( func == &overlap_func,
+        "RtlLookupFunctionEntry didn't return expected function, expected: %p, got: %p\n", &overlap_func, func );
+    ok( base == (ULONG_PTR)code_mem + 8,
+        "RtlLookupFunctionEntry returned invalid base, expected: %lx, got: %lx\n", (ULONG_PTR)code_mem + 8, base );
+
+    ok( pRtlDeleteFunctionTable( &overlap_func ),
+        "RtlDeleteFunctionTable failed for overlap_func = %p\n", &overlap_func );
+
+    /* Delete the table from its own callback. Windows may hold its table lock while
+     * calling it, which would block forever, so this only checks Wine. */
+    if (!strcmp( winetest_platform, "wine" ))
+    {
+        table = (ULONG_PTR)code_mem | 0x3;
+        delete_context.table = table;
+        delete_context.count = 0;
+        ok( pRtlInstallFunctionTableCallback( table, (ULONG_PTR)code_mem, code_offset + 32, &delete_table_callback,
+                                              &delete_context, NULL ),
+            "RtlInstallFunctionTableCallback failed for table = %lx\n", table );
+
+        base = 0xdeadbeef;
+        func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 24, &base, NULL );
+        ok( func != NULL && func->BeginAddress == code_offset + 16 && func->EndAddress == code_offset + 32,
+            "RtlLookupFunctionEntry didn't return expected function, got: %p\n", func );
+        ok( delete_context.count == 1,
+            "RtlLookupFunctionEntry issued %d calls to delete_table_callback, expected: 1\n", delete_context.count );
+        ok( !pRtlDeleteFunctionTable( (PRUNTIME_FUNCTION)table ),
+            "RtlDeleteFunctionTable returned success for nonexistent table = %p\n", (PVOID)table );
+
+        func = pRtlLookupFunctionEntry( (ULONG_PTR)code_mem + code_offset + 24, &base, NULL );
+        ok( func == NULL,
+            "RtlLookupFunctionEntry returned unexpected function, expected: NULL, got: %p\n", func );
+    }
+    else skip( "not deleting a function table from its own callback\n" );
+
     if (!pRtlAddGrowableFunctionTable)
     {
         win_skip("Growable function tables are not supported.\n");
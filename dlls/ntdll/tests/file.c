@@ -1054,6 +1054,149 @@ static void test_set_io_completion(void)
     pNtClose( h );
 }
 
+static void test_io_completion_order(void)
+{
+    LARGE_INTEGER timeout = {{0}};
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    NTSTATUS res;
+    ULONG count, i;
+    HANDLE h;
+
+    res = pNtCreateIoCompletion( &h, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( res == STATUS_SUCCESS, "NtCreateIoCompletion failed: %#x\n", res );
+
+    /* post more messages than fit in Wine's shared queue */
+    for (i = 0; i < 3000; i++)
+    {
+        res = pNtSetIoCompletion( h, i, i * 2, STATUS_SUCCESS, i + 1 );
+        if (res) break;
+    }
+    ok( res == STATUS_SUCCESS, "NtSetIoCompletion %u failed: %#x\n", i, res );
+
+    count = get_pending_msgs( h );
+    ok( count == 3000, "Unexpected msg count: %u\n", count );
+
+    for (i = 0; i < 3000; i++)
+    {
+        res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+        if (res || key != i || value != i * 2 || iosb.Information != i + 1) break;
+    }
+    ok( i == 3000, "message %u: got %#x key %lu value %lu info %lu\n", i, res, key, value, iosb.Information );
+
+    res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+    ok( res == STATUS_TIMEOUT, "NtRemoveIoCompletion failed: %#x\n", res );
+
+    pNtClose( h );
+}
+
+static DWORD WINAPI remove_completion_thread( void *arg )
+{
+    LARGE_INTEGER timeout;
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+
+    timeout.QuadPart = -1000 * 10000;
+    return pNtRemoveIoCompletion( arg, &key, &value, &iosb, &timeout );
+}
+
+static void test_io_completion_close(void)
+{
+    LARGE_INTEGER timeout = {{0}};
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    HANDLE h, thread;
+    NTSTATUS res;
+    DWORD ret;
+    ULONG count;
+
+    res = pNtCreateIoCompletion( &h, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( res == STATUS_SUCCESS, "NtCreateIoCompletion failed: %#x\n", res );
+
+    /* closing the port while a thread waits on it must not pull the queue from under it */
+    thread = CreateThread( NULL, 0, remove_completion_thread, h, 0, NULL );
+    Sleep( 100 );
+    pNtClose( h );
+    ret = WaitForSingleObject( thread, 5000 );
+    ok( ret == WAIT_OBJECT_0, "thread didn't finish: %u\n", ret );
+    GetExitCodeThread( thread, &ret );
+    todo_wine ok( ret == STATUS_ABANDONED_WAIT_0, "NtRemoveIoCompletion returned %#x\n", ret );
+    CloseHandle( thread );
+
+    /* a new port may get the same handle value */
+    res = pNtCreateIoCompletion( &h, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( res == STATUS_SUCCESS, "NtCreateIoCompletion failed: %#x\n", res );
+    res = pNtSetIoCompletion( h, 1, 2, STATUS_SUCCESS, 3 );
+    ok( res == STATUS_SUCCESS, "NtSetIoCompletion failed: %#x\n", res );
+    count = get_pending_msgs( h );
+    ok( count == 1, "Unexpected msg count: %u\n", count );
+    res = pNtRemoveIoCompletion( h, &key, &value, &iosb, &timeout );
+    ok( res == STATUS_SUCCESS, "NtRemoveIoCompletion failed: %#x\n", res );
+    ok( key == 1 && value == 2 && iosb.Information == 3, "got key %lu value %lu info %lu\n",
+        key, value, iosb.Information );
+    pNtClose( h );
+}
+
+struct completion_pingpong
+{
+    HANDLE ping, pong;
+    ULONG count;
+};
+
+static DWORD WINAPI completion_pong_thread( void *arg )
+{
+    struct completion_pingpong *pp = arg;
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    ULONG i;
+
+    for (i = 0; i < pp->count; i++)
+    {
+        if (pNtRemoveIoCompletion( pp->ping, &key, &value, &iosb, NULL )) break;
+        if (pNtSetIoCompletion( pp->pong, key, value, STATUS_SUCCESS, 0 )) break;
+    }
+    return i;
+}
+
+/* round trips between two threads through a pair of ports; the rate is traced */
+static void test_io_completion_pingpong(void)
+{
+    struct completion_pingpong pp;
+    LARGE_INTEGER freq, start, end;
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    NTSTATUS res = 0;
+    HANDLE thread;
+    DWORD ret;
+    ULONG i;
+
+    pp.count = winetest_interactive ? 200000 : 2000;
+    pNtCreateIoCompletion( &pp.ping, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    pNtCreateIoCompletion( &pp.pong, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    thread = CreateThread( NULL, 0, completion_pong_thread, &pp, 0, NULL );
+
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &start );
+    for (i = 0; i < pp.count; i++)
+    {
+        if ((res = pNtSetIoCompletion( pp.ping, i, 0, STATUS_SUCCESS, 0 ))) break;
+        if ((res = pNtRemoveIoCompletion( pp.pong, &key, &value, &iosb, NULL ))) break;
+        if (key != i) break;
+    }
+    QueryPerformanceCounter( &end );
+    ok( i == pp.count, "round trip %u: got %#x key %lu\n", i, res, key );
+
+    ret = WaitForSingleObject( thread, 5000 );
+    ok( ret == WAIT_OBJECT_0, "thread didn't finish: %u\n", ret );
+    CloseHandle( thread );
+    pNtClose( pp.ping );
+    pNtClose( pp.pong );
+
+    trace( "%u completion port round trips in %.1f ms, %.0f per second\n", i,
+           (end.QuadPart - start.QuadPart) * 1000.0 / freq.QuadPart,
+           i * (double)freq.QuadPart / max( end.QuadPart - start.QuadPart, 1 ) );
+}
+
 static void test_file_io_completion(void)
 {
     static const char pipe_name[] = "\\\\.\\pipe\\iocompletiontestnamedpipe";
@@ -4881,6 +5024,9 @@ START_TEST(file)
     append_file_test();
     nt_mailslot_test();
     test_set_io_completion();
+    test_io_completion_order();
+    test_io_completion_close();
+    test_io_completion_pingpong();
     test_file_io_completion();
     test_file_basic_information();
     test_file_all_information();
@@ -21,6 +21,7 @@
  * windows.
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "ntdll_test.h"
@@ -113,6 +114,15 @@ static NTSTATUS  (WINAPI *pRtlAbsoluteToSelfRelativeSD)(PSECURITY_DESCRIPTOR,PSE
 static NTSTATUS  (WINAPI *pLdrRegisterDllNotification)(ULONG, PLDR_DLL_NOTIFICATION_FUNCTION, void *, void **);
 static NTSTATUS  (WINAPI *pLdrUnregisterDllNotification)(void *);
 
+/* same layout as struct __wine_debug_channel */
+struct dbg_channel
+{
+    unsigned char flags;
+    char name[15];
+};
+static int (__cdecl *p__wine_dbg_header)(int, struct dbg_channel *, const char *);
+static int (__cdecl *p__wine_dbg_output)(const char *);
+
 static HMODULE hkernel32 = 0;
 static BOOL      (WINAPI *pIsWow64Process)(HANDLE, PBOOL);
 
@@ -183,6 +193,8 @@ static void InitFunctionPtrs(void)
         pRtlAbsoluteToSelfRelativeSD = (void *)GetProcAddress(hntdll, "RtlAbsoluteToSelfRelativeSD");
         pLdrRegisterDllNotification = (void *)GetProcAddress(hntdll, "LdrRegisterDllNotification");
         pLdrUnregisterDllNotification = (void *)GetProcAddress(hntdll, "LdrUnregisterDllNotification");
+        p__wine_dbg_header = (void *)GetProcAddress(hntdll, "__wine_dbg_header");
+        p__wine_dbg_output = (void *)GetProcAddress(hntdll, "__wine_dbg_output");
     }
     hkernel32 = LoadLibraryA("kernel32.dll");
     ok(hkernel32 != 0, "LoadLibrary failed\n");
@@ -3571,10 +3583,89 @@ static void test_LdrRegisterDllNotification(void)
     pLdrUnregisterDllNotification(cookie);
 }
 
+static void dbg_output_speed_child(void)
+{
+    static struct dbg_channel channel = { 0, "rtltest" };
+    LARGE_INTEGER freq, start, end;
+    char buffer[64];
+    int i, count = 100000;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    for (i = 0; i < count; i++)
+    {
+        sprintf(buffer, "line %d of the debug output benchmark\n", i);
+        if (p__wine_dbg_header(3 /* __WINE_DBCL_TRACE */, &channel, __FUNCTION__) == -1) break;
+        p__wine_dbg_output(buffer);
+    }
+    QueryPerformanceCounter(&end);
+    ok(i == count, "trace channel not enabled\n");
+    trace("%s backend: %u lines, %.1f ns per line\n", getenv("WINEDEBUGLOG") ? "binary" : "text", count,
+          (end.QuadPart - start.QuadPart) * 1000000000.0 / freq.QuadPart / count);
+}
+
+static void run_dbg_output_speed_child(const char *argv0, const char *logname)
+{
+    STARTUPINFOA si = { sizeof(si) };
+    PROCESS_INFORMATION pi;
+    char cmdline[MAX_PATH];
+    BOOL ret;
+
+    sprintf(cmdline, "\"%s\" rtl dbg_output_speed", argv0);
+    SetEnvironmentVariableA("WINEDEBUG", "+rtltest");
+    SetEnvironmentVariableA("WINEDEBUGLOG", logname);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    SetEnvironmentVariableA("WINEDEBUGLOG", NULL);
+    SetEnvironmentVariableA("WINEDEBUG", NULL);
+    ok(ret, "CreateProcess failed, error %u\n", GetLastError());
+    if (!ret) return;
+    winetest_wait_child_process(pi.hProcess);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+}
+
+/* compare the cost of a trace line with the text and the binary debug output backends */
+static void test_dbg_output_speed(const char *argv0)
+{
+    WIN32_FIND_DATAA data;
+    HANDLE find;
+
+    if (!p__wine_dbg_header || !p__wine_dbg_output)
+    {
+        win_skip("Not running on Wine\n");
+        return;
+    }
+    if (!winetest_interactive)
+    {
+        skip("the text backend writes the benchmark lines to stderr, only run it interactively\n");
+        return;
+    }
+
+    run_dbg_output_speed_child(argv0, NULL);
+
+    /* the log file is created in the current directory, named after the Unix pid of the child */
+    run_dbg_output_speed_child(argv0, "rtl_dbglog");
+    find = FindFirstFileA("rtl_dbglog.*", &data);
+    ok(find != INVALID_HANDLE_VALUE, "binary log file not found\n");
+    if (find == INVALID_HANDLE_VALUE) return;
+    do DeleteFileA(data.cFileName); while (FindNextFileA(find, &data));
+    FindClose(find);
+}
+
 START_TEST(rtl)
 {
+    char **argv;
+    int argc;
+
     InitFunctionPtrs();
 
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "dbg_output_speed"))
+    {
+        dbg_output_speed_child();
+        return;
+    }
+
     test_RtlCompareMemory();
     test_RtlCompareMemoryUlong();
     test_RtlMoveMemory();
@@ -3611,4 +3702,5 @@ START_TEST(rtl)
     test_LdrEnumerateLoadedModules();
     test_RtlMakeSelfRelativeSD();
     test_LdrRegisterDllNotification();
+    test_dbg_output_speed(argv[0]);
 }
@@ -292,6 +292,7 @@ void abort_thread( int status )
 {
     pthread_sigmask( SIG_BLOCK, &server_block_set, NULL );
     if (interlocked_xchg_add( &nb_threads, -1 ) <= 1) _exit( get_unix_exit_code( status ));
+    debug_exit_thread();
     signal_exit_thread( status );
 }
 
@@ -301,6 +302,7 @@ void abort_thread( int status )
  */
 void exit_thread( int status )
 {
+    debug_exit_thread();
     close( ntdll_get_thread_data()->wait_fd[0] );
     close( ntdll_get_thread_data()->wait_fd[1] );
     close( ntdll_get_thread_data()->reply_fd );
@@ -368,6 +370,8 @@ static void start_thread( struct startup_info *info )
     struct debug_info debug_info;
 
     debug_info.str_pos = debug_info.out_pos = 0;
+    debug_info.log_cls = 0;
+    debug_info.log_chunk = NULL;
     thread_data->debug_info = &debug_info;
     thread_data->pthread_id = pthread_self();
 
@@ -44,6 +44,24 @@
 #ifdef HAVE_SYS_SYSINFO_H
 # include <sys/sysinfo.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
+#ifdef HAVE_SYS_IOCTL_H
+# include <sys/ioctl.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
+#ifdef HAVE_LINUX_FS_H
+# include <linux/fs.h>
+#endif
+#ifdef HAVE_LINUX_USERFAULTFD_H
+# include <linux/userfaultfd.h>
+#endif
 #ifdef HAVE_VALGRIND_VALGRIND_H
 # include <valgrind/valgrind.h>
 #endif
@@ -86,6 +104,7 @@ struct file_view
 #define VPROT_WRITEWATCH 0x40
 /* per-mapping protection flags */
 #define VPROT_SYSTEM     0x0200  /* system view (underlying mmap not under our control) */
+#define VPROT_KERNELWATCH 0x0400 /* write watches are tracked by the kernel */
 
 /* Conversion from VPROT_* to Win32 flags */
 static const BYTE VIRTUAL_Win32Flags[16] =
@@ -926,6 +945,217 @@ static NTSTATUS set_protection( struct file_view *view, void *base, SIZE_T size,
 }
 
 
+#if defined(HAVE_LINUX_USERFAULTFD_H) && defined(__NR_userfaultfd)
+
+/* When the kernel supports asynchronous userfaultfd write protection and the
+ * PAGEMAP_SCAN ioctl (Linux 6.7), it tracks the written pages of write watch
+ * views itself, and writes never fault into user space. */
+
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+#ifndef UFFD_FEATURE_WP_UNPOPULATED
+#define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#endif
+#ifndef UFFD_FEATURE_WP_ASYNC
+#define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#endif
+
+/* PAGEMAP_SCAN is defined by <linux/fs.h> since Linux 6.7. */
+#ifndef PAGEMAP_SCAN
+#define PAGE_IS_WRITTEN       (1 << 1)
+#define PM_SCAN_WP_MATCHING   (1 << 0)
+#define PM_SCAN_CHECK_WPASYNC (1 << 1)
+
+struct page_region
+{
+    ULONGLONG start;
+    ULONGLONG end;
+    ULONGLONG categories;
+};
+
+struct pm_scan_arg
+{
+    ULONGLONG size;
+    ULONGLONG flags;
+    ULONGLONG start;
+    ULONGLONG end;
+    ULONGLONG walk_end;
+    ULONGLONG vec;
+    ULONGLONG vec_len;
+    ULONGLONG max_pages;
+    ULONGLONG category_inverted;
+    ULONGLONG category_mask;
+    ULONGLONG category_anyof_mask;
+    ULONGLONG return_mask;
+};
+
+#define PAGEMAP_SCAN _IOWR( 'f', 16, struct pm_scan_arg )
+#endif
+
+static int uffd = -1;        /* userfaultfd write-protecting the kernel write watch views */
+static int pagemap_fd = -1;  /* /proc/self/pagemap, to query the written pages */
+
+/***********************************************************************
+ *           init_kernel_write_watch
+ *
+ * Check if the kernel can track write watches. Must be called with csVirtual held.
+ */
+static BOOL init_kernel_write_watch(void)
+{
+    static int supported = -1;
+    struct uffdio_api api;
+    struct pm_scan_arg arg;
+    int fd;
+
+    if (supported != -1) return supported;
+    supported = FALSE;
+
+    if ((fd = syscall( __NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY )) == -1 &&
+        (fd = syscall( __NR_userfaultfd, O_CLOEXEC | O_NONBLOCK )) == -1)
+        return FALSE;
+
+    api.api = UFFD_API;
+    api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+    if (ioctl( fd, UFFDIO_API, &api ) == -1) goto failed;
+
+    if ((pagemap_fd = open( "/proc/self/pagemap", O_RDONLY | O_CLOEXEC )) == -1) goto failed;
+    memset( &arg, 0, sizeof(arg) );
+    arg.size = sizeof(arg);
+    if (ioctl( pagemap_fd, PAGEMAP_SCAN, &arg ) == -1)
+    {
+        close( pagemap_fd );
+        pagemap_fd = -1;
+        goto failed;
+    }
+
+    TRACE( "using kernel write watches\n" );
+    uffd = fd;
+    supported = TRUE;
+    return TRUE;
+
+failed:
+    close( fd );
+    return FALSE;
+}
+
+
+/***********************************************************************
+ *           register_kernel_write_watch
+ *
+ * Let the kernel track writes to a range; all its pages start out as not written.
+ */
+static BOOL register_kernel_write_watch( void *base, size_t size )
+{
+    struct uffdio_register reg;
+    struct uffdio_writeprotect wp;
+
+    reg.range.start = (UINT_PTR)base;
+    reg.range.len   = size;
+    reg.mode        = UFFDIO_REGISTER_MODE_WP;
+    if (ioctl( uffd, UFFDIO_REGISTER, &reg ) == -1) return FALSE;
+
+    wp.range = reg.range;
+    wp.mode  = UFFDIO_WRITEPROTECT_MODE_WP;
+    if (ioctl( uffd, UFFDIO_WRITEPROTECT, &wp ) == -1)
+    {
+        ioctl( uffd, UFFDIO_UNREGISTER, &reg.range );
+        return FALSE;
+    }
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           enable_kernel_write_watch
+ *
+ * Switch a newly allocated write watch view to kernel tracking if possible.
+ */
+static void enable_kernel_write_watch( struct file_view *view )
+{
+    if (!init_kernel_write_watch()) return;
+    if (!register_kernel_write_watch( view->base, view->size )) return;
+
+    view->protect |= VPROT_KERNELWATCH;
+    set_page_vprot_bits( view->base, view->size, 0, VPROT_WRITEWATCH );
+    mprotect_range( view->base, view->size, 0, 0 );
+}
+
+
+/***********************************************************************
+ *           reset_kernel_write_watches
+ */
+static void reset_kernel_write_watches( void *base, size_t size )
+{
+    struct uffdio_writeprotect wp;
+
+    wp.range.start = (UINT_PTR)base;
+    wp.range.len   = size;
+    wp.mode        = UFFDIO_WRITEPROTECT_MODE_WP;
+    if (ioctl( uffd, UFFDIO_WRITEPROTECT, &wp ) == -1)
+        ERR( "failed to reset write watches %p-%p: %s\n", base, (char *)base + size, strerror( errno ));
+}
+
+
+/***********************************************************************
+ *           get_kernel_write_watches
+ *
+ * Retrieve the written pages of a range, optionally write-protecting them again.
+ */
+static NTSTATUS get_kernel_write_watches( void *base, size_t size, void **addresses,
+                                          ULONG_PTR *count, BOOL reset )
+{
+    struct page_region regions[64];
+    struct pm_scan_arg arg;
+    ULONG_PTR pos = 0;
+    char *addr, *end;
+    int i, ret;
+
+    memset( &arg, 0, sizeof(arg) );
+    arg.size          = sizeof(arg);
+    arg.flags         = PM_SCAN_CHECK_WPASYNC | (reset ? PM_SCAN_WP_MATCHING : 0);
+    arg.start         = (UINT_PTR)base;
+    arg.end           = (UINT_PTR)base + size;
+    arg.vec           = (UINT_PTR)regions;
+    arg.vec_len       = ARRAY_SIZE( regions );
+    arg.category_mask = PAGE_IS_WRITTEN;
+    arg.return_mask   = PAGE_IS_WRITTEN;
+
+    while (pos < *count && arg.start < arg.end)
+    {
+        arg.max_pages = *count - pos;
+        if ((ret = ioctl( pagemap_fd, PAGEMAP_SCAN, &arg )) == -1)
+        {
+            if (errno == EINTR) continue;
+            return FILE_GetNtStatus();
+        }
+        for (i = 0; i < ret; i++)
+        {
+            end = (char *)(UINT_PTR)regions[i].end;
+            for (addr = (char *)(UINT_PTR)regions[i].start; addr < end; addr += page_size)
+                addresses[pos++] = addr;
+        }
+        if (arg.walk_end <= arg.start) break;
+        arg.start = arg.walk_end;
+    }
+    *count = pos;
+    return STATUS_SUCCESS;
+}
+
+#else  /* HAVE_LINUX_USERFAULTFD_H */
+
+static inline BOOL register_kernel_write_watch( void *base, size_t size ) { return FALSE; }
+static inline void enable_kernel_write_watch( struct file_view *view ) { }
+static inline void reset_kernel_write_watches( void *base, size_t size ) { }
+static inline NTSTATUS get_kernel_write_watches( void *base, size_t size, void **addresses,
+                                                 ULONG_PTR *count, BOOL reset )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif  /* HAVE_LINUX_USERFAULTFD_H */
+
+
 /***********************************************************************
  *           update_write_watches
  */
@@ -944,8 +1174,13 @@ static void update_write_watches( void *base, size_t size, size_t accessed_size
  *
  * Reset write watches in a memory range.
  */
-static void reset_write_watches( void *base, SIZE_T size )
+static void reset_write_watches( struct file_view *view, void *base, SIZE_T size )
 {
+    if (view->protect & VPROT_KERNELWATCH)
+    {
+        reset_kernel_write_watches( base, size );
+        return;
+    }
     set_page_vprot_bits( base, size, VPROT_WRITEWATCH, 0 );
     mprotect_range( base, size, 0, 0 );
 }
@@ -1252,6 +1487,11 @@ static NTSTATUS decommit_pages( struct file_view *view, size_t start, size_t siz
 {
     if (wine_anon_mmap( (char *)view->base + start, size, PROT_NONE, MAP_FIXED ) != (void *)-1)
     {
+        /* the new mapping is no longer write-protected by the kernel */
+        if ((view->protect & VPROT_KERNELWATCH) &&
+            !register_kernel_write_watch( (char *)view->base + start, size ))
+            ERR( "failed to restore write watches on %p-%p\n",
+                 (char *)view->base + start, (char *)view->base + start + size );
         set_page_vprot_bits( (char *)view->base + start, size, 0, VPROT_COMMITTED );
         return STATUS_SUCCESS;
     }
@@ -1352,13 +1592,42 @@ static NTSTATUS map_pe_header( void *ptr, size_t size, int fd, BOOL *removable )
 }
 
 
+/***********************************************************************
+ *           get_relocated_image_fd
+ *
+ * Retrieve the file holding the image relocated by the server for a given address.
+ * Returns -1 if the image can't be shared, the caller then relocates it itself.
+ */
+static int get_relocated_image_fd( HANDLE hmapping, void *base, int *needs_close )
+{
+    NTSTATUS status;
+    HANDLE file;
+    int fd;
+
+    SERVER_START_REQ( get_relocated_image )
+    {
+        req->mapping = wine_server_obj_handle( hmapping );
+        req->base    = wine_server_client_ptr( base );
+        status = wine_server_call( req );
+        file = wine_server_ptr_handle( reply->file );
+    }
+    SERVER_END_REQ;
+    if (status || !file) return -1;
+
+    if (server_get_unix_fd( file, FILE_READ_DATA, &fd, needs_close, NULL, NULL )) fd = -1;
+    close_handle( file );
+    return fd;
+}
+
+
 /***********************************************************************
  *           map_image
  *
  * Map an executable (PE format) image into memory.
  */
 static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T mask,
-                           pe_image_info_t *image_info, int shared_fd, BOOL removable, PVOID *addr_ptr )
+                           pe_image_info_t *image_info, int shared_fd, BOOL removable, BOOL relocate,
+                           PVOID *addr_ptr )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -1367,11 +1636,12 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
     IMAGE_DATA_DIRECTORY *imports;
     NTSTATUS status = STATUS_CONFLICTING_ADDRESSES;
     SIZE_T header_size, total_size = image_info->map_size;
-    int i;
+    int i, reloc_fd, reloc_needs_close;
     off_t pos;
     sigset_t sigset;
     struct stat st;
     struct file_view *view = NULL;
+    BOOL relocated = FALSE;
     char *ptr, *header_end, *header_start;
     char *base = wine_server_get_ptr( image_info->base );
 
@@ -1407,13 +1677,25 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
         goto error;
     }
     header_size = min( image_info->header_size, st.st_size );
-    if ((status = map_pe_header( view->base, header_size, fd, &removable )) != STATUS_SUCCESS) goto error;
+
+    /* if the server has the image relocated for this address, share its pages */
+    if (relocate && ptr != base &&
+        (reloc_fd = get_relocated_image_fd( hmapping, ptr, &reloc_needs_close )) != -1)
+    {
+        TRACE_(module)( "mapping relocated image at %p\n", ptr );
+        status = map_file_into_view( view, reloc_fd, 0, total_size, 0,
+                                     VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY, FALSE );
+        if (reloc_needs_close) close( reloc_fd );
+        if (status != STATUS_SUCCESS) goto error;
+        relocated = TRUE;
+    }
+    else if ((status = map_pe_header( view->base, header_size, fd, &removable )) != STATUS_SUCCESS) goto error;
 
     status = STATUS_INVALID_IMAGE_FORMAT;  /* generic error */
     dos = (IMAGE_DOS_HEADER *)ptr;
     nt = (IMAGE_NT_HEADERS *)(ptr + dos->e_lfanew);
     header_end = ptr + ROUND_SIZE( 0, header_size );
-    memset( ptr + header_size, 0, header_end - (ptr + header_size) );
+    if (!relocated) memset( ptr + header_size, 0, header_end - (ptr + header_size) );
     if ((char *)(nt + 1) > header_end) goto error;
     header_start = (char*)&nt->OptionalHeader+nt->FileHeader.SizeOfOptionalHeader;
     if (nt->FileHeader.NumberOfSections > ARRAY_SIZE( sections )) goto error;
@@ -1453,9 +1735,9 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
     }
 
 
-    /* map all the sections */
+    /* map all the sections, the relocated image already contains them */
 
-    for (i = pos = 0; i < nt->FileHeader.NumberOfSections; i++, sec++)
+    for (i = pos = 0; !relocated && i < nt->FileHeader.NumberOfSections; i++, sec++)
     {
         static const SIZE_T sector_align = 0x1ff;
         SIZE_T map_size, file_start, file_size, end;
@@ -1606,10 +1888,11 @@ static NTSTATUS map_image( HANDLE hmapping, ACCESS_MASK access, int fd, SIZE_T m
  *             virtual_map_section
  *
  * Map a file section into memory.
+ * For images, 'relocate' lets the server supply pages already relocated to the mapped address.
  */
 NTSTATUS virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG zero_bits, SIZE_T commit_size,
                               const LARGE_INTEGER *offset_ptr, SIZE_T *size_ptr, ULONG protect,
-                              pe_image_info_t *image_info )
+                              pe_image_info_t *image_info, BOOL relocate )
 {
     NTSTATUS res;
     mem_size_t full_size;
@@ -1670,13 +1953,14 @@ NTSTATUS virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG zero_bits, S
             if ((res = server_get_unix_fd( shared_file, FILE_READ_DATA|FILE_WRITE_DATA,
                                            &shared_fd, &shared_needs_close, NULL, NULL ))) goto done;
             res = map_image( handle, access, unix_handle, mask, image_info,
-                             shared_fd, needs_close, addr_ptr );
+                             shared_fd, needs_close, relocate, addr_ptr );
             if (shared_needs_close) close( shared_fd );
             close_handle( shared_file );
         }
         else
         {
-            res = map_image( handle, access, unix_handle, mask, image_info, -1, needs_close, addr_ptr );
+            res = map_image( handle, access, unix_handle, mask, image_info, -1, needs_close,
+                             relocate, addr_ptr );
         }
         if (needs_close) close( unix_handle );
         if (res >= 0) *size_ptr = image_info->map_size;
@@ -2552,7 +2836,11 @@ NTSTATUS WINAPI NtAllocateVirtualMemory( HANDLE process, PVOID *ret, ULONG zero_
             else if (is_dos_memory) status = allocate_dos_memory( &view, vprot );
             else status = map_view( &view, base, size, mask, type & MEM_TOP_DOWN, vprot );
 
-            if (status == STATUS_SUCCESS) base = view->base;
+            if (status == STATUS_SUCCESS)
+            {
+                if (vprot & VPROT_WRITEWATCH) enable_kernel_write_watch( view );
+                base = view->base;
+            }
         }
     }
     else if (type & MEM_RESET)
@@ -3131,7 +3419,7 @@ NTSTATUS WINAPI NtMapViewOfSection( HANDLE handle, HANDLE process, PVOID *addr_p
     }
 
     return virtual_map_section( handle, addr_ptr, zero_bits, commit_size,
-                                offset_ptr, size_ptr, protect, &image_info );
+                                offset_ptr, size_ptr, protect, &image_info, FALSE );
 }
 
 
@@ -3326,6 +3614,7 @@ NTSTATUS WINAPI NtFlushVirtualMemory( HANDLE process, LPCVOID *addr_ptr,
 NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T size, PVOID *addresses,
                                  ULONG_PTR *count, ULONG *granularity )
 {
+    struct file_view *view;
     NTSTATUS status = STATUS_SUCCESS;
     sigset_t sigset;
 
@@ -3343,19 +3632,27 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
 
     server_enter_uninterrupted_section( &csVirtual, &sigset );
 
-    if (is_write_watch_range( base, size ))
+    if ((view = VIRTUAL_FindView( base, size )) && (view->protect & VPROT_WRITEWATCH))
     {
-        ULONG_PTR pos = 0;
-        char *addr = base;
-        char *end = addr + size;
-
-        while (pos < *count && addr < end)
+        if (view->protect & VPROT_KERNELWATCH)
         {
-            if (!(get_page_vprot( addr ) & VPROT_WRITEWATCH)) addresses[pos++] = addr;
-            addr += page_size;
+            status = get_kernel_write_watches( base, size, addresses, count,
+                                               flags & WRITE_WATCH_FLAG_RESET );
+        }
+        else
+        {
+            ULONG_PTR pos = 0;
+            char *addr = base;
+            char *end = addr + size;
+
+            while (pos < *count && addr < end)
+            {
+                if (!(get_page_vprot( addr ) & VPROT_WRITEWATCH)) addresses[pos++] = addr;
+                addr += page_size;
+            }
+            if (flags & WRITE_WATCH_FLAG_RESET) reset_write_watches( view, base, addr - (char *)base );
+            *count = pos;
         }
-        if (flags & WRITE_WATCH_FLAG_RESET) reset_write_watches( base, addr - (char *)base );
-        *count = pos;
         *granularity = page_size;
     }
     else status = STATUS_INVALID_PARAMETER;
@@ -3371,6 +3668,7 @@ NTSTATUS WINAPI NtGetWriteWatch( HANDLE process, ULONG flags, PVOID base, SIZE_T
  */
 NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 {
+    struct file_view *view;
     NTSTATUS status = STATUS_SUCCESS;
     sigset_t sigset;
 
@@ -3383,8 +3681,8 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 
     server_enter_uninterrupted_section( &csVirtual, &sigset );
 
-    if (is_write_watch_range( base, size ))
-        reset_write_watches( base, size );
+    if ((view = VIRTUAL_FindView( base, size )) && (view->protect & VPROT_WRITEWATCH))
+        reset_write_watches( view, base, size );
     else
         status = STATUS_INVALID_PARAMETER;
 
@@ -3393,6 +3691,140 @@ NTSTATUS WINAPI NtResetWriteWatch( HANDLE process, PVOID base, SIZE_T size )
 }
 
 
+#if defined(HAVE_PROCESS_VM_READV) && defined(__linux__)
+
+#ifndef __NR_pidfd_open
+#define __NR_pidfd_open 434
+#endif
+
+/***********************************************************************
+ *           get_process_vm_pid
+ *
+ * Check the access rights to the memory of a process and return its Unix pid, or -1.
+ */
+static int get_process_vm_pid( HANDLE process, BOOL write )
+{
+    int pid = -1;
+
+    SERVER_START_REQ( get_process_vm_pid )
+    {
+        req->handle = wine_server_obj_handle( process );
+        req->access = write ? PROCESS_VM_WRITE : PROCESS_VM_READ;
+        if (!wine_server_call( req )) pid = reply->unix_pid;
+    }
+    SERVER_END_REQ;
+    return pid;
+}
+
+#endif
+
+#if defined(HAVE_PROCESS_VM_READV) && defined(__linux__)
+
+/***********************************************************************
+ *           is_ptrace_restricted
+ *
+ * Yama ptrace_scope 1 and up only gives access to the memory of descendants. Wine processes
+ * are started through an intermediate process that exits, so they never qualify.
+ */
+static BOOL is_ptrace_restricted(void)
+{
+    char buffer[16];
+    int fd, len;
+
+    if ((fd = open( "/proc/sys/kernel/yama/ptrace_scope", O_RDONLY )) == -1) return FALSE;
+    len = read( fd, buffer, sizeof(buffer) - 1 );
+    close( fd );
+    if (len <= 0) return FALSE;
+    buffer[len] = 0;
+    return atoi( buffer ) >= 1;
+}
+
+#endif
+
+/***********************************************************************
+ *           direct_process_vm_rw
+ *
+ * Copy memory from or to another process without passing the data through the server,
+ * after the server checked the access rights. Returns FALSE if the server has to do it instead.
+ */
+static BOOL direct_process_vm_rw( HANDLE process, void *addr, void *buffer, SIZE_T size, BOOL write )
+{
+#if defined(HAVE_PROCESS_VM_READV) && defined(__linux__)
+    static int disabled = -1;
+    static int denied_pids[8];
+    static unsigned int denied_pos;
+    struct iovec local, remote;
+    struct pollfd pfd;
+    ssize_t ret = -1;
+    int pid, pidfd, fd, i, err = 0;
+    char path[32];
+
+    if (disabled == -1) disabled = is_ptrace_restricted();
+    if (disabled || !size) return FALSE;
+
+    if ((pid = get_process_vm_pid( process, write )) == -1) return FALSE;
+    for (i = 0; i < ARRAY_SIZE(denied_pids); i++) if (denied_pids[i] == pid) return FALSE;
+
+    /* the process may die and its pid get reused before the copy, so pin it with a pidfd and
+     * check with the server that the process was still alive once the pidfd was opened */
+    if ((pidfd = syscall( __NR_pidfd_open, pid, 0 )) == -1)
+    {
+        if (errno == ENOSYS) disabled = TRUE;
+        return FALSE;
+    }
+    if (get_process_vm_pid( process, write ) != pid) goto done;
+
+    /* the pid is only reused once the process exited, so it was the right one if it still runs */
+    pfd.fd     = pidfd;
+    pfd.events = POLLIN;
+
+    if (write)
+    {
+        /* process_vm_writev addresses the pid, which may be reused by the time the data is
+         * written. /proc/<pid>/mem is bound to the address space it was opened for, so it is
+         * safe to write to once the process is known to have been alive after the open. */
+        sprintf( path, "/proc/%d/mem", pid );
+        if ((fd = open( path, O_WRONLY )) == -1) err = errno;
+        else
+        {
+            if (!poll( &pfd, 1, 0 ) && (ret = pwrite( fd, buffer, size, (off_t)(ULONG_PTR)addr )) == -1)
+                err = errno;
+            close( fd );
+        }
+        if (ret == size)
+        {
+            close( pidfd );
+            return TRUE;
+        }
+    }
+    else
+    {
+        local.iov_base  = buffer;
+        local.iov_len   = size;
+        remote.iov_base = addr;
+        remote.iov_len  = size;
+        if ((ret = process_vm_readv( pid, &local, 1, &remote, 1, 0 )) == -1) err = errno;
+        if (ret == size && !poll( &pfd, 1, 0 ))
+        {
+            close( pidfd );
+            return TRUE;
+        }
+        /* don't leave data of another process behind if the pid was reused */
+        if (ret > 0) memset( buffer, 0, ret );
+    }
+
+    /* partial copies and protected pages are left to the server, which has the exact semantics */
+    if (err == ENOSYS) disabled = TRUE;
+    else if (err == EPERM || err == EACCES)
+        denied_pids[interlocked_xchg_add( (LONG *)&denied_pos, 1 ) % ARRAY_SIZE(denied_pids)] = pid;
+done:
+    close( pidfd );
+    TRACE( "%p %p %lu: falling back to the server (%ld)\n", process, addr, size, (long)ret );
+#endif
+    return FALSE;
+}
+
+
 /***********************************************************************
  *             NtReadVirtualMemory   (NTDLL.@)
  *             ZwReadVirtualMemory   (NTDLL.@)
@@ -3404,6 +3836,11 @@ NTSTATUS WINAPI NtReadVirtualMemory( HANDLE process, const void *addr, void *buf
 
     if (virtual_check_buffer_for_write( buffer, size ))
     {
+        if (direct_process_vm_rw( process, (void *)addr, buffer, size, FALSE ))
+        {
+            if (bytes_read) *bytes_read = size;
+            return STATUS_SUCCESS;
+        }
         SERVER_START_REQ( read_process_memory )
         {
             req->handle = wine_server_obj_handle( process );
@@ -3434,6 +3871,11 @@ NTSTATUS WINAPI NtWriteVirtualMemory( HANDLE process, void *addr, const void *bu
 
     if (virtual_check_buffer_for_read( buffer, size ))
     {
+        if (direct_process_vm_rw( process, addr, (void *)buffer, size, TRUE ))
+        {
+            if (bytes_written) *bytes_written = size;
+            return STATUS_SUCCESS;
+        }
         SERVER_START_REQ( write_process_memory )
         {
             req->handle     = wine_server_obj_handle( process );
@@ -158,10 +158,43 @@ struct class_reg_data
             void *section;
             HANDLE hactctx;
         } actctx;
-        HKEY hkey;
+        struct
+        {
+            enum comclass_threadingmodel model;
+            BOOL has_path;               /* whether the dll path value exists */
+            DWORD path_type;             /* type of the dll path value */
+            WCHAR path[MAX_PATH+1];      /* dll path value */
+        } reg;
     } u;
-    BOOL hkey;
+    BOOL registry;
+};
+
+/* class registration data read from the registry, kept until the classes key changes */
+struct class_reg_cache_entry
+{
+    struct list entry;
+    CLSID clsid;
+    BOOL handler;                        /* read from InprocHandler32 instead of InprocServer32 */
+    HRESULT hr;                          /* result of opening the key */
+    struct class_reg_data data;
+};
+
+#define CLASS_REG_CACHE_SIZE 256
+
+static struct list class_reg_cache = LIST_INIT(class_reg_cache);
+static unsigned int class_reg_cache_count;
+static unsigned int class_reg_cache_generation;  /* incremented each time the cache is flushed */
+static HKEY class_reg_cache_key;                 /* classes key watched for changes */
+static HANDLE class_reg_cache_event;             /* signaled when the classes key changes */
+
+static CRITICAL_SECTION cs_class_reg_cache;
+static CRITICAL_SECTION_DEBUG class_reg_cache_cs_debug =
+{
+    0, 0, &cs_class_reg_cache,
+    { &class_reg_cache_cs_debug.ProcessLocksList, &class_reg_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": cs_class_reg_cache") }
 };
+static CRITICAL_SECTION cs_class_reg_cache = { &class_reg_cache_cs_debug, -1, 0, 0, 0, 0 };
 
 struct registered_psclsid
 {
@@ -1409,32 +1442,23 @@ static HRESULT apartment_getclassobject(struct apartment *apt, LPCWSTR dllpath,
 /* Returns expanded dll path from the registry or activation context. */
 static BOOL get_object_dll_path(const struct class_reg_data *regdata, WCHAR *dst, DWORD dstlen)
 {
-    DWORD ret;
-
-    if (regdata->hkey)
+    if (regdata->registry)
     {
-	DWORD keytype;
-	WCHAR src[MAX_PATH];
-	DWORD dwLength = dstlen * sizeof(WCHAR);
-
-        if( (ret = RegQueryValueExW(regdata->u.hkey, NULL, NULL, &keytype, (BYTE*)src, &dwLength)) == ERROR_SUCCESS ) {
-            if (keytype == REG_EXPAND_SZ) {
-              if (dstlen <= ExpandEnvironmentStringsW(src, dst, dstlen)) ret = ERROR_MORE_DATA;
-            } else {
-              const WCHAR *quote_start;
-              quote_start = strchrW(src, '\"');
-              if (quote_start) {
-                const WCHAR *quote_end = strchrW(quote_start + 1, '\"');
-                if (quote_end) {
-                  memmove(src, quote_start + 1,
-                          (quote_end - quote_start - 1) * sizeof(WCHAR));
-                  src[quote_end - quote_start - 1] = '\0';
-                }
-              }
-              lstrcpynW(dst, src, dstlen);
-            }
+        WCHAR src[MAX_PATH+1];
+        const WCHAR *quote_start, *quote_end;
+
+        if (!regdata->u.reg.has_path) return FALSE;
+        if (regdata->u.reg.path_type == REG_EXPAND_SZ)
+            return dstlen > ExpandEnvironmentStringsW(regdata->u.reg.path, dst, dstlen);
+
+        strcpyW(src, regdata->u.reg.path);
+        if ((quote_start = strchrW(src, '\"')) && (quote_end = strchrW(quote_start + 1, '\"')))
+        {
+            memmove(src, quote_start + 1, (quote_end - quote_start - 1) * sizeof(WCHAR));
+            src[quote_end - quote_start - 1] = '\0';
         }
-        return !ret;
+        lstrcpynW(dst, src, dstlen);
+        return TRUE;
     }
     else
     {
@@ -1445,7 +1469,7 @@ static BOOL get_object_dll_path(const struct class_reg_data *regdata, WCHAR *dst
         *dst = 0;
         nameW = (WCHAR*)((BYTE*)regdata->u.actctx.section + regdata->u.actctx.data->name_offset);
         ActivateActCtx(regdata->u.actctx.hactctx, &cookie);
-        ret = SearchPathW(NULL, nameW, dllW, dstlen, dst, NULL);
+        SearchPathW(NULL, nameW, dllW, dstlen, dst, NULL);
         DeactivateActCtx(0, cookie);
         return *dst != 0;
     }
@@ -2958,31 +2982,151 @@ HRESULT WINAPI CoRegisterClassObject(
   return S_OK;
 }
 
-static enum comclass_threadingmodel get_threading_model(const struct class_reg_data *data)
+/* read the threading model and dll path of a class from its InprocServer32 or InprocHandler32 key */
+static void read_class_reg_data(HKEY hkey, struct class_reg_data *data)
+{
+    static const WCHAR wszThreadingModel[] = {'T','h','r','e','a','d','i','n','g','M','o','d','e','l',0};
+    static const WCHAR wszApartment[] = {'A','p','a','r','t','m','e','n','t',0};
+    static const WCHAR wszFree[] = {'F','r','e','e',0};
+    static const WCHAR wszBoth[] = {'B','o','t','h',0};
+    WCHAR threading_model[10 /* strlenW(L"apartment")+1 */];
+    DWORD dwLength = sizeof(threading_model);
+    DWORD keytype;
+    DWORD ret;
+
+    data->registry = TRUE;
+
+    ret = RegQueryValueExW(hkey, wszThreadingModel, NULL, &keytype, (BYTE*)threading_model, &dwLength);
+    if ((ret != ERROR_SUCCESS) || (keytype != REG_SZ))
+        threading_model[0] = '\0';
+
+    if (!strcmpiW(threading_model, wszApartment)) data->u.reg.model = ThreadingModel_Apartment;
+    else if (!strcmpiW(threading_model, wszFree)) data->u.reg.model = ThreadingModel_Free;
+    else if (!strcmpiW(threading_model, wszBoth)) data->u.reg.model = ThreadingModel_Both;
+    /* there's not specific handling for this case */
+    else if (threading_model[0]) data->u.reg.model = ThreadingModel_Neutral;
+    else data->u.reg.model = ThreadingModel_No;
+
+    dwLength = sizeof(data->u.reg.path) - sizeof(WCHAR);
+    ret = RegQueryValueExW(hkey, NULL, NULL, &data->u.reg.path_type, (BYTE*)data->u.reg.path, &dwLength);
+    data->u.reg.has_path = (ret == ERROR_SUCCESS);
+    data->u.reg.path[ret == ERROR_SUCCESS ? dwLength / sizeof(WCHAR) : 0] = 0;
+}
+
+/* empty the class registration cache, called with the cache lock held */
+static void flush_class_reg_cache(void)
+{
+    struct class_reg_cache_entry *entry, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &class_reg_cache, struct class_reg_cache_entry, entry)
+    {
+        list_remove(&entry->entry);
+        HeapFree(GetProcessHeap(), 0, entry);
+    }
+    class_reg_cache_count = 0;
+    class_reg_cache_generation++;
+}
+
+/* flush the class registration cache if the classes key changed, called with the
+ * cache lock held; returns FALSE if changes can't be watched and the cache can't be used */
+static BOOL validate_class_reg_cache(void)
+{
+    static const WCHAR emptyW[] = {0};
+    LONG ret;
+
+    if (!class_reg_cache_event)
+    {
+        if (open_classes_key(HKEY_CLASSES_ROOT, emptyW, KEY_NOTIFY, &class_reg_cache_key))
+            return FALSE;
+        /* created signaled, so that the notification gets armed below */
+        if (!(class_reg_cache_event = CreateEventW(NULL, TRUE, TRUE, NULL)))
+        {
+            RegCloseKey(class_reg_cache_key);
+            class_reg_cache_key = NULL;
+            return FALSE;
+        }
+    }
+
+    if (WaitForSingleObject(class_reg_cache_event, 0) == WAIT_TIMEOUT) return TRUE;
+
+    /* arm the notification again before flushing, so that no change can be missed */
+    ret = RegNotifyChangeKeyValue(class_reg_cache_key, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+                                  class_reg_cache_event, TRUE);
+    flush_class_reg_cache();
+    return !ret;
+}
+
+/* get the registration data of an in-process server or handler, from the cache if possible */
+static HRESULT get_class_reg_data(REFCLSID clsid, BOOL handler, struct class_reg_data *data)
 {
-    if (data->hkey)
+    static const WCHAR wszInprocServer32[] = {'I','n','p','r','o','c','S','e','r','v','e','r','3','2',0};
+    static const WCHAR wszInprocHandler32[] = {'I','n','p','r','o','c','H','a','n','d','l','e','r','3','2',0};
+    struct class_reg_cache_entry *entry;
+    unsigned int generation;
+    BOOL use_cache;
+    HRESULT hr;
+    HKEY hkey;
+
+    EnterCriticalSection(&cs_class_reg_cache);
+    if ((use_cache = validate_class_reg_cache()))
+    {
+        LIST_FOR_EACH_ENTRY(entry, &class_reg_cache, struct class_reg_cache_entry, entry)
+        {
+            if (entry->handler != handler || !IsEqualCLSID(&entry->clsid, clsid)) continue;
+            list_remove(&entry->entry);
+            list_add_head(&class_reg_cache, &entry->entry);
+            *data = entry->data;
+            hr = entry->hr;
+            LeaveCriticalSection(&cs_class_reg_cache);
+            return hr;
+        }
+    }
+    generation = class_reg_cache_generation;
+    LeaveCriticalSection(&cs_class_reg_cache);
+
+    hr = COM_OpenKeyForCLSID(clsid, handler ? wszInprocHandler32 : wszInprocServer32, KEY_READ, &hkey);
+    if (SUCCEEDED(hr))
+    {
+        read_class_reg_data(hkey, data);
+        RegCloseKey(hkey);
+    }
+    /* transient failures are not cached */
+    if (!use_cache || (FAILED(hr) && hr != REGDB_E_CLASSNOTREG && hr != REGDB_E_KEYMISSING))
+        return hr;
+    if (!(entry = HeapAlloc(GetProcessHeap(), 0, sizeof(*entry)))) return hr;
+
+    entry->clsid = *clsid;
+    entry->handler = handler;
+    entry->hr = hr;
+    if (SUCCEEDED(hr)) entry->data = *data;
+
+    EnterCriticalSection(&cs_class_reg_cache);
+    /* the cache was flushed while reading, the data may be stale already */
+    if (generation != class_reg_cache_generation)
+    {
+        HeapFree(GetProcessHeap(), 0, entry);
+        entry = NULL;
+    }
+    else if (class_reg_cache_count == CLASS_REG_CACHE_SIZE)
     {
-        static const WCHAR wszThreadingModel[] = {'T','h','r','e','a','d','i','n','g','M','o','d','e','l',0};
-        static const WCHAR wszApartment[] = {'A','p','a','r','t','m','e','n','t',0};
-        static const WCHAR wszFree[] = {'F','r','e','e',0};
-        static const WCHAR wszBoth[] = {'B','o','t','h',0};
-        WCHAR threading_model[10 /* strlenW(L"apartment")+1 */];
-        DWORD dwLength = sizeof(threading_model);
-        DWORD keytype;
-        DWORD ret;
-
-        ret = RegQueryValueExW(data->u.hkey, wszThreadingModel, NULL, &keytype, (BYTE*)threading_model, &dwLength);
-        if ((ret != ERROR_SUCCESS) || (keytype != REG_SZ))
-            threading_model[0] = '\0';
-
-        if (!strcmpiW(threading_model, wszApartment)) return ThreadingModel_Apartment;
-        if (!strcmpiW(threading_model, wszFree)) return ThreadingModel_Free;
-        if (!strcmpiW(threading_model, wszBoth)) return ThreadingModel_Both;
-
-        /* there's not specific handling for this case */
-        if (threading_model[0]) return ThreadingModel_Neutral;
-        return ThreadingModel_No;
+        struct class_reg_cache_entry *oldest = LIST_ENTRY(list_tail(&class_reg_cache), struct class_reg_cache_entry, entry);
+        list_remove(&oldest->entry);
+        HeapFree(GetProcessHeap(), 0, oldest);
+        class_reg_cache_count--;
     }
+    if (entry)
+    {
+        list_add_head(&class_reg_cache, &entry->entry);
+        class_reg_cache_count++;
+    }
+    LeaveCriticalSection(&cs_class_reg_cache);
+    return hr;
+}
+
+static enum comclass_threadingmodel get_threading_model(const struct class_reg_data *data)
+{
+    if (data->registry)
+        return data->u.reg.model;
     else
         return data->u.actctx.data->model;
 }
@@ -3117,7 +3261,7 @@ HRESULT WINAPI DECLSPEC_HOTPATCH CoGetClassObject(
             clsreg.u.actctx.hactctx = data.hActCtx;
             clsreg.u.actctx.data = data.lpData;
             clsreg.u.actctx.section = data.lpSectionBase;
-            clsreg.hkey = FALSE;
+            clsreg.registry = FALSE;
 
             hres = get_inproc_class_object(apt, &clsreg, &comclass->clsid, iid, !(dwClsContext & WINE_CLSCTX_DONT_HOST), ppv);
             ReleaseActCtx(data.hActCtx);
@@ -3149,10 +3293,7 @@ HRESULT WINAPI DECLSPEC_HOTPATCH CoGetClassObject(
     /* First try in-process server */
     if (CLSCTX_INPROC_SERVER & dwClsContext)
     {
-        static const WCHAR wszInprocServer32[] = {'I','n','p','r','o','c','S','e','r','v','e','r','3','2',0};
-        HKEY hkey;
-
-        hres = COM_OpenKeyForCLSID(rclsid, wszInprocServer32, KEY_READ, &hkey);
+        hres = get_class_reg_data(rclsid, FALSE, &clsreg);
         if (FAILED(hres))
         {
             if (hres == REGDB_E_CLASSNOTREG)
@@ -3165,13 +3306,7 @@ HRESULT WINAPI DECLSPEC_HOTPATCH CoGetClassObject(
         }
 
         if (SUCCEEDED(hres))
-        {
-            clsreg.u.hkey = hkey;
-            clsreg.hkey = TRUE;
-
             hres = get_inproc_class_object(apt, &clsreg, rclsid, iid, !(dwClsContext & WINE_CLSCTX_DONT_HOST), ppv);
-            RegCloseKey(hkey);
-        }
 
         /* return if we got a class, otherwise fall through to one of the
          * other types */
@@ -3185,10 +3320,7 @@ HRESULT WINAPI DECLSPEC_HOTPATCH CoGetClassObject(
     /* Next try in-process handler */
     if (CLSCTX_INPROC_HANDLER & dwClsContext)
     {
-        static const WCHAR wszInprocHandler32[] = {'I','n','p','r','o','c','H','a','n','d','l','e','r','3','2',0};
-        HKEY hkey;
-
-        hres = COM_OpenKeyForCLSID(rclsid, wszInprocHandler32, KEY_READ, &hkey);
+        hres = get_class_reg_data(rclsid, TRUE, &clsreg);
         if (FAILED(hres))
         {
             if (hres == REGDB_E_CLASSNOTREG)
@@ -3201,13 +3333,7 @@ HRESULT WINAPI DECLSPEC_HOTPATCH CoGetClassObject(
         }
 
         if (SUCCEEDED(hres))
-        {
-            clsreg.u.hkey = hkey;
-            clsreg.hkey = TRUE;
-
             hres = get_inproc_class_object(apt, &clsreg, rclsid, iid, !(dwClsContext & WINE_CLSCTX_DONT_HOST), ppv);
-            RegCloseKey(hkey);
-        }
 
         /* return if we got a class, otherwise fall through to one of the
          * other types */
@@ -5130,31 +5256,22 @@ HRESULT WINAPI CoGetDefaultContext(APTTYPE type, REFIID riid, LPVOID *ppv)
 
 HRESULT Handler_DllGetClassObject(REFCLSID rclsid, REFIID riid, LPVOID *ppv)
 {
-    static const WCHAR wszInprocHandler32[] = {'I','n','p','r','o','c','H','a','n','d','l','e','r','3','2',0};
-    HKEY hkey;
+    struct class_reg_data regdata;
     HRESULT hres;
 
-    hres = COM_OpenKeyForCLSID(rclsid, wszInprocHandler32, KEY_READ, &hkey);
+    hres = get_class_reg_data(rclsid, TRUE, &regdata);
     if (SUCCEEDED(hres))
     {
-        struct class_reg_data regdata;
         WCHAR dllpath[MAX_PATH+1];
 
-        regdata.u.hkey = hkey;
-        regdata.hkey = TRUE;
-
         if (get_object_dll_path(&regdata, dllpath, ARRAY_SIZE(dllpath)))
         {
             static const WCHAR wszOle32[] = {'o','l','e','3','2','.','d','l','l',0};
             if (!strcmpiW(dllpath, wszOle32))
-            {
-                RegCloseKey(hkey);
                 return HandlerCF_Create(rclsid, riid, ppv);
-            }
         }
         else
             WARN("not creating object for inproc handler path %s\n", debugstr_w(dllpath));
-        RegCloseKey(hkey);
     }
 
     return CLASS_E_CLASSNOTAVAILABLE;
@@ -5352,6 +5469,10 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID reserved)
             UnregisterClassW( (const WCHAR*)MAKEINTATOM(apt_win_class), hProxyDll );
         RPC_UnregisterAllChannelHooks();
         COMPOBJ_DllList_Free();
+        flush_class_reg_cache();
+        if (class_reg_cache_event) CloseHandle(class_reg_cache_event);
+        if (class_reg_cache_key) RegCloseKey(class_reg_cache_key);
+        DeleteCriticalSection(&cs_class_reg_cache);
         DeleteCriticalSection(&csRegisteredClassList);
         DeleteCriticalSection(&csApartment);
 	break;
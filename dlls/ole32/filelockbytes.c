@@ -52,8 +52,17 @@ typedef struct FileLockBytesImpl
     HANDLE hfile;
     DWORD flProtect;
     LPWSTR pwcsName;
+    const BYTE *view;
+    ULONGLONG view_size;
 } FileLockBytesImpl;
 
+/* largest file that is mapped as a whole for read-only access */
+#ifdef _WIN64
+#define MAX_MAPPED_SIZE ((ULONGLONG)1 << 40)
+#else
+#define MAX_MAPPED_SIZE (256 * 1024 * 1024)
+#endif
+
 static const ILockBytesVtbl FileLockBytesImpl_Vtbl;
 
 static inline FileLockBytesImpl *impl_from_ILockBytes(ILockBytes *iface)
@@ -82,6 +91,45 @@ static DWORD GetProtectMode(DWORD openFlags)
     return PAGE_READONLY;
 }
 
+/****************************************************************************
+ *      FileLockBytesImpl_MapFile
+ *
+ * Map a file that is opened for reading only and that nobody else can
+ * write to, so that reads are served from the view instead of going
+ * through ReadFile for every sector.
+ */
+static void FileLockBytesImpl_MapFile(FileLockBytesImpl *This, DWORD openFlags)
+{
+    LARGE_INTEGER size;
+    HANDLE mapping;
+
+    This->view = NULL;
+    This->view_size = 0;
+
+    if (This->flProtect != PAGE_READONLY) return;
+    if (STGM_SHARE_MODE(openFlags) != STGM_SHARE_DENY_WRITE &&
+        STGM_SHARE_MODE(openFlags) != STGM_SHARE_EXCLUSIVE)
+        return;
+    if (!GetFileSizeEx(This->hfile, &size) || !size.QuadPart || size.QuadPart > MAX_MAPPED_SIZE)
+        return;
+
+    if (!(mapping = CreateFileMappingW(This->hfile, NULL, PAGE_READONLY, 0, 0, NULL)))
+        return;
+    This->view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+
+    if (This->view)
+        This->view_size = size.QuadPart;
+    TRACE("mapped %s bytes at %p\n", wine_dbgstr_longlong(This->view_size), This->view);
+}
+
+static void FileLockBytesImpl_UnmapFile(FileLockBytesImpl *This)
+{
+    if (This->view) UnmapViewOfFile(This->view);
+    This->view = NULL;
+    This->view_size = 0;
+}
+
 /******************************************************************************
  *      FileLockBytesImpl_Construct
  *
@@ -122,6 +170,8 @@ HRESULT FileLockBytesImpl_Construct(HANDLE hFile, DWORD openFlags, LPCWSTR pwcsN
   else
     This->pwcsName = NULL;
 
+  FileLockBytesImpl_MapFile(This, openFlags);
+
   *pLockBytes = &This->ILockBytes_iface;
 
   return S_OK;
@@ -160,6 +210,7 @@ static ULONG WINAPI FileLockBytesImpl_Release(ILockBytes *iface)
 
     if (ref == 0)
     {
+        FileLockBytesImpl_UnmapFile(This);
         CloseHandle(This->hfile);
         HeapFree(GetProcessHeap(), 0, This->pwcsName);
         HeapFree(GetProcessHeap(), 0, This);
@@ -198,6 +249,14 @@ static HRESULT WINAPI FileLockBytesImpl_ReadAt(
     if (pcbRead)
         *pcbRead = 0;
 
+    if (ulOffset.QuadPart < This->view_size && cb <= This->view_size - ulOffset.QuadPart)
+    {
+        memcpy(pv, This->view + ulOffset.QuadPart, cb);
+        if (pcbRead)
+            *pcbRead = cb;
+        return S_OK;
+    }
+
     offset.QuadPart = ulOffset.QuadPart;
 
     ret = SetFilePointerEx(This->hfile, offset, NULL, FILE_BEGIN);
@@ -300,6 +359,9 @@ static HRESULT WINAPI FileLockBytesImpl_SetSize(ILockBytes* iface, ULARGE_INTEGE
 
     TRACE("new size %u\n", newSize.u.LowPart);
 
+    /* a mapped file can't be truncated */
+    FileLockBytesImpl_UnmapFile(This);
+
     newpos.QuadPart = newSize.QuadPart;
     if (SetFilePointerEx(This->hfile, newpos, NULL, FILE_BEGIN))
     {
@@ -7656,7 +7656,19 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
 
     if (!cachedBlock)
     {
-      /* Not in cache, and we're going to read past the end of the block. */
+      ULONG nextBlock = blockNoInSequence + 1;
+
+      /* Not in cache, and we're going to read past the end of the block.
+       * Read the following full blocks along as long as they are stored in
+       * consecutive sectors; the last one is left to the block cache. */
+      while (size - bytesToReadInBuffer > This->parentStorage->bigBlockSize &&
+             BlockChainStream_GetSectorOfOffset(This, nextBlock) == blockIndex + nextBlock - blockNoInSequence &&
+             This->cachedBlocks[0].index != nextBlock && This->cachedBlocks[1].index != nextBlock)
+      {
+        bytesToReadInBuffer += This->parentStorage->bigBlockSize;
+        nextBlock++;
+      }
+
       ulOffset.QuadPart = StorageImpl_GetBigBlockOffset(This->parentStorage, blockIndex) +
                                offsetInBlock;
 
@@ -7681,7 +7693,7 @@ HRESULT BlockChainStream_ReadAt(BlockChainStream* This,
       bytesReadAt = bytesToReadInBuffer;
     }
 
-    blockNoInSequence++;
+    blockNoInSequence += (offsetInBlock + bytesToReadInBuffer - 1) / This->parentStorage->bigBlockSize + 1;
     bufferWalker += bytesReadAt;
     size         -= bytesReadAt;
     *bytesRead   += bytesReadAt;
@@ -727,6 +727,57 @@ static void test_CoGetClassObject(void)
     CoUninitialize();
 }
 
+static void test_CoGetClassObject_registry_change(void)
+{
+    static const CLSID clsid = { 0x6a3c1f25, 0x4b1e, 0x4f7c, { 0x9a, 0x1d, 0x2e, 0x57, 0x80, 0x3b, 0xc4, 0x19 } };
+    static const char keyA[] = "CLSID\\{6A3C1F25-4B1E-4F7C-9A1D-2E57803BC419}";
+    IUnknown *unk;
+    HKEY hkey, server;
+    HRESULT hr;
+    LONG res;
+
+    pCoInitializeEx(NULL, COINIT_MULTITHREADED);
+
+    hr = CoGetClassObject(&clsid, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == REGDB_E_CLASSNOTREG, "got 0x%08x\n", hr);
+
+    res = RegCreateKeyExA(HKEY_CLASSES_ROOT, keyA, 0, NULL, 0, KEY_ALL_ACCESS, NULL, &hkey, NULL);
+    if (res == ERROR_ACCESS_DENIED)
+    {
+        skip("Not authorized to modify the Classes key\n");
+        CoUninitialize();
+        return;
+    }
+    ok(!res, "RegCreateKeyEx returned %d\n", res);
+    res = RegCreateKeyExA(hkey, "InprocServer32", 0, NULL, 0, KEY_ALL_ACCESS, NULL, &server, NULL);
+    ok(!res, "RegCreateKeyEx returned %d\n", res);
+    res = RegSetValueExA(server, NULL, 0, REG_SZ, (const BYTE *)"ole32.dll", sizeof("ole32.dll"));
+    ok(!res, "RegSetValueEx returned %d\n", res);
+
+    /* a class registered after a failed lookup is found by the next call */
+    hr = CoGetClassObject(&clsid, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == CLASS_E_CLASSNOTAVAILABLE, "got 0x%08x\n", hr);
+
+    /* so is a new server path */
+    res = RegSetValueExA(server, NULL, 0, REG_SZ, (const BYTE *)"winetest_nonexistent.dll",
+                         sizeof("winetest_nonexistent.dll"));
+    ok(!res, "RegSetValueEx returned %d\n", res);
+    hr = CoGetClassObject(&clsid, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == CO_E_DLLNOTFOUND || hr == HRESULT_FROM_WIN32(ERROR_MOD_NOT_FOUND), "got 0x%08x\n", hr);
+
+    /* and the removal of the registration */
+    RegCloseKey(server);
+    res = RegDeleteKeyA(hkey, "InprocServer32");
+    ok(!res, "RegDeleteKey returned %d\n", res);
+    RegCloseKey(hkey);
+    res = RegDeleteKeyA(HKEY_CLASSES_ROOT, keyA);
+    ok(!res, "RegDeleteKey returned %d\n", res);
+    hr = CoGetClassObject(&clsid, CLSCTX_INPROC_SERVER, NULL, &IID_IUnknown, (void **)&unk);
+    ok(hr == REGDB_E_CLASSNOTREG, "got 0x%08x\n", hr);
+
+    CoUninitialize();
+}
+
 static void test_CoCreateInstanceEx(void)
 {
     MULTI_QI qi_res = { &IID_IMoniker };
@@ -3797,6 +3848,7 @@ START_TEST(compobj)
     test_CoCreateInstance();
     test_ole_menu();
     test_CoGetClassObject();
+    test_CoGetClassObject_registry_change();
     test_CoCreateInstanceEx();
     test_CoRegisterMessageFilter();
     test_CoRegisterPSClsid();
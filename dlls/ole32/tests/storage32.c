@@ -3871,6 +3871,73 @@ static void test_overwrite(void)
     DeleteFileA(filenameA);
 }
 
+static void test_readonly_read(void)
+{
+    static const WCHAR stmname[] = { 'C','O','N','T','E','N','T','S',0 };
+    static const WCHAR stmname2[] = { 'C','O','N','T','E','N','T','2',0 };
+    IStorage *stg = NULL;
+    IStream *stm = NULL, *stm2 = NULL;
+    LARGE_INTEGER pos;
+    ULONG bytesread;
+    BYTE *buffer;
+    HRESULT r;
+    int i, j;
+
+    DeleteFileA(filenameA);
+
+    buffer = HeapAlloc(GetProcessHeap(), 0, 40000);
+
+    r = StgCreateDocfile(filename, STGM_CREATE | STGM_READWRITE | STGM_SHARE_EXCLUSIVE, 0, &stg);
+    ok(r==S_OK, "StgCreateDocfile failed %x\n", r);
+
+    r = IStorage_CreateStream(stg, stmname, STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, 0, &stm);
+    ok(r==S_OK, "IStorage->CreateStream failed %x\n", r);
+    r = IStorage_CreateStream(stg, stmname2, STGM_SHARE_EXCLUSIVE | STGM_READWRITE, 0, 0, &stm2);
+    ok(r==S_OK, "IStorage->CreateStream failed %x\n", r);
+
+    /* interleave the writes, so that the sectors of the streams are
+     * partly consecutive and partly not */
+    for (i = 0; i < 40000; i++)
+        buffer[i] = i * 7;
+    for (i = 0; i < 40000; i += 5000)
+    {
+        r = IStream_Write(stm, buffer + i, 5000, NULL);
+        ok(r==S_OK, "IStream->Write failed %x\n", r);
+        r = IStream_Write(stm2, buffer, 700, NULL);
+        ok(r==S_OK, "IStream->Write failed %x\n", r);
+    }
+
+    IStream_Release(stm2);
+    IStream_Release(stm);
+    IStorage_Release(stg);
+
+    r = StgOpenStorage(filename, NULL, STGM_READ | STGM_SHARE_DENY_WRITE, NULL, 0, &stg);
+    ok(r==S_OK, "StgOpenStorage failed %x\n", r);
+
+    r = IStorage_OpenStream(stg, stmname, NULL, STGM_SHARE_EXCLUSIVE | STGM_READ, 0, &stm);
+    ok(r==S_OK, "IStorage->OpenStream failed %x\n", r);
+
+    pos.QuadPart = 100;
+    r = IStream_Seek(stm, pos, STREAM_SEEK_SET, NULL);
+    ok(r==S_OK, "IStream->Seek failed %x\n", r);
+
+    memset(buffer, 0, 40000);
+    r = IStream_Read(stm, buffer, 40000, &bytesread);
+    ok(r==S_OK, "IStream->Read failed %x\n", r);
+    ok(bytesread == 39900, "read %u bytes\n", bytesread);
+
+    for (i = 0, j = 100; i < bytesread; i++, j++)
+        if (buffer[i] != (BYTE)(j * 7))
+            break;
+    ok(i == bytesread, "unexpected data at byte %i\n", i);
+
+    IStream_Release(stm);
+    IStorage_Release(stg);
+
+    HeapFree(GetProcessHeap(), 0, buffer);
+    DeleteFileA(filenameA);
+}
+
 static void test_custom_lockbytes(void)
 {
     static const WCHAR stmname[] = { 'C','O','N','T','E','N','T','S',0 };
@@ -3967,5 +4034,6 @@ START_TEST(storage32)
     test_locking();
     test_transacted_shared();
     test_overwrite();
+    test_readonly_read();
     test_custom_lockbytes();
 }
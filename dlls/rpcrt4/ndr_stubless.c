@@ -55,6 +55,81 @@ static inline BOOL is_oicf_stubdesc(const PMIDL_STUB_DESC pStubDesc)
     return pStubDesc->Version >= 0x20000;
 }
 
+/* wire size of the base types whose wire format is a copy of their memory
+ * representation; these are handled inline instead of going through the
+ * generic base type routines */
+static inline unsigned int flat_basetype_size( unsigned char fc )
+{
+    switch (fc)
+    {
+    case FC_BYTE:
+    case FC_CHAR:
+    case FC_SMALL:
+    case FC_USMALL:
+        return sizeof(UCHAR);
+    case FC_WCHAR:
+    case FC_SHORT:
+    case FC_USHORT:
+        return sizeof(USHORT);
+    case FC_LONG:
+    case FC_ULONG:
+    case FC_ERROR_STATUS_T:
+    case FC_ENUM32:
+    case FC_FLOAT:
+        return sizeof(ULONG);
+    case FC_HYPER:
+    case FC_DOUBLE:
+        return sizeof(ULONGLONG);
+    default:
+        return 0;
+    }
+}
+
+static inline unsigned char *align_buffer( unsigned char *ptr, unsigned int align )
+{
+    return (unsigned char *)(((ULONG_PTR)ptr + align - 1) & ~(ULONG_PTR)(align - 1));
+}
+
+static inline void flat_basetype_buffer_size( PMIDL_STUB_MESSAGE pStubMsg, unsigned int size )
+{
+    ULONG len = ((pStubMsg->BufferLength + size - 1) & ~(size - 1)) + size;
+
+    if (len < pStubMsg->BufferLength) RpcRaiseException(RPC_X_BAD_STUB_DATA);
+    pStubMsg->BufferLength = len;
+}
+
+static inline void flat_basetype_marshall( PMIDL_STUB_MESSAGE pStubMsg, const unsigned char *pMemory,
+                                           unsigned int size )
+{
+    unsigned char *buffer = align_buffer( pStubMsg->Buffer, size );
+
+    if (buffer + size > (unsigned char *)pStubMsg->RpcMsg->Buffer + pStubMsg->BufferLength)
+        RpcRaiseException(RPC_X_BAD_STUB_DATA);
+    memset( pStubMsg->Buffer, 0, buffer - pStubMsg->Buffer );
+    memcpy( buffer, pMemory, size );
+    pStubMsg->Buffer = buffer + size;
+}
+
+static inline void flat_basetype_unmarshall( PMIDL_STUB_MESSAGE pStubMsg, unsigned char **ppMemory,
+                                             unsigned int size )
+{
+    unsigned char *buffer = align_buffer( pStubMsg->Buffer, size );
+
+    if (!pStubMsg->IsClient && !*ppMemory)
+    {
+        /* point directly into the buffer */
+        if (buffer + size > (unsigned char *)pStubMsg->RpcMsg->Buffer + pStubMsg->BufferLength)
+            RpcRaiseException(RPC_X_BAD_STUB_DATA);
+        *ppMemory = buffer;
+    }
+    else
+    {
+        if (buffer + size > pStubMsg->BufferEnd) RpcRaiseException(RPC_X_BAD_STUB_DATA);
+        memcpy( *ppMemory, buffer, size );
+    }
+    pStubMsg->Buffer = buffer + size;
+}
+
 static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char *pMemory,
                                      const NDR_PARAM_OIF *param)
 {
@@ -63,6 +138,13 @@ static inline void call_buffer_sizer(PMIDL_STUB_MESSAGE pStubMsg, unsigned char
 
     if (param->attr.IsBasetype)
     {
+        unsigned int size = flat_basetype_size( param->u.type_format_char );
+
+        if (size)
+        {
+            flat_basetype_buffer_size( pStubMsg, size );
+            return;
+        }
         pFormat = &param->u.type_format_char;
         if (param->attr.IsSimpleRef) pMemory = *(unsigned char **)pMemory;
     }
@@ -89,8 +171,15 @@ static inline unsigned char *call_marshaller(PMIDL_STUB_MESSAGE pStubMsg, unsign
 
     if (param->attr.IsBasetype)
     {
-        pFormat = &param->u.type_format_char;
+        unsigned int size = flat_basetype_size( param->u.type_format_char );
+
         if (param->attr.IsSimpleRef) pMemory = *(unsigned char **)pMemory;
+        if (size)
+        {
+            flat_basetype_marshall( pStubMsg, pMemory, size );
+            return NULL;
+        }
+        pFormat = &param->u.type_format_char;
     }
     else
     {
@@ -116,8 +205,15 @@ static inline unsigned char *call_unmarshaller(PMIDL_STUB_MESSAGE pStubMsg, unsi
 
     if (param->attr.IsBasetype)
     {
-        pFormat = &param->u.type_format_char;
+        unsigned int size = flat_basetype_size( param->u.type_format_char );
+
         if (param->attr.IsSimpleRef) ppMemory = (unsigned char **)*ppMemory;
+        if (size && !fMustAlloc)
+        {
+            flat_basetype_unmarshall( pStubMsg, ppMemory, size );
+            return NULL;
+        }
+        pFormat = &param->u.type_format_char;
     }
     else
     {
@@ -29,9 +29,15 @@
 #ifdef HAVE_SYS_STAT_H
 # include <sys/stat.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
 #endif
+#ifdef HAVE_SYS_IOCTL_H
+# include <sys/ioctl.h>
+#endif
 
 #define COBJMACROS
 #define ATL_INITGUID
@@ -45,12 +51,17 @@
 #include "winternl.h"
 #include "wine/unicode.h"
 #include "wine/library.h"
+#include "wine/server.h"
 #include "wine/debug.h"
 #include "ole2.h"
 #include "atliface.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(setupapi);
 
+#if defined(__linux__) && !defined(FICLONE)
+#define FICLONE _IOW( 0x94, 9, int )
+#endif
+
 static const char builtin_signature[] = "Wine builtin DLL";
 static const char fakedll_signature[] = "Wine placeholder DLL";
 
@@ -190,12 +201,21 @@ failed:
     return FALSE;
 }
 
-/* read in the contents of a file into the global file buffer */
+/* unmap the file mapped by read_file */
+static void unmap_file(void)
+{
+    if (file_buffer) munmap( file_buffer, file_buffer_size );
+    file_buffer = NULL;
+}
+
+/* map the contents of a file as the global file buffer */
+/* only the pages that are accessed get read, so a reflinked copy doesn't read the data at all */
 /* return 1 on success, 0 on nonexistent file, -1 on other error */
 static int read_file( const char *name, void **data, SIZE_T *size, BOOL expect_builtin )
 {
     struct stat st;
     int fd, ret = -1;
+    void *map;
     size_t header_size;
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
@@ -206,20 +226,15 @@ static int read_file( const char *name, void **data, SIZE_T *size, BOOL expect_b
     if ((fd = open( name, O_RDONLY | O_BINARY )) == -1) return 0;
     if (fstat( fd, &st ) == -1) goto done;
     *size = st.st_size;
-    if (!file_buffer || st.st_size > file_buffer_size)
-    {
-        VirtualFree( file_buffer, 0, MEM_RELEASE );
-        file_buffer = NULL;
-        file_buffer_size = st.st_size;
-        if (NtAllocateVirtualMemory( GetCurrentProcess(), &file_buffer, 0, &file_buffer_size,
-                                     MEM_COMMIT, PAGE_READWRITE )) goto done;
-    }
 
     /* check for valid fake dll file */
 
     if (st.st_size < min_size) goto done;
+    if ((map = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 )) == MAP_FAILED) goto done;
+    unmap_file();
+    file_buffer = map;
+    file_buffer_size = st.st_size;
     header_size = min( st.st_size, 4096 );
-    if (pread( fd, file_buffer, header_size, 0 ) != header_size) goto done;
     dos = file_buffer;
     if (dos->e_magic != IMAGE_DOS_SIGNATURE) goto done;
     if (dos->e_lfanew < strlen(signature) + 1) goto done;
@@ -233,13 +248,8 @@ static int read_file( const char *name, void **data, SIZE_T *size, BOOL expect_b
         ret = 0;
         goto done;
     }
-    if (st.st_size == header_size ||
-        pread( fd, (char *)file_buffer + header_size,
-               st.st_size - header_size, header_size ) == st.st_size - header_size)
-    {
-        *data = file_buffer;
-        ret = 1;
-    }
+    *data = file_buffer;
+    ret = 1;
 done:
     close( fd );
     return ret;
@@ -394,7 +404,8 @@ static inline char *prepend( char *buffer, const char *str, size_t len )
 }
 
 /* try to load a pre-compiled fake dll */
-static void *load_fake_dll( const WCHAR *name, SIZE_T *size )
+/* on success, the Unix path of the file is returned in *source and must be freed by the caller */
+static void *load_fake_dll( const WCHAR *name, SIZE_T *size, char **source )
 {
     const char *build_dir = wine_get_build_dir();
     const char *path;
@@ -456,11 +467,49 @@ static void *load_fake_dll( const WCHAR *name, SIZE_T *size )
     }
 
 done:
+    if (res == 1)
+    {
+        *source = file;
+        memmove( file, ptr, strlen(ptr) + 1 );
+        return data;
+    }
     HeapFree( GetProcessHeap(), 0, file );
-    if (res == 1) return data;
     return NULL;
 }
 
+/* try to share the data blocks of the source file with the destination (reflink) */
+static BOOL clone_fake_dll( HANDLE h, const char *source, SIZE_T size )
+{
+#ifdef FICLONE
+    int src_fd, dst_fd;
+    unsigned int needs_close;
+    struct stat st;
+    BOOL ret = FALSE;
+
+    if ((src_fd = open( source, O_RDONLY | O_BINARY )) == -1) return FALSE;
+    if (!wine_server_handle_to_fd( h, FILE_WRITE_DATA, &dst_fd, &needs_close ))
+    {
+        ret = !ioctl( dst_fd, FICLONE, src_fd );
+        if (ret) ret = (!fstat( dst_fd, &st ) && st.st_size == size);
+        if (needs_close) close( dst_fd );
+    }
+    close( src_fd );
+    if (ret) TRACE( "cloned %s\n", debugstr_a(source) );
+    return ret;
+#else
+    return FALSE;
+#endif
+}
+
+/* write the contents of a fake dll to the destination file */
+static BOOL write_fake_dll( HANDLE h, const char *source, const void *data, SIZE_T size )
+{
+    DWORD written;
+
+    if (clone_fake_dll( h, source, size )) return TRUE;
+    return WriteFile( h, data, size, &written, NULL ) && written == size;
+}
+
 /* create the fake dll destination file */
 static HANDLE create_dest_file( const WCHAR *name )
 {
@@ -856,7 +905,6 @@ static int install_fake_dll( WCHAR *dest, char *file, const char *ext, BOOL expe
     int ret;
     SIZE_T size;
     void *data;
-    DWORD written;
     WCHAR *destname = dest + strlenW(dest);
     char *name = strrchr( file, '/' ) + 1;
     char *end = name + strlen(name);
@@ -876,7 +924,7 @@ static int install_fake_dll( WCHAR *dest, char *file, const char *ext, BOOL expe
         {
             TRACE( "%s -> %s\n", debugstr_a(file), debugstr_w(dest) );
 
-            ret = (WriteFile( h, data, size, &written, NULL ) && written == size);
+            ret = write_fake_dll( h, file, data, size );
             if (!ret) ERR( "failed to write to %s (error=%u)\n", debugstr_w(dest), GetLastError() );
             CloseHandle( h );
             if (ret) register_fake_dll( dest, data, size );
@@ -969,6 +1017,7 @@ BOOL create_fake_dll( const WCHAR *name, const WCHAR *source )
     BOOL ret;
     SIZE_T size;
     const WCHAR *filename;
+    char *source_file;
     void *buffer;
 
     if (!(filename = strrchrW( name, '\\' ))) filename = name;
@@ -993,13 +1042,12 @@ BOOL create_fake_dll( const WCHAR *name, const WCHAR *source )
         TRACE( "deleting %s\n", debugstr_w(name) );
         ret = FALSE;
     }
-    else if ((buffer = load_fake_dll( source, &size )))
+    else if ((buffer = load_fake_dll( source, &size, &source_file )))
     {
-        DWORD written;
-
-        ret = (WriteFile( h, buffer, size, &written, NULL ) && written == size);
+        ret = write_fake_dll( h, source_file, buffer, size );
         if (ret) register_fake_dll( name, buffer, size );
         else ERR( "failed to write to %s (error=%u)\n", debugstr_w(name), GetLastError() );
+        HeapFree( GetProcessHeap(), 0, source_file );
     }
     else
     {
@@ -1018,8 +1066,7 @@ BOOL create_fake_dll( const WCHAR *name, const WCHAR *source )
  */
 void cleanup_fake_dlls(void)
 {
-    if (file_buffer) VirtualFree( file_buffer, 0, MEM_RELEASE );
-    file_buffer = NULL;
+    unmap_file();
     HeapFree( GetProcessHeap(), 0, handled_dlls );
     handled_dlls = NULL;
     handled_count = handled_total = 0;
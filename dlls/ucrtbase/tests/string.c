@@ -145,6 +145,8 @@ static void _test_strtod_str(int line, const char* string, double value, int len
 
 static void test_strtod(void)
 {
+    char buf[1024];
+
     test_strtod_str("infinity", INFINITY, 8);
     test_strtod_str("INFINITY", INFINITY, 8);
     test_strtod_str("InFiNiTy", INFINITY, 8);
@@ -174,6 +176,28 @@ static void test_strtod(void)
     test_strtod_str("0x1.1p1", 2.125, 7);
     test_strtod_str("0x1.A", 1.625, 5);
     test_strtod_str("0x1p1a", 2, 5);
+
+    /* correct rounding */
+    test_strtod_str("0.1", 0.1, 3);
+    test_strtod_str("1e23", 1e23, 4);
+    test_strtod_str("8.98846567431158e307", 8.98846567431158e307, 20);
+    test_strtod_str("1.7976931348623157e308", 1.7976931348623157e308, 22);
+    test_strtod_str("2.2250738585072011e-308", 2.2250738585072011e-308, 23);
+    test_strtod_str("4.9406564584124654e-324", 4.9406564584124654e-324, 23);
+    test_strtod_str("9007199254740993", 9007199254740992.0, 16);
+    test_strtod_str("9007199254740995", 9007199254740996.0, 16);
+    test_strtod_str("9007199254740993.0000000001", 9007199254740994.0, 27);
+    test_strtod_str("0x1.00000000000008p0", 1.0, 20);
+    test_strtod_str("0x1.000000000000081p0", 1.0000000000000002, 21);
+
+    /* digits far beyond the precision still break ties */
+    memset(buf, '0', sizeof(buf));
+    memcpy(buf, "9007199254740993.", 17);
+    buf[sizeof(buf) - 2] = '1';
+    buf[sizeof(buf) - 1] = 0;
+    test_strtod_str(buf, 9007199254740994.0, sizeof(buf) - 1);
+    buf[sizeof(buf) - 2] = '0';
+    test_strtod_str(buf, 9007199254740992.0, sizeof(buf) - 1);
 }
 
 static void test__memicmp(void)
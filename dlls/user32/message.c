@@ -2740,6 +2740,98 @@ static inline void call_sendmsg_callback( SENDASYNCPROC callback, HWND hwnd, UIN
 }
 
 
+/***********************************************************************
+ *           map_queue_shm
+ *
+ * Map the queue state that the server shares with the current thread.
+ */
+static void map_queue_shm(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    HANDLE handle = 0;
+    SIZE_T size = 0;
+    void *ptr = NULL;
+
+    SERVER_START_REQ( get_queue_shm )
+    {
+        if (!wine_server_call( req )) handle = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (!handle) return;
+    if (!NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &size,
+                             ViewShare, 0, PAGE_READONLY ))
+        thread_info->queue_shm = ptr;
+    CloseHandle( handle );
+}
+
+
+/***********************************************************************
+ *           get_queue_state
+ *
+ * Get a consistent copy of the queue state shared with the server.
+ */
+BOOL get_queue_state( struct queue_shm *state )
+{
+    const volatile struct queue_shm *shm = get_user_thread_info()->queue_shm;
+    int seq;
+
+    if (!shm) return FALSE;
+    do
+    {
+        /* the acquire load orders the field reads after the sequence check */
+        while ((seq = __atomic_load_n( &shm->seq, __ATOMIC_ACQUIRE )) & 1) NtYieldExecution();
+        state->wake_bits     = shm->wake_bits;
+        state->changed_bits  = shm->changed_bits;
+        state->wake_mask     = shm->wake_mask;
+        state->changed_mask  = shm->changed_mask;
+        state->hooks_changed = shm->hooks_changed;
+        state->last_get_msg  = shm->last_get_msg;
+        /* and the fence orders them before the sequence is read again */
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    } while (shm->seq != seq);
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           is_queue_empty
+ *
+ * Check from the shared queue state whether a get_message request would
+ * fail without changing anything, so that we can skip the server call.
+ */
+static BOOL is_queue_empty( HWND hwnd, UINT first, UINT last, UINT flags, UINT changed_mask )
+{
+    struct queue_shm state;
+    UINT filter = flags >> 16, clear_bits = 0;
+    LARGE_INTEGER now;
+
+    /* the server sets the idle event for these */
+    if (wine_server_user_handle( hwnd ) == -1) return FALSE;
+    if (!get_queue_state( &state )) return FALSE;
+    if (state.hooks_changed) return FALSE;
+
+    /* make sure the server still sees regular calls, otherwise the queue looks hung */
+    NtQuerySystemTime( &now );
+    if (now.QuadPart < state.last_get_msg || now.QuadPart - state.last_get_msg > 10000000) return FALSE;
+
+    if (!filter) filter = QS_ALLINPUT;
+    if (state.wake_bits & (filter | QS_SENDMESSAGE)) return FALSE;
+
+    /* the changed bits would be cleared by the server */
+    if (filter & QS_POSTMESSAGE)
+    {
+        clear_bits |= QS_POSTMESSAGE | QS_HOTKEY | QS_TIMER;
+        if (!first && last == ~0U) clear_bits |= QS_ALLPOSTMESSAGE;
+    }
+    if (filter & QS_INPUT) clear_bits |= QS_INPUT;
+    if (filter & QS_PAINT) clear_bits |= QS_PAINT;
+    if (state.changed_bits & clear_bits) return FALSE;
+
+    return (state.wake_mask == (changed_mask & (QS_SENDMESSAGE | QS_SMRESULT)) &&
+            state.changed_mask == changed_mask);
+}
+
+
 /***********************************************************************
  *           peek_message
  *
@@ -2756,11 +2848,18 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     void *buffer;
     size_t buffer_size = 256;
 
-    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
-
     if (!first && !last) last = ~0;
     if (hwnd == HWND_BROADCAST) hwnd = HWND_TOPMOST;
 
+    if (is_queue_empty( hwnd, first, last, flags, changed_mask ))
+    {
+        thread_info->wake_mask = changed_mask & (QS_SENDMESSAGE | QS_SMRESULT);
+        thread_info->changed_mask = changed_mask;
+        return FALSE;
+    }
+
+    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
+
     for (;;)
     {
         NTSTATUS res;
@@ -2804,6 +2903,7 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
             {
                 thread_info->wake_mask = changed_mask & (QS_SENDMESSAGE | QS_SMRESULT);
                 thread_info->changed_mask = changed_mask;
+                if (!thread_info->queue_shm) map_queue_shm();
             }
             if (res != STATUS_BUFFER_OVERFLOW) return FALSE;
             if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
@@ -12411,6 +12411,56 @@ static void test_PeekMessage3(void)
     flush_events();
 }
 
+static DWORD WINAPI post_message_thread(void *arg)
+{
+    DWORD tid = (DWORD_PTR)arg;
+
+    Sleep(50);
+    PostThreadMessageA(tid, WM_USER + 1, 0, 0);
+    return 0;
+}
+
+static void test_PeekMessage4(void)
+{
+    DWORD status, start;
+    HANDLE thread;
+    BOOL ret;
+    MSG msg;
+
+    flush_events();
+
+    /* messages posted from another thread must show up while polling an empty queue */
+
+    ret = PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE);
+    ok(!ret, "expected PeekMessage to return FALSE, got %u\n", ret);
+    status = GetQueueStatus(QS_POSTMESSAGE);
+    ok(!status, "GetQueueStatus returned %08x\n", status);
+
+    thread = CreateThread(NULL, 0, post_message_thread, (void *)(DWORD_PTR)GetCurrentThreadId(), 0, NULL);
+    ok(thread != NULL, "CreateThread failed: %u\n", GetLastError());
+    start = GetTickCount();
+    while (!(ret = PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE)) && GetTickCount() - start < 5000);
+    ok(ret && msg.message == WM_USER + 1, "msg.message = %u instead of WM_USER + 1\n", msg.message);
+    ret = PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE);
+    ok(!ret, "expected PeekMessage to return FALSE, got %u\n", ret);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+
+    thread = CreateThread(NULL, 0, post_message_thread, (void *)(DWORD_PTR)GetCurrentThreadId(), 0, NULL);
+    ok(thread != NULL, "CreateThread failed: %u\n", GetLastError());
+    start = GetTickCount();
+    while (!(status = GetQueueStatus(QS_POSTMESSAGE)) && GetTickCount() - start < 5000);
+    ok(status == MAKELONG(QS_POSTMESSAGE, QS_POSTMESSAGE), "GetQueueStatus returned %08x\n", status);
+    status = GetQueueStatus(QS_POSTMESSAGE);
+    ok(status == MAKELONG(0, QS_POSTMESSAGE), "GetQueueStatus returned %08x\n", status);
+    ret = PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE);
+    ok(ret && msg.message == WM_USER + 1, "msg.message = %u instead of WM_USER + 1\n", msg.message);
+    status = GetQueueStatus(QS_POSTMESSAGE);
+    ok(!status, "GetQueueStatus returned %08x\n", status);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
 static INT_PTR CALLBACK wm_quit_dlg_proc(HWND hwnd, UINT message, WPARAM wp, LPARAM lp)
 {
     struct recvd_message msg;
@@ -17612,6 +17662,7 @@ START_TEST(msg)
     test_PeekMessage();
     test_PeekMessage2();
     test_PeekMessage3();
+    test_PeekMessage4();
     test_WaitForInputIdle( test_argv[0] );
     test_scrollwindowex();
     test_messages();
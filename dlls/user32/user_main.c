@@ -380,6 +380,7 @@ static void thread_detach(void)
 
     destroy_thread_windows();
     CloseHandle( thread_info->server_queue );
+    if (thread_info->queue_shm) NtUnmapViewOfSection( GetCurrentProcess(), (void *)thread_info->queue_shm );
     HeapFree( GetProcessHeap(), 0, thread_info->wmchar_data );
     HeapFree( GetProcessHeap(), 0, thread_info->key_state );
     HeapFree( GetProcessHeap(), 0, thread_info->rawinput );
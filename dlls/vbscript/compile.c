@@ -65,6 +65,7 @@ typedef struct {
     function_decl_t *func_decls;
 
     class_desc_t *classes;
+    dim_decl_t *class_props;
 } compile_ctx_t;
 
 static HRESULT compile_expression(compile_ctx_t*,expression_t*);
@@ -1324,6 +1325,90 @@ static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_d
     return S_OK;
 }
 
+/* Finds the variable an identifier refers to when it is resolved with the same
+   precedence as lookup_identifier(), if it doesn't depend on run time state. */
+static BOOL lookup_bound_var(compile_ctx_t *ctx, function_t *func, const WCHAR *name, BOOL is_let, unsigned *ret)
+{
+    dim_decl_t *prop;
+    unsigned i;
+
+    if(is_let && (func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET)
+            && !strcmpiW(name, func->name)) {
+        *ret = BOUND_REF(BOUND_RET, 0);
+        return TRUE;
+    }
+
+    for(i = 0; i < func->var_cnt; i++) {
+        if(!strcmpiW(func->vars[i].name, name)) {
+            *ret = BOUND_REF(BOUND_VAR, i);
+            return TRUE;
+        }
+    }
+
+    for(i = 0; i < func->arg_cnt; i++) {
+        if(!strcmpiW(func->args[i].name, name)) {
+            *ret = BOUND_REF(BOUND_ARG, i);
+            return TRUE;
+        }
+    }
+
+    /* constants are stored as dynamic variables, which take precedence over properties */
+    if(lookup_const_decls(ctx, name, FALSE))
+        return FALSE;
+
+    for(prop = ctx->class_props, i = 0; prop; prop = prop->next, i++) {
+        if(!strcmpiW(prop->name, name)) {
+            *ret = BOUND_REF(BOUND_PROP, i);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static void bind_identifiers(compile_ctx_t *ctx, function_t *func)
+{
+    instr_t *instr, *end = ctx->code->instrs + ctx->instr_cnt;
+    unsigned ref;
+
+    for(instr = ctx->code->instrs + func->code_off; instr < end; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+            if(lookup_bound_var(ctx, func, instr->arg1.bstr, FALSE, &ref)) {
+                instr->op = OP_icall_bound;
+                instr->arg1.uint = ref;
+            }
+            break;
+        case OP_assign_ident:
+            if(lookup_bound_var(ctx, func, instr->arg1.bstr, TRUE, &ref)) {
+                instr->op = OP_assign_bound;
+                instr->arg1.uint = ref;
+            }
+            break;
+        case OP_set_ident:
+            if(lookup_bound_var(ctx, func, instr->arg1.bstr, TRUE, &ref)) {
+                instr->op = OP_set_bound;
+                instr->arg1.uint = ref;
+            }
+            break;
+        case OP_incc:
+            if(lookup_bound_var(ctx, func, instr->arg1.bstr, TRUE, &ref)) {
+                instr->op = OP_incc_bound;
+                instr->arg1.uint = ref;
+            }
+            break;
+        case OP_step:
+            if(lookup_bound_var(ctx, func, instr->arg2.bstr, FALSE, &ref)) {
+                instr->op = OP_step_bound;
+                instr->arg2.uint = ref;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *func)
 {
     HRESULT hres;
@@ -1436,6 +1521,10 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         assert(array_id == func->array_cnt);
     }
 
+    /* variables of the global code are script wide dynamic variables, they are still looked up by name */
+    if(func->type != FUNC_GLOBAL)
+        bind_identifiers(ctx, func);
+
     return S_OK;
 }
 
@@ -1611,6 +1700,8 @@ static HRESULT compile_class(compile_ctx_t *ctx, class_decl_t *class_decl)
         return E_OUTOFMEMORY;
     memset(class_desc->funcs, 0, class_desc->func_cnt*sizeof(*class_desc->funcs));
 
+    ctx->class_props = class_decl->props;
+
     for(func_decl = class_decl->funcs, i=1; func_decl; func_decl = func_decl->next, i++) {
         for(func_prop_decl = func_decl; func_prop_decl; func_prop_decl = func_prop_decl->next_prop_func) {
             if(func_prop_decl->type == FUNC_DEFGET) {
@@ -1640,6 +1731,8 @@ static HRESULT compile_class(compile_ctx_t *ctx, class_decl_t *class_decl)
             return hres;
     }
 
+    ctx->class_props = NULL;
+
     for(prop_decl = class_decl->props; prop_decl; prop_decl = prop_decl->next)
         class_desc->prop_cnt++;
 
@@ -1818,6 +1911,7 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *deli
     ctx.func_decls = NULL;
     ctx.global_vars = NULL;
     ctx.classes = NULL;
+    ctx.class_props = NULL;
     ctx.labels = NULL;
     ctx.global_consts = NULL;
     ctx.stat_ctx = NULL;
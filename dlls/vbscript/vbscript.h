@@ -224,6 +224,7 @@ typedef enum {
 #define OP_LIST                                   \
     X(add,            1, 0,           0)          \
     X(and,            1, 0,           0)          \
+    X(assign_bound,   1, ARG_UINT,    ARG_UINT)   \
     X(assign_ident,   1, ARG_BSTR,    ARG_UINT)   \
     X(assign_member,  1, ARG_BSTR,    ARG_UINT)   \
     X(bool,           1, ARG_INT,     0)          \
@@ -244,10 +245,12 @@ typedef enum {
     X(gt,             1, 0,           0)          \
     X(gteq,           1, 0,           0)          \
     X(icall,          1, ARG_BSTR,    ARG_UINT)   \
+    X(icall_bound,    1, ARG_UINT,    ARG_UINT)   \
     X(icallv,         1, ARG_BSTR,    ARG_UINT)   \
     X(idiv,           1, 0,           0)          \
     X(imp,            1, 0,           0)          \
     X(incc,           1, ARG_BSTR,    0)          \
+    X(incc_bound,     1, ARG_UINT,    0)          \
     X(is,             1, 0,           0)          \
     X(jmp,            0, ARG_ADDR,    0)          \
     X(jmp_false,      0, ARG_ADDR,    0)          \
@@ -270,10 +273,12 @@ typedef enum {
     X(or,             1, 0,           0)          \
     X(pop,            1, ARG_UINT,    0)          \
     X(ret,            0, 0,           0)          \
+    X(set_bound,      1, ARG_UINT,    ARG_UINT)   \
     X(set_ident,      1, ARG_BSTR,    ARG_UINT)   \
     X(set_member,     1, ARG_BSTR,    ARG_UINT)   \
     X(short,          1, ARG_INT,     0)          \
     X(step,           0, ARG_ADDR,    ARG_BSTR)   \
+    X(step_bound,     0, ARG_ADDR,    ARG_UINT)   \
     X(stop,           1, 0,           0)          \
     X(string,         1, ARG_STR,     0)          \
     X(sub,            1, 0,           0)          \
@@ -287,6 +292,19 @@ OP_LIST
     OP_LAST
 } vbsop_t;
 
+/* Identifiers bound by the compiler to a variable of the executed function
+   are referenced by *_bound instructions as a type and an index. */
+typedef enum {
+    BOUND_VAR,  /* local variable */
+    BOUND_ARG,  /* argument */
+    BOUND_PROP, /* property of the class instance */
+    BOUND_RET   /* return value of the function */
+} bound_type_t;
+
+#define BOUND_REF(type,idx) (((type) << 24) | (idx))
+#define BOUND_REF_TYPE(ref) ((ref) >> 24)
+#define BOUND_REF_IDX(ref)  ((ref) & 0xffffff)
+
 typedef union {
     const WCHAR *str;
     BSTR bstr;
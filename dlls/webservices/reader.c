@@ -1067,6 +1067,21 @@ static inline HRESULT read_utf8_char( struct reader *reader, unsigned int *ret,
     return WS_E_INVALID_FORMAT;
 }
 
+/* skips ASCII characters other than 'delim' in the data that is already available, so
+   that only non-ASCII characters have to go through read_utf8_char() */
+static inline unsigned int read_skip_ascii( struct reader *reader, unsigned char delim )
+{
+    const unsigned char *start = read_current_ptr( reader ), *ptr = start;
+    const unsigned char *end = reader->read_bufptr + reader->read_size;
+    unsigned int count;
+
+    while (ptr < end && *ptr < 0x80 && *ptr != delim) ptr++;
+
+    count = ptr - start;
+    read_skip( reader, count );
+    return count;
+}
+
 static inline BOOL read_isnamechar( unsigned int ch )
 {
     /* FIXME: incomplete */
@@ -1332,8 +1347,16 @@ static HRESULT decode_text( const unsigned char *str, ULONG len, unsigned char *
         }
         else
         {
-            *q++ = *p++;
-            len--;
+            /* copy everything up to the next reference at once */
+            const unsigned char *amp = memchr( p, '&', len );
+            ULONG run = amp ? amp - p : len;
+
+            memcpy( q, p, run );
+            p += run;
+            q += run;
+            len -= run;
+            *ret_len += run;
+            continue;
         }
         *ret_len += 1;
     }
@@ -1360,6 +1383,7 @@ static HRESULT read_attribute_value_text( struct reader *reader, WS_XML_ATTRIBUT
     start = read_current_ptr( reader );
     for (;;)
     {
+        len += read_skip_ascii( reader, quote );
         if ((hr = read_utf8_char( reader, &ch, &skip )) != S_OK) return hr;
         if (ch == quote) break;
         read_skip( reader, skip );
@@ -2163,6 +2187,7 @@ static HRESULT read_text_text( struct reader *reader )
     start = read_current_ptr( reader );
     for (;;)
     {
+        len += read_skip_ascii( reader, '<' );
         if (read_end_of_data( reader )) break;
         if ((hr = read_utf8_char( reader, &ch, &skip )) != S_OK) return hr;
         if (ch == '<') break;
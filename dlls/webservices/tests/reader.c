@@ -4005,12 +4005,14 @@ static void test_entities(void)
     static const char str33[] = "<t>&#x110000;</t>";
     static const char str34[] = "<t>&#1114111;</t>";
     static const char str35[] = "<t>&#1114112;</t>";
+    static const char str36[] = "<t>a &lt; b\xc3\xa9" "c &amp;d</t>";
     static const char res4[] = {0xea, 0xaa, 0xaa, 0x00};
     static const char res5[] = {0xf2, 0xaa, 0xaa, 0xaa, 0x00};
     static const char res21[] = {0xed, 0x9f, 0xbf, 0x00};
     static const char res24[] = {0xee, 0x80, 0x80, 0x00};
     static const char res31[] = {0xef, 0xbd, 0xb1, 0x00};
     static const char res32[] = {0xf4, 0x8f, 0xbf, 0xbf, 0x00};
+    static const char res36[] = "a < b\xc3\xa9" "c &d";
     static const struct
     {
         const char *str;
@@ -4054,6 +4056,7 @@ static void test_entities(void)
         { str33, WS_E_INVALID_FORMAT },
         { str34, S_OK, res32 },
         { str35, WS_E_INVALID_FORMAT },
+        { str36, S_OK, res36 },
     };
     HRESULT hr;
     WS_XML_READER *reader;
@@ -1013,15 +1013,63 @@ static void fixup_buffer_cr(encoded_buffer *buffer, int off)
     *dest = 0;
 }
 
+/* Converts UTF-8 data in one pass. Runs of ASCII characters are copied directly,
+   only the remaining runs are passed to MultiByteToWideChar. ASCII bytes never appear
+   inside multibyte sequences, so splitting there doesn't change the result.
+   Each byte produces at most one WCHAR, so 'dest' needs room for 'len' characters. */
+static int utf8_to_utf16(const char *src, int len, WCHAR *dest)
+{
+    const unsigned char *ptr = (const unsigned char *)src, *end = ptr + len, *start;
+    WCHAR *out = dest;
+
+    while (ptr < end)
+    {
+        while (ptr < end && *ptr < 0x80)
+            *out++ = *ptr++;
+
+        start = ptr;
+        while (ptr < end && *ptr >= 0x80)
+            ptr++;
+        if (ptr > start)
+            out += MultiByteToWideChar(CP_UTF8, 0, (const char *)start, ptr - start, out, ptr - start);
+    }
+
+    return out - dest;
+}
+
+/* converts 'len' bytes of raw data and appends them to UTF-16 buffer */
+static void readerinput_convert(xmlreaderinput *readerinput, UINT cp, int len)
+{
+    encoded_buffer *src = &readerinput->buffer->encoded;
+    encoded_buffer *dest = &readerinput->buffer->utf16;
+    int dest_len;
+    WCHAR *ptr;
+
+    if (cp == CP_UTF8)
+    {
+        readerinput_grow(readerinput, len);
+        ptr = (WCHAR*)(dest->data + dest->written);
+        dest_len = utf8_to_utf16(src->data + src->cur, len, ptr);
+    }
+    else
+    {
+        dest_len = MultiByteToWideChar(cp, 0, src->data + src->cur, len, NULL, 0);
+        readerinput_grow(readerinput, dest_len);
+        ptr = (WCHAR*)(dest->data + dest->written);
+        MultiByteToWideChar(cp, 0, src->data + src->cur, len, ptr, dest_len);
+    }
+    ptr[dest_len] = 0;
+    dest->written += dest_len*sizeof(WCHAR);
+}
+
 /* note that raw buffer content is kept */
 static void readerinput_switchencoding(xmlreaderinput *readerinput, xml_encoding enc)
 {
     encoded_buffer *src = &readerinput->buffer->encoded;
     encoded_buffer *dest = &readerinput->buffer->utf16;
-    int len, dest_len;
+    int len;
     UINT cp = ~0u;
     HRESULT hr;
-    WCHAR *ptr;
 
     hr = get_code_page(enc, &cp);
     if (FAILED(hr)) return;
@@ -1039,14 +1087,7 @@ static void readerinput_switchencoding(xmlreaderinput *readerinput, xml_encoding
         dest->written += len*sizeof(WCHAR);
     }
     else
-    {
-        dest_len = MultiByteToWideChar(cp, 0, src->data + src->cur, len, NULL, 0);
-        readerinput_grow(readerinput, dest_len);
-        ptr = (WCHAR*)dest->data;
-        MultiByteToWideChar(cp, 0, src->data + src->cur, len, ptr, dest_len);
-        ptr[dest_len] = 0;
-        dest->written += dest_len*sizeof(WCHAR);
-    }
+        readerinput_convert(readerinput, cp, len);
 
     fixup_buffer_cr(dest, 0);
 }
@@ -1074,9 +1115,8 @@ static HRESULT reader_more(xmlreader *reader)
     encoded_buffer *src = &readerinput->buffer->encoded;
     encoded_buffer *dest = &readerinput->buffer->utf16;
     UINT cp = readerinput->buffer->code_page;
-    int len, dest_len, prev_len;
+    int len, prev_len;
     HRESULT hr;
-    WCHAR *ptr;
 
     /* get some raw data from stream first */
     hr = readerinput_growraw(readerinput);
@@ -1092,12 +1132,7 @@ static HRESULT reader_more(xmlreader *reader)
     }
     else
     {
-        dest_len = MultiByteToWideChar(cp, 0, src->data + src->cur, len, NULL, 0);
-        readerinput_grow(readerinput, dest_len);
-        ptr = (WCHAR*)(dest->data + dest->written);
-        MultiByteToWideChar(cp, 0, src->data + src->cur, len, ptr, dest_len);
-        ptr[dest_len] = 0;
-        dest->written += dest_len*sizeof(WCHAR);
+        readerinput_convert(readerinput, cp, len);
         /* get rid of processed data */
         readerinput_shrinkraw(readerinput, len);
     }
@@ -2446,6 +2481,25 @@ static HRESULT reader_parse_cdata(xmlreader *reader)
     return S_OK;
 }
 
+/* Moves cursor over a run of character data that has no markup, references, ']' or
+   line breaks in it, so reader_parse_chardata() doesn't have to go char by char.
+   Returns number of skipped characters. */
+static UINT reader_skip_chardata(xmlreader *reader)
+{
+    encoded_buffer *buffer = &reader->input->buffer->utf16;
+    const WCHAR *start = (WCHAR*)buffer->data + buffer->cur, *ptr = start;
+
+    while (*ptr && *ptr != '<' && *ptr != '&' && *ptr != ']' && *ptr != '\r' && *ptr != '\n')
+    {
+        if (*ptr != ' ' && *ptr != '\t') reader->nodetype = XmlNodeType_Text;
+        ptr++;
+    }
+
+    buffer->cur += ptr - start;
+    reader->position.line_position += ptr - start;
+    return ptr - start;
+}
+
 /* [14] CharData ::= [^<&]* - ([^<&]* ']]>' [^<&]*) */
 static HRESULT reader_parse_chardata(xmlreader *reader)
 {
@@ -2498,7 +2552,7 @@ static HRESULT reader_parse_chardata(xmlreader *reader)
 
         if (!reader_cmp(reader, ampW))
             reader_parse_reference(reader);
-        else
+        else if (!reader_skip_chardata(reader))
             reader_skipn(reader, 1);
 
         ptr = reader_get_ptr(reader);
@@ -1751,6 +1751,9 @@ static struct test_entry text_tests[] = {
     { "<a>text ]]> text</a>", "", "", WC_E_CDSECTEND },
     { "<a>\n \r\n \n\n text</a>", "", "\n \n \n\n text", S_OK, S_OK },
     { "<a>\r \r\r\n \n\n text</a>", "", "\n \n\n \n\n text", S_OK, S_OK },
+    { "<a>a]b ] c]]d</a>", "", "a]b ] c]]d", S_OK },
+    { "<a> \t text &amp; more\ttext</a>", "", " \t text & more\ttext", S_OK },
+    { "<a>text ]]]> text</a>", "", "", WC_E_CDSECTEND },
     { NULL }
 };
 
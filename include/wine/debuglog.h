@@ -0,0 +1,73 @@
+/*
+ * Binary debug log format
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#ifndef __WINE_WINE_DEBUGLOG_H
+#define __WINE_WINE_DEBUGLOG_H
+
+/* When WINEDEBUGLOG is set, ntdll stores debug lines in a memory-mapped
+ * file instead of writing them to stderr. The file is split in chunks;
+ * each thread owns one chunk at a time and appends records to it without
+ * locking. Once all chunks have been used, free chunks are reused in
+ * order, so the file behaves as a ring buffer. "winedump dump" renders
+ * the records in the usual text format.
+ */
+
+#define DEBUGLOG_MAGIC       0x474c4457  /* "WDLG" */
+#define DEBUGLOG_VERSION     1
+#define DEBUGLOG_CHUNK_SIZE  0x10000
+#define DEBUGLOG_FILE_SIZE   (1024 * DEBUGLOG_CHUNK_SIZE)
+
+#define DEBUGLOG_NO_HEADER   0xff    /* cls value for lines printed without a header */
+
+/* file header, chunks follow at DEBUGLOG_CHUNK_SIZE offsets */
+struct debuglog_header
+{
+    UINT       magic;         /* DEBUGLOG_MAGIC */
+    UINT       version;       /* DEBUGLOG_VERSION */
+    UINT       chunk_size;    /* size of a chunk, including its header */
+    UINT       chunk_count;   /* number of chunks in the file */
+    UINT       pid;           /* Windows process id */
+    LONG       next_seq;      /* sequence number of the next chunk to claim */
+    LONG       lost;          /* number of lines dropped because no chunk was free */
+    UINT       __pad;
+    ULONGLONG  freq;          /* frequency of the record timestamps */
+};
+
+struct debuglog_chunk
+{
+    LONG       owner;         /* thread currently writing to the chunk, 0 if free */
+    UINT       tid;           /* thread that wrote the records */
+    UINT       seq;           /* claim sequence number, for ordering */
+    UINT       used;          /* size of the records following the chunk header */
+};
+
+struct debuglog_record
+{
+    ULONGLONG  time;          /* performance counter value */
+    USHORT     size;          /* total record size, 8-byte aligned */
+    USHORT     text_len;      /* length of the text */
+    BYTE       cls;           /* debug class, or DEBUGLOG_NO_HEADER */
+    BYTE       channel_len;   /* length of the channel name */
+    BYTE       function_len;  /* length of the function name */
+    BYTE       __pad;
+    /* followed by the channel name, the function name and the text */
+};
+
+#endif  /* __WINE_WINE_DEBUGLOG_H */
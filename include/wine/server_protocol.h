@@ -749,6 +749,55 @@ struct rawinput_device
     user_handle_t  target;
 };
 
+/* completion port queue shared between the server and the clients, it is
+ * a bounded lock-free queue; messages that don't fit are kept in the server.
+ * Sequence numbers advance in steps of 2, the low bit of the tail is set
+ * while the server holds messages, so that nothing is added to the shared
+ * queue until those have been removed. */
+struct completion_shm_entry
+{
+    int            seq;
+    unsigned int   status;
+    apc_param_t    ckey;
+    apc_param_t    cvalue;
+    apc_param_t    information;
+};
+
+#define COMPLETION_SHM_ENTRIES 1024
+#define COMPLETION_SHM_CLOSED  1
+
+struct completion_shm
+{
+    int            head;
+    int            tail;
+    int            waiters;
+    int            __pad;
+    struct completion_shm_entry entries[COMPLETION_SHM_ENTRIES];
+};
+
+/* message queue state mapped read-only in the client, so that it can
+ * find out that the queue is empty without a server call */
+struct queue_shm
+{
+    int            seq;
+    unsigned int   wake_bits;
+    unsigned int   changed_bits;
+    unsigned int   wake_mask;
+    unsigned int   changed_mask;
+    int            hooks_changed;
+    timeout_t      last_get_msg;
+};
+
+#define REGISTRY_SHM_SLOTS 4096
+
+/* registry key generation counters mapped read-only in the client, so
+ * that it can check cached values without a server call; keys are hashed
+ * to the slots, and a slot is incremented whenever one of its keys changes */
+struct registry_shm
+{
+    unsigned int   generation[REGISTRY_SHM_SLOTS];
+};
+
 
 
 
@@ -2322,6 +2371,21 @@ struct get_mapping_info_reply
 
 
 
+struct get_relocated_image_request
+{
+    struct request_header __header;
+    obj_handle_t mapping;
+    client_ptr_t base;
+};
+struct get_relocated_image_reply
+{
+    struct reply_header __header;
+    obj_handle_t file;
+    char __pad_12[4];
+};
+
+
+
 struct map_view_request
 {
     struct request_header __header;
@@ -2593,6 +2657,22 @@ struct write_process_memory_reply
 
 
 
+struct get_process_vm_pid_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+    unsigned int access;
+    char __pad_20[4];
+};
+struct get_process_vm_pid_reply
+{
+    struct reply_header __header;
+    int          unix_pid;
+    char __pad_12[4];
+};
+
+
+
 struct create_key_request
 {
     struct request_header __header;
@@ -2703,6 +2783,8 @@ struct get_key_value_reply
     struct reply_header __header;
     int          type;
     data_size_t  total;
+    unsigned int gen_slot;
+    unsigned int generation;
     /* VARARG(data,bytes); */
 };
 
@@ -2796,6 +2878,20 @@ struct set_registry_notification_reply
 
 
 
+struct get_registry_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_registry_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+};
+
+
+
 struct create_timer_request
 {
     struct request_header __header;
@@ -3088,6 +3184,20 @@ struct get_queue_status_reply
 
 
 
+struct get_queue_shm_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_queue_shm_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+};
+
+
+
 struct get_process_idle_event_request
 {
     struct request_header __header;
@@ -5440,6 +5550,30 @@ struct remove_completion_reply
 
 
 
+struct get_completion_shm_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct get_completion_shm_reply
+{
+    struct reply_header __header;
+};
+
+
+
+struct wake_completion_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct wake_completion_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct query_completion_request
 {
     struct request_header __header;
@@ -5784,6 +5918,23 @@ struct resume_process_reply
 };
 
 
+
+struct set_server_profile_request
+{
+    struct request_header __header;
+    unsigned int flags;
+};
+struct set_server_profile_reply
+{
+    struct reply_header __header;
+    int          enabled;
+    char __pad_12[4];
+};
+#define SERVER_PROFILE_ENABLE  0x01
+#define SERVER_PROFILE_DISABLE 0x02
+#define SERVER_PROFILE_DUMP    0x04
+
+
 enum request
 {
     REQ_new_process,
@@ -5874,6 +6025,7 @@ enum request
     REQ_create_mapping,
     REQ_open_mapping,
     REQ_get_mapping_info,
+    REQ_get_relocated_image,
     REQ_map_view,
     REQ_unmap_view,
     REQ_get_mapping_committed_range,
@@ -5891,6 +6043,7 @@ enum request
     REQ_set_debugger_kill_on_exit,
     REQ_read_process_memory,
     REQ_write_process_memory,
+    REQ_get_process_vm_pid,
     REQ_create_key,
     REQ_open_key,
     REQ_delete_key,
@@ -5904,6 +6057,7 @@ enum request
     REQ_unload_registry,
     REQ_save_registry,
     REQ_set_registry_notification,
+    REQ_get_registry_shm,
     REQ_create_timer,
     REQ_open_timer,
     REQ_set_timer,
@@ -5923,6 +6077,7 @@ enum request
     REQ_set_queue_fd,
     REQ_set_queue_mask,
     REQ_get_queue_status,
+    REQ_get_queue_shm,
     REQ_get_process_idle_event,
     REQ_send_message,
     REQ_post_quit_message,
@@ -6061,6 +6216,8 @@ enum request
     REQ_open_completion,
     REQ_add_completion,
     REQ_remove_completion,
+    REQ_get_completion_shm,
+    REQ_wake_completion,
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
@@ -6084,6 +6241,7 @@ enum request
     REQ_terminate_job,
     REQ_suspend_process,
     REQ_resume_process,
+    REQ_set_server_profile,
     REQ_NB_REQUESTS
 };
 
@@ -6179,6 +6337,7 @@ union generic_request
     struct create_mapping_request create_mapping_request;
     struct open_mapping_request open_mapping_request;
     struct get_mapping_info_request get_mapping_info_request;
+    struct get_relocated_image_request get_relocated_image_request;
     struct map_view_request map_view_request;
     struct unmap_view_request unmap_view_request;
     struct get_mapping_committed_range_request get_mapping_committed_range_request;
@@ -6196,6 +6355,7 @@ union generic_request
     struct set_debugger_kill_on_exit_request set_debugger_kill_on_exit_request;
     struct read_process_memory_request read_process_memory_request;
     struct write_process_memory_request write_process_memory_request;
+    struct get_process_vm_pid_request get_process_vm_pid_request;
     struct create_key_request create_key_request;
     struct open_key_request open_key_request;
     struct delete_key_request delete_key_request;
@@ -6209,6 +6369,7 @@ union generic_request
     struct unload_registry_request unload_registry_request;
     struct save_registry_request save_registry_request;
     struct set_registry_notification_request set_registry_notification_request;
+    struct get_registry_shm_request get_registry_shm_request;
     struct create_timer_request create_timer_request;
     struct open_timer_request open_timer_request;
     struct set_timer_request set_timer_request;
@@ -6228,6 +6389,7 @@ union generic_request
     struct set_queue_fd_request set_queue_fd_request;
     struct set_queue_mask_request set_queue_mask_request;
     struct get_queue_status_request get_queue_status_request;
+    struct get_queue_shm_request get_queue_shm_request;
     struct get_process_idle_event_request get_process_idle_event_request;
     struct send_message_request send_message_request;
     struct post_quit_message_request post_quit_message_request;
@@ -6366,6 +6528,8 @@ union generic_request
     struct open_completion_request open_completion_request;
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
+    struct get_completion_shm_request get_completion_shm_request;
+    struct wake_completion_request wake_completion_request;
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
@@ -6389,6 +6553,7 @@ union generic_request
     struct terminate_job_request terminate_job_request;
     struct suspend_process_request suspend_process_request;
     struct resume_process_request resume_process_request;
+    struct set_server_profile_request set_server_profile_request;
 };
 union generic_reply
 {
@@ -6482,6 +6647,7 @@ union generic_reply
     struct create_mapping_reply create_mapping_reply;
     struct open_mapping_reply open_mapping_reply;
     struct get_mapping_info_reply get_mapping_info_reply;
+    struct get_relocated_image_reply get_relocated_image_reply;
     struct map_view_reply map_view_reply;
     struct unmap_view_reply unmap_view_reply;
     struct get_mapping_committed_range_reply get_mapping_committed_range_reply;
@@ -6499,6 +6665,7 @@ union generic_reply
     struct set_debugger_kill_on_exit_reply set_debugger_kill_on_exit_reply;
     struct read_process_memory_reply read_process_memory_reply;
     struct write_process_memory_reply write_process_memory_reply;
+    struct get_process_vm_pid_reply get_process_vm_pid_reply;
     struct create_key_reply create_key_reply;
     struct open_key_reply open_key_reply;
     struct delete_key_reply delete_key_reply;
@@ -6512,6 +6679,7 @@ union generic_reply
     struct unload_registry_reply unload_registry_reply;
     struct save_registry_reply save_registry_reply;
     struct set_registry_notification_reply set_registry_notification_reply;
+    struct get_registry_shm_reply get_registry_shm_reply;
     struct create_timer_reply create_timer_reply;
     struct open_timer_reply open_timer_reply;
     struct set_timer_reply set_timer_reply;
@@ -6531,6 +6699,7 @@ union generic_reply
     struct set_queue_fd_reply set_queue_fd_reply;
     struct set_queue_mask_reply set_queue_mask_reply;
     struct get_queue_status_reply get_queue_status_reply;
+    struct get_queue_shm_reply get_queue_shm_reply;
     struct get_process_idle_event_reply get_process_idle_event_reply;
     struct send_message_reply send_message_reply;
     struct post_quit_message_reply post_quit_message_reply;
@@ -6669,6 +6838,8 @@ union generic_reply
     struct open_completion_reply open_completion_reply;
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
+    struct get_completion_shm_reply get_completion_shm_reply;
+    struct wake_completion_reply wake_completion_reply;
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
@@ -6692,8 +6863,9 @@ union generic_reply
     struct terminate_job_reply terminate_job_reply;
     struct suspend_process_reply suspend_process_reply;
     struct resume_process_reply resume_process_reply;
+    struct set_server_profile_reply set_server_profile_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 583
+#define SERVER_PROTOCOL_VERSION 590
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
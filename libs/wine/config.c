@@ -104,6 +104,16 @@ static void *xmalloc( size_t size )
     return res;
 }
 
+/* realloc wrapper */
+static void *xrealloc( void *ptr, size_t size )
+{
+    void *res;
+
+    if (!size) size = 1;
+    if (!(res = realloc( ptr, size ))) fatal_error( "virtual memory exhausted\n");
+    return res;
+}
+
 /* strdup wrapper */
 static char *xstrdup( const char *str )
 {
@@ -529,8 +539,40 @@ const char *wine_get_build_id(void)
     return wine_build;
 }
 
+/* command lines collected by wine_get_wine_binary_cmdlines */
+struct cmdline_list
+{
+    char       ***cmds;
+    unsigned int  count;
+    unsigned int  size;
+};
+
+/* exec a command line, or append a copy of it to the list if one is given */
+static void exec_cmdline( char **argv, struct cmdline_list *list )
+{
+    char **last_arg = argv, **copy;
+
+    if (!list)
+    {
+        execv( argv[0], argv );
+        return;
+    }
+    while (*last_arg) last_arg++;
+    copy = xmalloc( (last_arg - argv + 1) * sizeof(*argv) );
+    memcpy( copy, argv, (last_arg - argv + 1) * sizeof(*argv) );
+    copy[0] = xstrdup( argv[0] );  /* the callers free argv[0] once it has been tried */
+
+    if (list->count + 1 >= list->size)
+    {
+        list->size = list->size ? list->size * 2 : 16;
+        list->cmds = xrealloc( list->cmds, list->size * sizeof(*list->cmds) );
+    }
+    list->cmds[list->count++] = copy;
+    list->cmds[list->count] = NULL;
+}
+
 /* exec a binary using the preloader if requested; helper for wine_exec_wine_binary */
-static void preloader_exec( char **argv, int use_preloader )
+static void preloader_exec( char **argv, int use_preloader, struct cmdline_list *list )
 {
     if (use_preloader)
     {
@@ -555,6 +597,7 @@ static void preloader_exec( char **argv, int use_preloader )
         memcpy( new_argv + 1, argv, (last_arg - argv + 1) * sizeof(*argv) );
         new_argv[0] = full_name;
 #ifdef __APPLE__
+        if (!list)
         {
             posix_spawnattr_t attr;
             posix_spawnattr_init( &attr );
@@ -563,15 +606,16 @@ static void preloader_exec( char **argv, int use_preloader )
             posix_spawnattr_destroy( &attr );
         }
 #endif
-        execv( full_name, new_argv );
+        exec_cmdline( new_argv, list );
         free( new_argv );
         free( full_name );
     }
-    execv( argv[0], argv );
+    exec_cmdline( argv, list );
 }
 
-/* exec a wine internal binary (either the wine loader or the wine server) */
-void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
+/* try all the locations of a wine internal binary; helper for wine_exec_wine_binary */
+static void exec_wine_binary( const char *name, char **argv, const char *env_var,
+                              struct cmdline_list *list )
 {
     const char *path, *pos, *ptr;
     int use_preloader;
@@ -593,7 +637,7 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
                 argv[0] = xstrdup( wineserver64 );
             else
                 argv[0] = build_path( build_dir, name );
-            preloader_exec( argv, use_preloader );
+            preloader_exec( argv, use_preloader, list );
             free( argv[0] );
         }
         name = ptr + 1;  /* get rid of path */
@@ -603,7 +647,7 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
     if (bindir)
     {
         argv[0] = build_path( bindir, name );
-        preloader_exec( argv, use_preloader );
+        preloader_exec( argv, use_preloader, list );
         free( argv[0] );
     }
 
@@ -611,7 +655,7 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
     if (env_var)
     {
         argv[0] = (char *)env_var;
-        preloader_exec( argv, use_preloader );
+        preloader_exec( argv, use_preloader, list );
     }
 
     /* now search in the Unix path */
@@ -627,7 +671,7 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
             memcpy( argv[0], pos, ptr - pos );
             strcpy( argv[0] + (ptr - pos), "/" );
             strcat( argv[0] + (ptr - pos), name );
-            preloader_exec( argv, use_preloader );
+            preloader_exec( argv, use_preloader, list );
             pos = ptr;
         }
         free( argv[0] );
@@ -635,6 +679,29 @@ void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
 
     /* and finally try BINDIR */
     argv[0] = build_path( BINDIR, name );
-    preloader_exec( argv, use_preloader );
+    preloader_exec( argv, use_preloader, list );
     free( argv[0] );
 }
+
+/* exec a wine internal binary (either the wine loader or the wine server) */
+void wine_exec_wine_binary( const char *name, char **argv, const char *env_var )
+{
+    exec_wine_binary( name, argv, env_var, NULL );
+}
+
+/* build the NULL-terminated list of command lines that wine_exec_wine_binary would try, in
+ * the same order, so that a vforked child only has to exec them; the list is not meant to be
+ * freed. Returns NULL if the binary can only be started through wine_exec_wine_binary. */
+char ***wine_get_wine_binary_cmdlines( const char *name, char **argv, const char *env_var )
+{
+#ifdef __APPLE__
+    return NULL;  /* the preloader has to be started with posix_spawn */
+#else
+    struct cmdline_list list = { NULL, 0, 0 };
+
+    exec_wine_binary( name, argv, env_var, &list );
+    if (!list.cmds) list.cmds = xmalloc( sizeof(*list.cmds) );
+    list.cmds[list.count] = NULL;
+    return list.cmds;
+#endif
+}
@@ -31,6 +31,10 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -46,9 +50,11 @@
 
 struct completion
 {
-    struct object  obj;
-    struct list    queue;
-    unsigned int   depth;
+    struct object          obj;
+    struct list            queue;
+    unsigned int           depth;
+    int                    shm_fd;  /* fd of the shared queue */
+    struct completion_shm *shm;     /* shared queue, messages are added there first */
 };
 
 static void completion_dump( struct object*, int );
@@ -89,6 +95,93 @@ struct comp_msg
     unsigned int  status;
 };
 
+/* The shared queue is writable by the clients, so none of its fields can be
+ * trusted here: the loops are bounded and the server falls back to its own
+ * list when the queue looks inconsistent, which only affects that port. */
+
+static inline struct completion_shm_entry *shm_entry( struct completion_shm *shm, int pos )
+{
+    return &shm->entries[((unsigned int)pos / 2) % COMPLETION_SHM_ENTRIES];
+}
+
+/* add a message to the shared queue; same algorithm as in ntdll */
+static int shm_push( struct completion_shm *shm, apc_param_t ckey, apc_param_t cvalue,
+                     unsigned int status, apc_param_t information )
+{
+    struct completion_shm_entry *entry;
+    int pos = *(volatile int *)&shm->tail, prev, diff, i;
+
+    for (i = 0; i < COMPLETION_SHM_ENTRIES; i++)
+    {
+        if (pos & COMPLETION_SHM_CLOSED) return 0;
+        entry = shm_entry( shm, pos );
+        diff = *(volatile int *)&entry->seq - pos;
+        if (diff < 0) return 0;  /* queue is full */
+        if (!diff)
+        {
+            if ((prev = interlocked_cmpxchg( &shm->tail, pos + 2, pos )) == pos) break;
+            pos = prev;
+        }
+        else pos = *(volatile int *)&shm->tail;
+    }
+    if (i == COMPLETION_SHM_ENTRIES) return 0;
+
+    entry->ckey        = ckey;
+    entry->cvalue      = cvalue;
+    entry->status      = status;
+    entry->information = information;
+    interlocked_xchg( &entry->seq, pos + 2 );
+    return 1;
+}
+
+/* remove a message from the shared queue */
+static int shm_pop( struct completion_shm *shm, struct comp_msg *msg )
+{
+    struct completion_shm_entry *entry;
+    int pos = *(volatile int *)&shm->head, prev, diff, i;
+
+    for (i = 0; i < COMPLETION_SHM_ENTRIES; i++)
+    {
+        entry = shm_entry( shm, pos );
+        diff = *(volatile int *)&entry->seq - (pos + 2);
+        if (diff < 0) return 0;  /* queue is empty */
+        if (!diff)
+        {
+            if ((prev = interlocked_cmpxchg( &shm->head, pos + 2, pos )) == pos) break;
+            pos = prev;
+        }
+        else pos = *(volatile int *)&shm->head;
+    }
+    if (i == COMPLETION_SHM_ENTRIES) return 0;
+
+    msg->ckey        = entry->ckey;
+    msg->cvalue      = entry->cvalue;
+    msg->status      = entry->status;
+    msg->information = entry->information;
+    interlocked_xchg( &entry->seq, pos + 2 * COMPLETION_SHM_ENTRIES );
+    return 1;
+}
+
+static int shm_is_empty( struct completion_shm *shm )
+{
+    int pos = *(volatile int *)&shm->head;
+    return *(volatile int *)&shm_entry( shm, pos )->seq != pos + 2;
+}
+
+/* set or clear the closed flag; clients can only add to the queue while it is clear */
+static void shm_set_closed( struct completion_shm *shm, int closed )
+{
+    int pos = *(volatile int *)&shm->tail, new_pos, prev, i;
+
+    for (i = 0; i < COMPLETION_SHM_ENTRIES; i++)
+    {
+        new_pos = closed ? (pos | COMPLETION_SHM_CLOSED) : (pos & ~COMPLETION_SHM_CLOSED);
+        if (new_pos == pos) return;
+        if ((prev = interlocked_cmpxchg( &shm->tail, new_pos, pos )) == pos) return;
+        pos = prev;
+    }
+}
+
 static void completion_destroy( struct object *obj)
 {
     struct completion *completion = (struct completion *) obj;
@@ -98,6 +191,20 @@ static void completion_destroy( struct object *obj)
     {
         free( tmp );
     }
+    if (completion->shm) munmap( completion->shm, sizeof(*completion->shm) );
+    if (completion->shm_fd != -1) close( completion->shm_fd );
+}
+
+static unsigned int get_completion_depth( struct completion *completion )
+{
+    unsigned int depth = completion->depth, shm_depth;
+
+    if (completion->shm)
+    {
+        shm_depth = ((unsigned int)completion->shm->tail - completion->shm->head) / 2;
+        depth += min( shm_depth, COMPLETION_SHM_ENTRIES );
+    }
+    return depth;
 }
 
 static void completion_dump( struct object *obj, int verbose )
@@ -105,7 +212,7 @@ static void completion_dump( struct object *obj, int verbose )
     struct completion *completion = (struct completion *) obj;
 
     assert( obj->ops == &completion_ops );
-    fprintf( stderr, "Completion depth=%u\n", completion->depth );
+    fprintf( stderr, "Completion depth=%u\n", get_completion_depth( completion ) );
 }
 
 static struct object_type *completion_get_type( struct object *obj )
@@ -119,6 +226,7 @@ static int completion_signaled( struct object *obj, struct wait_queue_entry *ent
 {
     struct completion *completion = (struct completion *)obj;
 
+    if (completion->shm && !shm_is_empty( completion->shm )) return 1;
     return !list_empty( &completion->queue );
 }
 
@@ -131,6 +239,22 @@ static unsigned int completion_map_access( struct object *obj, unsigned int acce
     return access & ~(GENERIC_READ | GENERIC_WRITE | GENERIC_EXECUTE | GENERIC_ALL);
 }
 
+static void init_completion_shm( struct completion *completion )
+{
+    struct completion_shm *shm;
+    int i;
+
+    shm = mmap( NULL, sizeof(*shm), PROT_READ | PROT_WRITE, MAP_SHARED, completion->shm_fd, 0 );
+    if (shm == MAP_FAILED)
+    {
+        close( completion->shm_fd );
+        completion->shm_fd = -1;
+        return;
+    }
+    for (i = 0; i < COMPLETION_SHM_ENTRIES; i++) shm->entries[i].seq = 2 * i;
+    completion->shm = shm;
+}
+
 static struct completion *create_completion( struct object *root, const struct unicode_str *name,
                                              unsigned int attr, unsigned int concurrent,
                                              const struct security_descriptor *sd )
@@ -143,6 +267,11 @@ static struct completion *create_completion( struct object *root, const struct u
         {
             list_init( &completion->queue );
             completion->depth = 0;
+            completion->shm = NULL;
+            if ((completion->shm_fd = create_temp_file( sizeof(*completion->shm) )) != -1)
+                init_completion_shm( completion );
+            else
+                clear_error();  /* fall back to the server queue */
         }
     }
 
@@ -157,9 +286,17 @@ struct completion *get_completion_obj( struct process *process, obj_handle_t han
 void add_completion( struct completion *completion, apc_param_t ckey, apc_param_t cvalue,
                      unsigned int status, apc_param_t information )
 {
-    struct comp_msg *msg = mem_alloc( sizeof( *msg ) );
+    struct comp_msg *msg;
+
+    /* keep messages in order, the shared queue is closed while the list is not empty */
+    if (completion->shm && list_empty( &completion->queue ) &&
+        shm_push( completion->shm, ckey, cvalue, status, information ))
+    {
+        wake_up( &completion->obj, 1 );
+        return;
+    }
 
-    if (!msg)
+    if (!(msg = mem_alloc( sizeof( *msg ) )))
         return;
 
     msg->ckey = ckey;
@@ -167,6 +304,9 @@ void add_completion( struct completion *completion, apc_param_t ckey, apc_param_
     msg->status = status;
     msg->information = information;
 
+    /* close the shared queue before the message becomes visible, so that
+     * no client can add a newer message in front of it */
+    if (completion->shm) shm_set_closed( completion->shm, 1 );
     list_add_tail( &completion->queue, &msg->queue_entry );
     completion->depth++;
     wake_up( &completion->obj, 1 );
@@ -219,17 +359,25 @@ DECL_HANDLER(remove_completion)
 {
     struct completion* completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
     struct list *entry;
-    struct comp_msg *msg;
+    struct comp_msg *msg, shm_msg;
 
     if (!completion) return;
 
-    entry = list_head( &completion->queue );
-    if (!entry)
+    /* messages in the shared queue are older than the ones in the list */
+    if (completion->shm && shm_pop( completion->shm, &shm_msg ))
+    {
+        reply->ckey = shm_msg.ckey;
+        reply->cvalue = shm_msg.cvalue;
+        reply->status = shm_msg.status;
+        reply->information = shm_msg.information;
+    }
+    else if (!(entry = list_head( &completion->queue )))
         set_error( STATUS_PENDING );
     else
     {
         list_remove( entry );
         completion->depth--;
+        if (completion->shm && !completion->depth) shm_set_closed( completion->shm, 0 );
         msg = LIST_ENTRY( entry, struct comp_msg, queue_entry );
         reply->ckey = msg->ckey;
         reply->cvalue = msg->cvalue;
@@ -241,6 +389,31 @@ DECL_HANDLER(remove_completion)
     release_object( completion );
 }
 
+/* get the shared queue of a completion port */
+DECL_HANDLER(get_completion_shm)
+{
+    struct completion *completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
+
+    if (!completion) return;
+
+    if (completion->shm) send_client_fd( current->process, completion->shm_fd, req->handle );
+    else set_error( STATUS_NOT_SUPPORTED );
+
+    release_object( completion );
+}
+
+/* wake up a thread after a client added a message to the shared queue */
+DECL_HANDLER(wake_completion)
+{
+    struct completion *completion = get_completion_obj( current->process, req->handle, IO_COMPLETION_MODIFY_STATE );
+
+    if (!completion) return;
+
+    wake_up( &completion->obj, 1 );
+
+    release_object( completion );
+}
+
 /* get queue depth for completion port */
 DECL_HANDLER(query_completion)
 {
@@ -248,7 +421,7 @@ DECL_HANDLER(query_completion)
 
     if (!completion) return;
 
-    reply->depth = completion->depth;
+    reply->depth = get_completion_depth( completion );
 
     release_object( completion );
 }
@@ -152,12 +152,14 @@ extern mode_t sd_to_mode( const struct security_descriptor *sd, const SID *owner
 
 /* file mapping functions */
 
+extern struct object *create_server_mapping( mem_size_t size, void **ptr );
 extern struct mapping *get_mapping_obj( struct process *process, obj_handle_t handle,
                                         unsigned int access );
 extern struct file *get_mapping_file( struct process *process, client_ptr_t base,
                                       unsigned int access, unsigned int sharing );
 extern void free_mapped_views( struct process *process );
 extern int get_page_size(void);
+extern int create_temp_file( file_pos_t size );
 
 /* device functions */
 
@@ -150,6 +150,7 @@ static struct hook *add_hook( struct desktop *desktop, struct thread *thread, in
     hook->index  = index;
     list_add_head( &table->hooks[index], &hook->chain );
     if (thread) thread->desktop_users++;
+    invalidate_active_hooks();
     return hook;
 }
 
@@ -294,6 +295,7 @@ static void hook_table_destroy( struct object *obj )
 /* remove a hook, freeing it if the chain is not in use */
 static void remove_hook( struct hook *hook )
 {
+    invalidate_active_hooks();
     if (hook->table->counts[hook->index])
         hook->proc = 0; /* chain is in use, just mark it and return */
     else
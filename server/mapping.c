@@ -82,12 +82,16 @@ static const struct object_ops ranges_ops =
     ranges_destroy             /* destroy */
 };
 
-/* file backing the shared sections of a PE image mapping */
+/* file backing the shared sections of a PE image mapping, or a whole relocated image */
 struct shared_map
 {
     struct object   obj;             /* object header */
     struct fd      *fd;              /* file descriptor of the mapped PE file */
     struct file    *file;            /* temp file holding the shared data */
+    client_ptr_t    base;            /* load address of a relocated image, 0 for shared sections */
+    file_pos_t      size;            /* size of the PE file the data was built from */
+    time_t          mtime;           /* modification time of the PE file */
+    time_t          ctime;           /* change time of the PE file */
     struct list     entry;           /* entry in global shared maps list */
 };
 
@@ -119,6 +123,9 @@ static const struct object_ops shared_map_ops =
 
 static struct list shared_map_list = LIST_INIT( shared_map_list );
 
+/* largest image the server relocates itself, it blocks all the other requests meanwhile */
+#define MAX_RELOCATED_IMAGE_SIZE (16 * 1024 * 1024)
+
 /* memory view mapped in client address space */
 struct memory_view
 {
@@ -126,6 +133,7 @@ struct memory_view
     struct fd      *fd;              /* fd for mapped file */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct shared_map *relocated;    /* temp file for relocated PE image */
     unsigned int    flags;           /* SEC_* flags */
     client_ptr_t    base;            /* view base address (in process addr space) */
     mem_size_t      size;            /* view size */
@@ -141,6 +149,7 @@ struct mapping
     pe_image_info_t image;           /* image info (for PE image mapping) */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct shared_map *relocated;    /* temp file for relocated PE image */
 };
 
 static void mapping_dump( struct object *obj, int verbose );
@@ -208,7 +217,8 @@ static void ranges_destroy( struct object *obj )
 static void shared_map_dump( struct object *obj, int verbose )
 {
     struct shared_map *shared = (struct shared_map *)obj;
-    fprintf( stderr, "Shared mapping fd=%p file=%p\n", shared->fd, shared->file );
+    fprintf( stderr, "Shared mapping fd=%p file=%p base=%08x%08x\n", shared->fd, shared->file,
+             (unsigned int)(shared->base >> 32), (unsigned int)shared->base );
 }
 
 static void shared_map_destroy( struct object *obj )
@@ -262,7 +272,7 @@ static int check_current_dir_for_exec(void)
 }
 
 /* create a temp file for anonymous mappings */
-static int create_temp_file( file_pos_t size )
+int create_temp_file( file_pos_t size )
 {
     static int temp_dir_fd = -1;
     char tmpfn[] = "anonmap.XXXXXX";
@@ -316,6 +326,7 @@ static void free_memory_view( struct memory_view *view )
     if (view->fd) release_object( view->fd );
     if (view->committed) release_object( view->committed );
     if (view->shared) release_object( view->shared );
+    if (view->relocated) release_object( view->relocated );
     list_remove( &view->entry );
     free( view );
 }
@@ -329,17 +340,48 @@ void free_mapped_views( struct process *process )
         free_memory_view( LIST_ENTRY( ptr, struct memory_view, entry ));
 }
 
-/* find the shared PE mapping for a given mapping */
-static struct shared_map *get_shared_file( struct fd *fd )
+/* find the shared PE mapping for a given mapping and load address */
+/* the file size and times must match too, the file may have been rewritten in place */
+static struct shared_map *get_shared_file( struct fd *fd, client_ptr_t base )
 {
     struct shared_map *ptr;
+    struct stat st;
+    int unix_fd;
 
+    if ((unix_fd = get_unix_fd( fd )) == -1 || fstat( unix_fd, &st ) == -1)
+    {
+        clear_error();
+        return NULL;
+    }
     LIST_FOR_EACH_ENTRY( ptr, &shared_map_list, struct shared_map, entry )
-        if (is_same_file_fd( ptr->fd, fd ))
+        if (ptr->base == base && is_same_file_fd( ptr->fd, fd ) && ptr->size == st.st_size &&
+            ptr->mtime == st.st_mtime && ptr->ctime == st.st_ctime)
             return (struct shared_map *)grab_object( ptr );
     return NULL;
 }
 
+/* allocate a shared PE mapping and add it to the global list */
+static struct shared_map *create_shared_map( struct fd *fd, struct file *file, client_ptr_t base )
+{
+    struct shared_map *shared;
+    struct stat st;
+
+    if (fstat( get_unix_fd( fd ), &st ) == -1)
+    {
+        file_set_error();
+        return NULL;
+    }
+    if (!(shared = alloc_object( &shared_map_ops ))) return NULL;
+    shared->fd    = (struct fd *)grab_object( fd );
+    shared->file  = file;
+    shared->base  = base;
+    shared->size  = st.st_size;
+    shared->mtime = st.st_mtime;
+    shared->ctime = st.st_ctime;
+    list_add_head( &shared_map_list, &shared->entry );
+    return shared;
+}
+
 /* return the size of the memory mapping and file range of a given section */
 static inline void get_section_sizes( const IMAGE_SECTION_HEADER *sec, size_t *map_size,
                                       off_t *file_start, size_t *file_size )
@@ -475,7 +517,7 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     }
     if (!total_size) return 1;  /* nothing to do */
 
-    if ((mapping->shared = get_shared_file( mapping->fd ))) return 1;
+    if ((mapping->shared = get_shared_file( mapping->fd, 0 ))) return 1;
 
     /* create a temp file for the mapping */
 
@@ -511,10 +553,7 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
         if (pwrite( shared_fd, buffer, file_size, write_pos ) != file_size) goto error;
     }
 
-    if (!(shared = alloc_object( &shared_map_ops ))) goto error;
-    shared->fd = (struct fd *)grab_object( mapping->fd );
-    shared->file = file;
-    list_add_head( &shared_map_list, &shared->entry );
+    if (!(shared = create_shared_map( mapping->fd, file, 0 ))) goto error;
     mapping->shared = shared;
     free( buffer );
     return 1;
@@ -525,6 +564,188 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     return 0;
 }
 
+/* apply the base relocations to an image laid out in memory */
+/* anything the client loader might handle differently makes us fail, the client then relocates itself */
+static int relocate_image( char *image, mem_size_t size, const IMAGE_DATA_DIRECTORY *dir,
+                           ULONGLONG delta, int is_64bit )
+{
+    IMAGE_BASE_RELOCATION rel;
+    mem_size_t pos, end, addr;
+    unsigned int i, count;
+    USHORT entry, val16;
+    DWORD val32;
+    ULONGLONG val64;
+
+    if (!dir->VirtualAddress || dir->VirtualAddress >= size || dir->Size > size - dir->VirtualAddress)
+        return 0;
+
+    pos = dir->VirtualAddress;
+    end = pos + dir->Size;
+    while (pos + sizeof(rel) < end)
+    {
+        memcpy( &rel, image + pos, sizeof(rel) );
+        if (!rel.SizeOfBlock) break;
+        if (rel.SizeOfBlock < sizeof(rel) || rel.SizeOfBlock > end - pos) return 0;
+        if (rel.VirtualAddress >= size) return 0;
+        count = (rel.SizeOfBlock - sizeof(rel)) / sizeof(USHORT);
+        for (i = 0; i < count; i++)
+        {
+            memcpy( &entry, image + pos + sizeof(rel) + i * sizeof(USHORT), sizeof(entry) );
+            addr = rel.VirtualAddress + (entry & 0xfff);
+            switch (entry >> 12)
+            {
+            case IMAGE_REL_BASED_ABSOLUTE:
+                break;
+            case IMAGE_REL_BASED_HIGH:
+            case IMAGE_REL_BASED_LOW:
+                if (addr + sizeof(val16) > size) return 0;
+                memcpy( &val16, image + addr, sizeof(val16) );
+                val16 += (entry >> 12) == IMAGE_REL_BASED_HIGH ? HIWORD( delta ) : LOWORD( delta );
+                memcpy( image + addr, &val16, sizeof(val16) );
+                break;
+            case IMAGE_REL_BASED_HIGHLOW:
+                if (addr + sizeof(val32) > size) return 0;
+                memcpy( &val32, image + addr, sizeof(val32) );
+                val32 += delta;
+                memcpy( image + addr, &val32, sizeof(val32) );
+                break;
+            case IMAGE_REL_BASED_DIR64:
+                if (!is_64bit || addr + sizeof(val64) > size) return 0;
+                memcpy( &val64, image + addr, sizeof(val64) );
+                val64 += delta;
+                memcpy( image + addr, &val64, sizeof(val64) );
+                break;
+            default:
+                return 0;
+            }
+        }
+        pos += rel.SizeOfBlock;
+    }
+    return 1;
+}
+
+/* read the raw data of a section, a partial sector at EOF is not an error */
+static int read_section_data( int fd, char *buffer, size_t size, off_t pos )
+{
+    size_t done = 0;
+    ssize_t res;
+
+    while (done < size)
+    {
+        res = pread( fd, buffer + done, size - done, pos + done );
+        if (!res && size - done < 0x200) break;
+        if (res <= 0) return 0;
+        done += res;
+    }
+    return 1;
+}
+
+/* lay out a PE image in a temp file and relocate it to a given address, so that all the
+ * processes loading the image at that address can share the relocated pages */
+static struct shared_map *build_relocated_mapping( struct mapping *mapping, client_ptr_t base )
+{
+    static const unsigned int sector_align = 0x1ff;
+    struct shared_map *shared = NULL;
+    struct file *file;
+    IMAGE_DOS_HEADER *dos;
+    IMAGE_NT_HEADERS32 *nt32;
+    IMAGE_NT_HEADERS64 *nt64;
+    IMAGE_DATA_DIRECTORY relocs;
+    IMAGE_SECTION_HEADER sec[96];
+    mem_size_t total_size = mapping->image.map_size;
+    file_pos_t raw_size = (mapping->image.file_size + sector_align) & ~(file_pos_t)sector_align;
+    size_t header_size, map_size, file_size, end;
+    unsigned int i, nb_sec;
+    off_t file_start;
+    char *image, *header_end;
+    int unix_fd, image_fd, ret = 0;
+
+    /* only dlls are relocated at load time, and only when their sections are page-aligned */
+    if (!(mapping->image.image_charact & IMAGE_FILE_DLL)) return NULL;
+    if (mapping->image.image_charact & IMAGE_FILE_RELOCS_STRIPPED) return NULL;
+    if (mapping->image.image_flags & (IMAGE_FLAGS_ImageMappedFlat | IMAGE_FLAGS_ComPlusILOnly)) return NULL;
+    if (mapping->shared || is_fd_removable( mapping->fd )) return NULL;
+    if (base == mapping->image.base || total_size != (size_t)total_size) return NULL;
+    /* the work is done synchronously in the server, leave large images to the client */
+    if (total_size > MAX_RELOCATED_IMAGE_SIZE) return NULL;
+
+    if ((shared = get_shared_file( mapping->fd, base ))) return shared;
+
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) return NULL;
+    if ((image_fd = create_temp_file( total_size )) == -1) return NULL;
+    if (!(file = create_file_for_fd( image_fd, FILE_GENERIC_READ, 0 ))) return NULL;
+
+    image = mmap( NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, image_fd, 0 );
+    if (image == MAP_FAILED) goto error;
+
+    /* copy the header, same as the client does when mapping the image itself */
+
+    header_size = min( mapping->image.header_size, mapping->image.file_size );
+    header_end = image + ROUND_SIZE( header_size );
+    if (header_size > total_size || pread( unix_fd, image, header_size, 0 ) != header_size) goto done;
+
+    /* the file may have changed since it was checked when the mapping was created */
+    dos = (IMAGE_DOS_HEADER *)image;
+    if (dos->e_lfanew >= (size_t)(header_end - image)) goto done;
+    nt32 = (IMAGE_NT_HEADERS32 *)(image + dos->e_lfanew);
+    nt64 = (IMAGE_NT_HEADERS64 *)nt32;
+    if ((char *)(nt64 + 1) > header_end) goto done;
+    nb_sec = nt32->FileHeader.NumberOfSections;
+    if (nb_sec > ARRAY_SIZE( sec )) goto done;
+    if ((char *)&nt32->OptionalHeader + nt32->FileHeader.SizeOfOptionalHeader +
+        nb_sec * sizeof(*sec) > header_end) goto done;
+    memcpy( sec, (char *)&nt32->OptionalHeader + nt32->FileHeader.SizeOfOptionalHeader,
+            nb_sec * sizeof(*sec) );
+
+    if (nt32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC)
+    {
+        if (ROUND_SIZE( nt64->OptionalHeader.SizeOfImage ) != total_size) goto done;
+        if (nt64->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_BASERELOC) goto done;
+        relocs = nt64->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+        nt64->OptionalHeader.ImageBase = base;
+    }
+    else
+    {
+        if (ROUND_SIZE( nt32->OptionalHeader.SizeOfImage ) != total_size) goto done;
+        if (nt32->OptionalHeader.NumberOfRvaAndSizes <= IMAGE_DIRECTORY_ENTRY_BASERELOC) goto done;
+        relocs = nt32->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC];
+        nt32->OptionalHeader.ImageBase = base;
+    }
+    if (!relocs.Size) goto done;  /* nothing to share, the client maps the file directly */
+
+    /* copy the sections at their virtual address */
+
+    for (i = 0; i < nb_sec; i++)
+    {
+        get_section_sizes( &sec[i], &map_size, &file_start, &file_size );
+        end = sec[i].VirtualAddress + ROUND_SIZE( map_size );
+        if (sec[i].VirtualAddress > total_size || end > total_size || end < sec[i].VirtualAddress)
+            goto done;
+        if (!sec[i].PointerToRawData || !file_size) continue;
+        if (sec[i].PointerToRawData >= mapping->image.file_size ||
+            file_start + file_size > raw_size) goto done;
+        if (!read_section_data( unix_fd, image + sec[i].VirtualAddress, file_size, file_start )) goto done;
+        end = min( ROUND_SIZE( file_size ), map_size );
+        memset( image + sec[i].VirtualAddress + file_size, 0, end - file_size );
+    }
+
+    if (!relocate_image( image, total_size, &relocs, base - mapping->image.base,
+                         nt32->OptionalHeader.Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC )) goto done;
+
+    if (!(shared = create_shared_map( mapping->fd, (struct file *)grab_object( file ), base )))
+    {
+        release_object( file );
+        goto done;
+    }
+    ret = 1;
+
+ done:
+    munmap( image, total_size );
+ error:
+    release_object( file );
+    return ret ? shared : NULL;
+}
+
 /* load the CLR header from its section */
 static int load_clr_header( IMAGE_COR20_HEADER *hdr, size_t va, size_t size, int unix_fd,
                             IMAGE_SECTION_HEADER *sec, unsigned int nb_sec )
@@ -800,6 +1021,7 @@ static struct object *create_mapping( struct object *root, const struct unicode_
     mapping->size        = size;
     mapping->fd          = NULL;
     mapping->shared      = NULL;
+    mapping->relocated   = NULL;
     mapping->committed   = NULL;
 
     if (!(mapping->flags = get_mapping_flags( handle, flags ))) goto error;
@@ -877,6 +1099,27 @@ static struct object *create_mapping( struct object *root, const struct unicode_
     return NULL;
 }
 
+/* create an anonymous mapping that is also mapped for writing in the server */
+struct object *create_server_mapping( mem_size_t size, void **ptr )
+{
+    struct mapping *mapping;
+    int unix_fd;
+
+    if (!(mapping = (struct mapping *)create_mapping( NULL, NULL, 0, size, SEC_COMMIT, 0, 0, NULL )))
+        return NULL;
+    if ((unix_fd = get_unix_fd( mapping->fd )) == -1) goto error;
+    if ((*ptr = mmap( NULL, mapping->size, PROT_READ | PROT_WRITE, MAP_SHARED, unix_fd, 0 )) == MAP_FAILED)
+    {
+        file_set_error();
+        goto error;
+    }
+    return &mapping->obj;
+
+ error:
+    release_object( mapping );
+    return NULL;
+}
+
 struct mapping *get_mapping_obj( struct process *process, obj_handle_t handle, unsigned int access )
 {
     return (struct mapping *)get_handle_obj( process, handle, access, &mapping_ops );
@@ -930,6 +1173,7 @@ static void mapping_destroy( struct object *obj )
     if (mapping->fd) release_object( mapping->fd );
     if (mapping->committed) release_object( mapping->committed );
     if (mapping->shared) release_object( mapping->shared );
+    if (mapping->relocated) release_object( mapping->relocated );
 }
 
 static enum server_fd_type mapping_get_fd_type( struct fd *fd )
@@ -1001,6 +1245,22 @@ DECL_HANDLER(get_mapping_info)
     release_object( mapping );
 }
 
+/* get a file holding a PE image relocated to a given address */
+DECL_HANDLER(get_relocated_image)
+{
+    struct mapping *mapping;
+
+    if (!(mapping = get_mapping_obj( current->process, req->mapping, SECTION_MAP_READ ))) return;
+
+    if ((mapping->flags & SEC_IMAGE) && !(req->base & page_mask))
+    {
+        if (mapping->relocated) release_object( mapping->relocated );
+        if ((mapping->relocated = build_relocated_mapping( mapping, req->base )))
+            reply->file = alloc_handle( current->process, mapping->relocated->file, GENERIC_READ, 0 );
+    }
+    release_object( mapping );
+}
+
 /* add a memory view in the current process */
 DECL_HANDLER(map_view)
 {
@@ -1049,6 +1309,9 @@ DECL_HANDLER(map_view)
         view->fd        = !is_fd_removable( mapping->fd ) ? (struct fd *)grab_object( mapping->fd ) : NULL;
         view->committed = mapping->committed ? (struct ranges *)grab_object( mapping->committed ) : NULL;
         view->shared    = mapping->shared ? (struct shared_map *)grab_object( mapping->shared ) : NULL;
+        view->relocated = NULL;
+        if (mapping->relocated && mapping->relocated->base == req->base)
+            view->relocated = (struct shared_map *)grab_object( mapping->relocated );
         list_add_tail( &current->process->views, &view->entry );
     }
 
@@ -528,6 +528,7 @@ struct process *create_process( int fd, struct process *parent, int inherit_all,
     process->trace_data      = 0;
     process->rawinput_mouse  = NULL;
     process->rawinput_kbd    = NULL;
+    process->profile         = NULL;
     list_init( &process->kernel_object );
     list_init( &process->thread_list );
     list_init( &process->locks );
@@ -625,6 +626,7 @@ static void process_destroy( struct object *obj )
     if (process->exe_file) release_object( process->exe_file );
     if (process->id) free_ptid( process->id );
     if (process->token) release_object( process->token );
+    if (process->profile) free_process_profile( process );
     free( process->dir_cache );
 }
 
@@ -1553,6 +1555,24 @@ DECL_HANDLER(write_process_memory)
     }
 }
 
+/* check access to a process address space, so that the client can access it directly */
+DECL_HANDLER(get_process_vm_pid)
+{
+    struct process *process;
+
+    if (req->access != PROCESS_VM_READ && req->access != PROCESS_VM_WRITE)
+    {
+        set_error( STATUS_INVALID_PARAMETER );
+        return;
+    }
+    if ((process = get_process_from_handle( req->handle, req->access )))
+    {
+        /* a dead process is left to the server, its pid may get reused */
+        reply->unix_pid = process->running_threads ? process->unix_pid : -1;
+        release_object( process );
+    }
+}
+
 /* notify the server that a dll has been loaded */
 DECL_HANDLER(load_dll)
 {
@@ -97,6 +97,7 @@ struct process
     const struct rawinput_device *rawinput_mouse; /* rawinput mouse device, if any */
     const struct rawinput_device *rawinput_kbd;   /* rawinput keyboard device, if any */
     struct list          kernel_object;   /* list of kernel object pointers */
+    struct process_profile *profile;      /* request profiling data, see request.c */
 };
 
 struct process_snapshot
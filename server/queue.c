@@ -28,6 +28,9 @@
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -140,6 +143,10 @@ struct msg_queue
     struct thread_input   *input;           /* thread input descriptor */
     struct hook_table     *hooks;           /* hook table */
     timeout_t              last_get_msg;    /* time of last get message call */
+    struct object         *shm_mapping;     /* mapping of the state shared with the client */
+    struct queue_shm      *shm;             /* server view of the shared state */
+    struct list            shm_entry;       /* entry in the list of shared queues */
+    int                    hooks_changed;   /* active hooks changed since last get message call */
 };
 
 struct hotkey
@@ -224,6 +231,7 @@ static const struct object_ops thread_input_ops =
 
 /* pointer to input structure of foreground thread */
 static unsigned int last_input_time;
+static struct list shared_queues = LIST_INIT( shared_queues );  /* queues with a shared state mapping */
 
 static void queue_hardware_message( struct desktop *desktop, struct message *msg, int always_queue );
 static void free_message( struct message *msg );
@@ -300,6 +308,9 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->input           = (struct thread_input *)grab_object( input );
         queue->hooks           = NULL;
         queue->last_get_msg    = current_time;
+        queue->shm_mapping     = NULL;
+        queue->shm             = NULL;
+        queue->hooks_changed   = 0;
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -442,6 +453,35 @@ void set_queue_hooks( struct thread *thread, struct hook_table *hooks )
     queue->hooks = hooks;
 }
 
+/* copy the queue state to the memory shared with the client */
+static void update_queue_shm( struct msg_queue *queue )
+{
+    struct queue_shm *shm = queue->shm;
+
+    if (!shm) return;
+    interlocked_xchg( &shm->seq, shm->seq + 1 );
+    shm->wake_bits     = queue->wake_bits;
+    shm->changed_bits  = queue->changed_bits;
+    shm->wake_mask     = queue->wake_mask;
+    shm->changed_mask  = queue->changed_mask;
+    shm->hooks_changed = queue->hooks_changed;
+    shm->last_get_msg  = queue->last_get_msg;
+    interlocked_xchg( &shm->seq, shm->seq + 1 );
+}
+
+/* flag all the shared queues since the hooks they see as active may have changed */
+void invalidate_active_hooks(void)
+{
+    struct msg_queue *queue;
+
+    LIST_FOR_EACH_ENTRY( queue, &shared_queues, struct msg_queue, shm_entry )
+    {
+        if (queue->hooks_changed) continue;
+        queue->hooks_changed = 1;
+        update_queue_shm( queue );
+    }
+}
+
 /* check the queue status */
 static inline int is_signaled( struct msg_queue *queue )
 {
@@ -453,6 +493,7 @@ static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
 {
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_queue_shm( queue );
     if (is_signaled( queue )) wake_up( &queue->obj, 0 );
 }
 
@@ -461,6 +502,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_queue_shm( queue );
 }
 
 /* check whether msg is a keyboard message */
@@ -970,6 +1012,7 @@ static void msg_queue_satisfied( struct object *obj, struct wait_queue_entry *en
     struct msg_queue *queue = (struct msg_queue *)obj;
     queue->wake_mask = 0;
     queue->changed_mask = 0;
+    update_queue_shm( queue );
 }
 
 static void msg_queue_destroy( struct object *obj )
@@ -1008,6 +1051,12 @@ static void msg_queue_destroy( struct object *obj )
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
+    if (queue->shm_mapping)
+    {
+        list_remove( &queue->shm_entry );
+        munmap( queue->shm, sizeof(*queue->shm) );
+        release_object( queue->shm_mapping );
+    }
 }
 
 static void msg_queue_poll_event( struct fd *fd, int event )
@@ -2225,6 +2274,7 @@ DECL_HANDLER(set_queue_mask)
             if (req->skip_wait) queue->wake_mask = queue->changed_mask = 0;
             else wake_up( &queue->obj, 0 );
         }
+        update_queue_shm( queue );
     }
 }
 
@@ -2238,11 +2288,30 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_queue_shm( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
 
 
+/* get a read-only mapping of the current message queue state */
+DECL_HANDLER(get_queue_shm)
+{
+    struct msg_queue *queue = get_current_queue();
+    void *ptr;
+
+    if (!queue) return;
+    if (!queue->shm_mapping)
+    {
+        if (!(queue->shm_mapping = create_server_mapping( sizeof(*queue->shm), &ptr ))) return;
+        queue->shm = ptr;
+        list_add_tail( &shared_queues, &queue->shm_entry );
+        update_queue_shm( queue );
+    }
+    reply->handle = alloc_handle( current->process, queue->shm_mapping, SECTION_MAP_READ | SECTION_QUERY, 0 );
+}
+
+
 /* send a message to a thread queue */
 DECL_HANDLER(send_message)
 {
@@ -2396,6 +2465,7 @@ DECL_HANDLER(get_message)
 
     if (!queue) return;
     queue->last_get_msg = current_time;
+    queue->hooks_changed = 0;
     if (!filter) filter = QS_ALLINPUT;
 
     /* first check for sent messages */
@@ -2414,6 +2484,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_queue_shm( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -2468,6 +2539,7 @@ DECL_HANDLER(get_message)
     if (get_win == -1 && current->process->idle_event) set_event( current->process->idle_event );
     queue->wake_mask = req->wake_mask;
     queue->changed_mask = req->changed_mask;
+    update_queue_shm( queue );
     set_error( STATUS_PENDING );  /* FIXME */
 }
 
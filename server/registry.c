@@ -107,6 +107,9 @@ struct key_value
 /* the root of the registry tree */
 static struct key *root_key;
 
+static struct object *registry_shm_mapping;  /* mapping of the generation counters shared with clients */
+static struct registry_shm *registry_shm;     /* server view of the generation counters */
+
 static const timeout_t ticks_1601_to_1970 = (timeout_t)86400 * (369 * 365 + 89) * TICKS_PER_SEC;
 static const timeout_t save_period = 30 * -TICKS_PER_SEC;  /* delay between periodic saves */
 static struct timeout_user *save_timeout_user;  /* saving timer */
@@ -538,12 +541,25 @@ static void check_notify( struct key *key, unsigned int change, int not_subtree
     }
 }
 
+/* get the generation counter slot of a key */
+static inline unsigned int get_key_gen_slot( const struct key *key )
+{
+    return ((unsigned long)key >> 4) % REGISTRY_SHM_SLOTS;
+}
+
+/* invalidate the values that clients cached for a key */
+static void bump_key_generation( const struct key *key )
+{
+    if (registry_shm) registry_shm->generation[get_key_gen_slot( key )]++;
+}
+
 /* update key modification time */
 static void touch_key( struct key *key, unsigned int change )
 {
     struct key *k;
 
     key->modif = current_time;
+    bump_key_generation( key );
     make_dirty( key );
 
     /* do notifications */
@@ -619,6 +635,7 @@ static void free_subkey( struct key *parent, int index )
     for (i = index; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
     parent->last_subkey--;
     key->flags |= KEY_DELETED;
+    bump_key_generation( key );
     key->parent = NULL;
     if (is_wow6432node( key->name, key->namelen )) parent->flags &= ~KEY_WOW64;
     release_object( key );
@@ -1537,6 +1554,7 @@ static int load_value( struct key *key, const char *buffer, struct file_load_inf
     struct key_value *value;
 
     if (!(value = parse_value_name( key, buffer, &len, info ))) return 0;
+    bump_key_generation( key );
     if (!(res = get_data_type( buffer + len, &type, &parse_type ))) goto error;
     buffer += len + res;
 
@@ -2172,6 +2190,8 @@ DECL_HANDLER(get_key_value)
     reply->total = 0;
     if ((key = get_hkey_obj( req->hkey, KEY_QUERY_VALUE )))
     {
+        reply->gen_slot = get_key_gen_slot( key );
+        if (registry_shm) reply->generation = registry_shm->generation[reply->gen_slot];
         get_value( key, &name, &reply->type, &reply->total );
         release_object( key );
     }
@@ -2317,3 +2337,17 @@ DECL_HANDLER(set_registry_notification)
         release_object( key );
     }
 }
+
+/* get a read-only mapping of the registry key generation counters */
+DECL_HANDLER(get_registry_shm)
+{
+    void *ptr;
+
+    if (!registry_shm_mapping)
+    {
+        if (!(registry_shm_mapping = create_server_mapping( sizeof(*registry_shm), &ptr ))) return;
+        make_object_static( registry_shm_mapping );
+        registry_shm = ptr;
+    }
+    reply->handle = alloc_handle( current->process, registry_shm_mapping, SECTION_MAP_READ | SECTION_QUERY, 0 );
+}
@@ -293,11 +293,188 @@ static void send_reply( union generic_reply *reply )
         fatal_protocol_error( current, "reply write: %s\n", strerror( errno ));
 }
 
+/* request profiling */
+
+struct request_stats
+{
+    unsigned int    count;        /* number of requests */
+    unsigned int    blocked;      /* number of requests that left the thread waiting */
+    timeout_t       time;         /* time spent in the handler, in nanoseconds */
+    timeout_t       wait_time;    /* time spent waiting after blocking requests, in nanoseconds */
+    timeout_t       reply_size;   /* total size of the variable reply data */
+};
+
+struct process_profile
+{
+    struct list          entry;   /* entry in profile list */
+    process_id_t         id;      /* process id */
+    int                  unix_pid;/* Unix pid of the process */
+    struct request_stats stats[REQ_NB_REQUESTS];
+};
+
+int profile_enabled = 0;
+static struct request_stats total_stats[REQ_NB_REQUESTS];
+static struct request_stats exited_stats[REQ_NB_REQUESTS];  /* sum of the processes that are gone */
+/* profiles of the live processes, each record is freed with its process */
+static struct list profile_list = LIST_INIT(profile_list);
+static const char profile_file_name[] = "wineserver.profile";
+
+/* get a timestamp in nanoseconds for profiling */
+static timeout_t get_profile_time(void)
+{
+#ifdef __APPLE__
+    static mach_timebase_info_data_t timebase;
+
+    if (!timebase.denom) mach_timebase_info( &timebase );
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#elif defined(HAVE_CLOCK_GETTIME)
+    struct timespec ts;
+    if (!clock_gettime( CLOCK_MONOTONIC, &ts ))
+        return ts.tv_sec * (timeout_t)1000000000 + ts.tv_nsec;
+#endif
+    {
+        struct timeval now;
+        gettimeofday( &now, NULL );
+        return now.tv_sec * (timeout_t)1000000000 + now.tv_usec * 1000;
+    }
+}
+
+static struct process_profile *get_process_profile( struct process *process )
+{
+    if (!process->profile && (process->profile = calloc( 1, sizeof(*process->profile) )))
+    {
+        process->profile->id = process->id;
+        list_add_tail( &profile_list, &process->profile->entry );
+    }
+    return process->profile;
+}
+
+/* start or stop profiling, counters are reset when starting */
+void enable_profiling( int enable )
+{
+    struct process_profile *profile;
+
+    if (enable && !profile_enabled)
+    {
+        memset( total_stats, 0, sizeof(total_stats) );
+        memset( exited_stats, 0, sizeof(exited_stats) );
+        /* records are freed with their process, so only clear them */
+        LIST_FOR_EACH_ENTRY( profile, &profile_list, struct process_profile, entry )
+            memset( profile->stats, 0, sizeof(profile->stats) );
+    }
+    profile_enabled = enable;
+}
+
+static void dump_stats( FILE *file, const char *pid, int unix_pid, const struct request_stats *stats )
+{
+    enum request req;
+
+    for (req = 0; req < REQ_NB_REQUESTS; req++)
+    {
+        if (!stats[req].count) continue;
+        fprintf( file, "%s\t%d\t%s\t%u\t%u\t%.0f\t%.0f\t%.0f\n", pid, unix_pid, get_req_name( req ),
+                 stats[req].count, stats[req].blocked, (double)stats[req].time,
+                 (double)stats[req].wait_time, (double)stats[req].reply_size );
+    }
+}
+
+/* write the request counters to the profile file in the config dir */
+void dump_profile(void)
+{
+    struct process_profile *profile;
+    char pid[16];
+    FILE *file;
+
+    fchdir( config_dir_fd );
+    file = fopen( profile_file_name, "w" );
+    fchdir( server_dir_fd );
+    if (!file)
+    {
+        file_set_error();
+        return;
+    }
+
+    fprintf( file, "# wineserver request profile, times in nanoseconds, pid 0000 is the total\n" );
+    fprintf( file, "# and pid 'exited' the sum of the processes that are gone\n" );
+    fprintf( file, "# pid\tunix_pid\trequest\tcount\tblocked\ttime\twait_time\treply_size\n" );
+    dump_stats( file, "0000", getpid(), total_stats );
+    dump_stats( file, "exited", -1, exited_stats );
+    LIST_FOR_EACH_ENTRY( profile, &profile_list, struct process_profile, entry )
+    {
+        sprintf( pid, "%04x", profile->id );
+        dump_stats( file, pid, profile->unix_pid, profile->stats );
+    }
+    fclose( file );
+}
+
+/* fold the profile of a process being destroyed into the exited processes sum */
+void free_process_profile( struct process *process )
+{
+    struct process_profile *profile = process->profile;
+    enum request req;
+
+    for (req = 0; req < REQ_NB_REQUESTS; req++)
+    {
+        exited_stats[req].count      += profile->stats[req].count;
+        exited_stats[req].blocked    += profile->stats[req].blocked;
+        exited_stats[req].time       += profile->stats[req].time;
+        exited_stats[req].wait_time  += profile->stats[req].wait_time;
+        exited_stats[req].reply_size += profile->stats[req].reply_size;
+    }
+    list_remove( &profile->entry );
+    free( profile );
+    process->profile = NULL;
+}
+
+/* account for a request in the profile */
+static void profile_request( enum request req, timeout_t start )
+{
+    struct process_profile *profile = get_process_profile( current->process );
+    data_size_t reply_size = current->reply_size;
+    timeout_t now = get_profile_time();
+    int blocked = (req == REQ_select && current->error == STATUS_PENDING);
+
+    total_stats[req].count++;
+    total_stats[req].time += now - start;
+    total_stats[req].reply_size += reply_size;
+    total_stats[req].blocked += blocked;
+    if (profile)
+    {
+        profile->unix_pid = current->process->unix_pid;
+        profile->stats[req].count++;
+        profile->stats[req].time += now - start;
+        profile->stats[req].reply_size += reply_size;
+        profile->stats[req].blocked += blocked;
+    }
+    if (blocked) current->profile_wait = now;
+}
+
+/* account for the end of a blocking wait in the profile */
+void profile_end_wait( struct thread *thread )
+{
+    timeout_t time = get_profile_time() - thread->profile_wait;
+
+    thread->profile_wait = 0;
+    if (!profile_enabled) return;
+    total_stats[REQ_select].wait_time += time;
+    if (thread->process->profile) thread->process->profile->stats[REQ_select].wait_time += time;
+}
+
+/* control the profiling of server requests */
+DECL_HANDLER(set_server_profile)
+{
+    reply->enabled = profile_enabled;
+    if (req->flags & SERVER_PROFILE_DUMP) dump_profile();
+    if (req->flags & SERVER_PROFILE_ENABLE) enable_profiling( 1 );
+    if (req->flags & SERVER_PROFILE_DISABLE) enable_profiling( 0 );
+}
+
 /* call a request handler */
 static void call_req_handler( struct thread *thread )
 {
     union generic_reply reply;
     enum request req = thread->req.request_header.req;
+    timeout_t start = 0;
 
     current = thread;
     current->reply_size = 0;
@@ -305,6 +482,7 @@ static void call_req_handler( struct thread *thread )
     memset( &reply, 0, sizeof(reply) );
 
     if (debug_level) trace_request();
+    if (profile_enabled) start = get_profile_time();
 
     if (req < REQ_NB_REQUESTS)
         req_handlers[req]( &current->req, &reply );
@@ -313,6 +491,7 @@ static void call_req_handler( struct thread *thread )
 
     if (current)
     {
+        if (start && req < REQ_NB_REQUESTS) profile_request( req, start );
         if (current->reply_fd)
         {
             reply.reply_header.error = current->error;
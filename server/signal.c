@@ -98,6 +98,7 @@ static const struct fd_ops handler_fd_ops =
 static struct handler *handler_sighup;
 static struct handler *handler_sigterm;
 static struct handler *handler_sigint;
+static struct handler *handler_sigusr2;
 static struct handler *handler_sigchld;
 static struct handler *handler_sigio;
 
@@ -195,6 +196,14 @@ static void sigint_callback(void)
     shutdown_master_socket();
 }
 
+/* SIGUSR2 callback */
+static void sigusr2_callback(void)
+{
+    /* the first signal starts profiling, the next ones dump the counters */
+    if (profile_enabled) dump_profile();
+    else enable_profiling( 1 );
+}
+
 /* SIGHUP handler */
 static void do_sighup( int signum )
 {
@@ -213,6 +222,12 @@ static void do_sigint( int signum )
     do_signal( handler_sigint );
 }
 
+/* SIGUSR2 handler */
+static void do_sigusr2( int signum )
+{
+    do_signal( handler_sigusr2 );
+}
+
 /* SIGALRM handler */
 static void do_sigalrm( int signum )
 {
@@ -277,6 +292,7 @@ void init_signals(void)
     if (!(handler_sighup  = create_handler( sighup_callback ))) goto error;
     if (!(handler_sigterm = create_handler( sigterm_callback ))) goto error;
     if (!(handler_sigint  = create_handler( sigint_callback ))) goto error;
+    if (!(handler_sigusr2 = create_handler( sigusr2_callback ))) goto error;
     if (!(handler_sigchld = create_handler( sigchld_callback ))) goto error;
     if (!(handler_sigio   = create_handler( sigio_callback ))) goto error;
 
@@ -288,6 +304,7 @@ void init_signals(void)
     sigaddset( &blocked_sigset, SIGIO );
     sigaddset( &blocked_sigset, SIGQUIT );
     sigaddset( &blocked_sigset, SIGTERM );
+    sigaddset( &blocked_sigset, SIGUSR2 );
 #ifdef SIG_PTHREAD_CANCEL
     sigaddset( &blocked_sigset, SIG_PTHREAD_CANCEL );
 #endif
@@ -305,6 +322,8 @@ void init_signals(void)
     sigaction( SIGINT, &action, NULL );
     action.sa_handler = do_sigalrm;
     sigaction( SIGALRM, &action, NULL );
+    action.sa_handler = do_sigusr2;
+    sigaction( SIGUSR2, &action, NULL );
     action.sa_handler = do_sigterm;
     sigaction( SIGQUIT, &action, NULL );
     sigaction( SIGTERM, &action, NULL );
@@ -189,6 +189,7 @@ static inline void init_thread_structure( struct thread *thread )
     thread->system_regs     = 0;
     thread->queue           = NULL;
     thread->wait            = NULL;
+    thread->profile_wait    = 0;
     thread->error           = 0;
     thread->req_data        = NULL;
     thread->req_toread      = 0;
@@ -637,6 +638,7 @@ static unsigned int end_wait( struct thread *thread, unsigned int status )
 
     assert( wait );
     thread->wait = wait->next;
+    if (thread->profile_wait) profile_end_wait( thread );
 
     if (status < wait->count)  /* wait satisfied, tell it to the objects */
     {
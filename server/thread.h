@@ -60,6 +60,7 @@ struct thread
     unsigned int           system_regs;   /* which system regs have been set */
     struct msg_queue      *queue;         /* message queue */
     struct thread_wait    *wait;          /* current wait condition if sleeping */
+    timeout_t              profile_wait;  /* start time of a profiled blocking wait */
     struct list            system_apc;    /* queue of system async procedure calls */
     struct list            user_apc;      /* queue of user async procedure calls */
     struct inflight_fd     inflight[MAX_INFLIGHT_FDS];  /* fds currently in flight */
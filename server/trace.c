@@ -2300,6 +2300,17 @@ static void dump_get_mapping_info_reply( const struct get_mapping_info_reply *re
     dump_varargs_pe_image_info( ", image=", cur_size );
 }
 
+static void dump_get_relocated_image_request( const struct get_relocated_image_request *req )
+{
+    fprintf( stderr, " mapping=%04x", req->mapping );
+    dump_uint64( ", base=", &req->base );
+}
+
+static void dump_get_relocated_image_reply( const struct get_relocated_image_reply *req )
+{
+    fprintf( stderr, " file=%04x", req->file );
+}
+
 static void dump_map_view_request( const struct map_view_request *req )
 {
     fprintf( stderr, " mapping=%04x", req->mapping );
@@ -2469,6 +2480,17 @@ static void dump_write_process_memory_request( const struct write_process_memory
     dump_varargs_bytes( ", data=", cur_size );
 }
 
+static void dump_get_process_vm_pid_request( const struct get_process_vm_pid_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", access=%08x", req->access );
+}
+
+static void dump_get_process_vm_pid_reply( const struct get_process_vm_pid_reply *req )
+{
+    fprintf( stderr, " unix_pid=%d", req->unix_pid );
+}
+
 static void dump_create_key_request( const struct create_key_request *req )
 {
     fprintf( stderr, " access=%08x", req->access );
@@ -2547,6 +2569,8 @@ static void dump_get_key_value_reply( const struct get_key_value_reply *req )
 {
     fprintf( stderr, " type=%d", req->type );
     fprintf( stderr, ", total=%u", req->total );
+    fprintf( stderr, ", gen_slot=%08x", req->gen_slot );
+    fprintf( stderr, ", generation=%08x", req->generation );
     dump_varargs_bytes( ", data=", cur_size );
 }
 
@@ -2597,6 +2621,15 @@ static void dump_set_registry_notification_request( const struct set_registry_no
     fprintf( stderr, ", filter=%08x", req->filter );
 }
 
+static void dump_get_registry_shm_request( const struct get_registry_shm_request *req )
+{
+}
+
+static void dump_get_registry_shm_reply( const struct get_registry_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_create_timer_request( const struct create_timer_request *req )
 {
     fprintf( stderr, " access=%08x", req->access );
@@ -2798,6 +2831,15 @@ static void dump_get_queue_status_reply( const struct get_queue_status_reply *re
     fprintf( stderr, ", changed_bits=%08x", req->changed_bits );
 }
 
+static void dump_get_queue_shm_request( const struct get_queue_shm_request *req )
+{
+}
+
+static void dump_get_queue_shm_reply( const struct get_queue_shm_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_get_process_idle_event_request( const struct get_process_idle_event_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4407,6 +4449,16 @@ static void dump_remove_completion_reply( const struct remove_completion_reply *
     fprintf( stderr, ", status=%08x", req->status );
 }
 
+static void dump_get_completion_shm_request( const struct get_completion_shm_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_wake_completion_request( const struct wake_completion_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static void dump_query_completion_request( const struct query_completion_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4594,6 +4646,16 @@ static void dump_resume_process_request( const struct resume_process_request *re
     fprintf( stderr, " handle=%04x", req->handle );
 }
 
+static void dump_set_server_profile_request( const struct set_server_profile_request *req )
+{
+    fprintf( stderr, " flags=%08x", req->flags );
+}
+
+static void dump_set_server_profile_reply( const struct set_server_profile_reply *req )
+{
+    fprintf( stderr, " enabled=%d", req->enabled );
+}
+
 static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_new_process_request,
     (dump_func)dump_exec_process_request,
@@ -4683,6 +4745,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_mapping_request,
     (dump_func)dump_open_mapping_request,
     (dump_func)dump_get_mapping_info_request,
+    (dump_func)dump_get_relocated_image_request,
     (dump_func)dump_map_view_request,
     (dump_func)dump_unmap_view_request,
     (dump_func)dump_get_mapping_committed_range_request,
@@ -4700,6 +4763,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_set_debugger_kill_on_exit_request,
     (dump_func)dump_read_process_memory_request,
     (dump_func)dump_write_process_memory_request,
+    (dump_func)dump_get_process_vm_pid_request,
     (dump_func)dump_create_key_request,
     (dump_func)dump_open_key_request,
     (dump_func)dump_delete_key_request,
@@ -4713,6 +4777,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_unload_registry_request,
     (dump_func)dump_save_registry_request,
     (dump_func)dump_set_registry_notification_request,
+    (dump_func)dump_get_registry_shm_request,
     (dump_func)dump_create_timer_request,
     (dump_func)dump_open_timer_request,
     (dump_func)dump_set_timer_request,
@@ -4732,6 +4797,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_set_queue_fd_request,
     (dump_func)dump_set_queue_mask_request,
     (dump_func)dump_get_queue_status_request,
+    (dump_func)dump_get_queue_shm_request,
     (dump_func)dump_get_process_idle_event_request,
     (dump_func)dump_send_message_request,
     (dump_func)dump_post_quit_message_request,
@@ -4870,6 +4936,8 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_request,
     (dump_func)dump_add_completion_request,
     (dump_func)dump_remove_completion_request,
+    (dump_func)dump_get_completion_shm_request,
+    (dump_func)dump_wake_completion_request,
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
@@ -4893,6 +4961,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_terminate_job_request,
     (dump_func)dump_suspend_process_request,
     (dump_func)dump_resume_process_request,
+    (dump_func)dump_set_server_profile_request,
 };
 
 static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
@@ -4984,6 +5053,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_create_mapping_reply,
     (dump_func)dump_open_mapping_reply,
     (dump_func)dump_get_mapping_info_reply,
+    (dump_func)dump_get_relocated_image_reply,
     NULL,
     NULL,
     (dump_func)dump_get_mapping_committed_range_reply,
@@ -5001,6 +5071,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_read_process_memory_reply,
     NULL,
+    (dump_func)dump_get_process_vm_pid_reply,
     (dump_func)dump_create_key_reply,
     (dump_func)dump_open_key_reply,
     NULL,
@@ -5014,6 +5085,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     NULL,
+    (dump_func)dump_get_registry_shm_reply,
     (dump_func)dump_create_timer_reply,
     (dump_func)dump_open_timer_reply,
     (dump_func)dump_set_timer_reply,
@@ -5033,6 +5105,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     (dump_func)dump_set_queue_mask_reply,
     (dump_func)dump_get_queue_status_reply,
+    (dump_func)dump_get_queue_shm_reply,
     (dump_func)dump_get_process_idle_event_reply,
     NULL,
     NULL,
@@ -5171,6 +5244,8 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_open_completion_reply,
     NULL,
     (dump_func)dump_remove_completion_reply,
+    NULL,
+    NULL,
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
@@ -5194,6 +5269,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     NULL,
+    (dump_func)dump_set_server_profile_reply,
 };
 
 static const char * const req_names[REQ_NB_REQUESTS] = {
@@ -5285,6 +5361,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "create_mapping",
     "open_mapping",
     "get_mapping_info",
+    "get_relocated_image",
     "map_view",
     "unmap_view",
     "get_mapping_committed_range",
@@ -5302,6 +5379,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "set_debugger_kill_on_exit",
     "read_process_memory",
     "write_process_memory",
+    "get_process_vm_pid",
     "create_key",
     "open_key",
     "delete_key",
@@ -5315,6 +5393,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "unload_registry",
     "save_registry",
     "set_registry_notification",
+    "get_registry_shm",
     "create_timer",
     "open_timer",
     "set_timer",
@@ -5334,6 +5413,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "set_queue_fd",
     "set_queue_mask",
     "get_queue_status",
+    "get_queue_shm",
     "get_process_idle_event",
     "send_message",
     "post_quit_message",
@@ -5472,6 +5552,8 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "open_completion",
     "add_completion",
     "remove_completion",
+    "get_completion_shm",
+    "wake_completion",
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
@@ -5495,6 +5577,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "terminate_job",
     "suspend_process",
     "resume_process",
+    "set_server_profile",
 };
 
 static const struct
@@ -5722,3 +5805,8 @@ void trace_reply( enum request req, const union generic_reply *reply )
     else fprintf( stderr, "%04x: %d() = %s\n",
                   current->id, req, get_status_name(current->error) );
 }
+
+const char *get_req_name( enum request req )
+{
+    return req < REQ_NB_REQUESTS ? req_names[req] : NULL;
+}
@@ -0,0 +1,117 @@
+/*
+ *  Dump a binary debug log (WINEDEBUGLOG) file
+ *
+ *  Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "config.h"
+#include "wine/port.h"
+#include "winedump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include "windef.h"
+#include "winbase.h"
+#include "wine/debuglog.h"
+
+struct log_entry
+{
+    const struct debuglog_record *rec;
+    UINT tid;
+    UINT seq;
+    UINT index;
+};
+
+static const char * const debug_classes[] = { "fixme", "err", "warn", "trace" };
+
+static int compare_entries( const void *p1, const void *p2 )
+{
+    const struct log_entry *e1 = p1, *e2 = p2;
+
+    if (e1->rec->time != e2->rec->time) return e1->rec->time < e2->rec->time ? -1 : 1;
+    if (e1->seq != e2->seq) return e1->seq < e2->seq ? -1 : 1;
+    return e1->index < e2->index ? -1 : e1->index > e2->index;
+}
+
+static const struct debuglog_header *get_log_header(void)
+{
+    const struct debuglog_header *hdr = PRD( 0, sizeof(*hdr) );
+
+    if (!hdr || hdr->magic != DEBUGLOG_MAGIC || hdr->version != DEBUGLOG_VERSION) return NULL;
+    if (hdr->chunk_size < sizeof(struct debuglog_chunk) || !hdr->freq) return NULL;
+    return hdr;
+}
+
+enum FileSig get_kind_debuglog(void)
+{
+    return get_log_header() ? SIG_DEBUGLOG : SIG_UNKNOWN;
+}
+
+void debuglog_dump(void)
+{
+    const struct debuglog_header *hdr = get_log_header();
+    const struct debuglog_chunk *chunk;
+    const struct debuglog_record *rec;
+    struct log_entry *entries = NULL;
+    unsigned int i, count = 0, size = 0, pos;
+    const char *ptr;
+
+    for (i = 0; i < hdr->chunk_count; i++)
+    {
+        if (!(chunk = PRD( (ULONGLONG)(i + 1) * hdr->chunk_size, hdr->chunk_size ))) break;
+        if (!chunk->tid || chunk->used > hdr->chunk_size - sizeof(*chunk)) continue;
+
+        for (pos = 0; pos + sizeof(*rec) <= chunk->used; pos += rec->size)
+        {
+            rec = (const struct debuglog_record *)((const char *)(chunk + 1) + pos);
+            if (rec->size < sizeof(*rec) || pos + rec->size > chunk->used) break;
+            if (sizeof(*rec) + rec->channel_len + rec->function_len + rec->text_len > rec->size) break;
+            if (count == size)
+            {
+                size = size ? size * 2 : 1024;
+                entries = realloc( entries, size * sizeof(*entries) );
+                if (!entries) fatal( "Out of memory" );
+            }
+            entries[count].rec   = rec;
+            entries[count].tid   = chunk->tid;
+            entries[count].seq   = chunk->seq;
+            entries[count].index = count;
+            count++;
+        }
+    }
+
+    qsort( entries, count, sizeof(*entries), compare_entries );
+
+    for (i = 0; i < count; i++)
+    {
+        ULONGLONG ticks;
+
+        rec = entries[i].rec;
+        ptr = (const char *)(rec + 1);
+        ticks = rec->time * 1000 / hdr->freq;
+        printf( "%3u.%03u:%04x:%04x:", (UINT)(ticks / 1000), (UINT)(ticks % 1000), hdr->pid, entries[i].tid );
+        if (rec->cls < ARRAY_SIZE(debug_classes))
+            printf( "%s:%.*s:%.*s ", debug_classes[rec->cls], rec->channel_len, ptr,
+                    rec->function_len, ptr + rec->channel_len );
+        ptr += rec->channel_len + rec->function_len;
+        fwrite( ptr, 1, rec->text_len, stdout );
+    }
+    if (hdr->lost) printf( "%u lines were lost because the log was full\n", hdr->lost );
+    free( entries );
+}